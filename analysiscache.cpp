@@ -0,0 +1,93 @@
+#include "analysiscache.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Costruttore di default: nessuna cella, le dimensioni vengono impostate in seguito con resize
+AnalysisCache::AnalysisCache()
+    : length_{0},
+    width_{0}
+    {}
+
+// Costruttore con parametri: tutte le celle partono senza analisi memorizzata
+AnalysisCache::AnalysisCache(int length, int width)
+    : length_{0},
+    width_{0}
+    {
+        resize(length, width);
+    }
+
+// Funzione per adattare la cache a nuove dimensioni del campo: le celle già presenti mantengono la loro chiave.
+void AnalysisCache::resize(int length, int width) {
+    if (length < 0 || width < 0) {
+        std::cerr << "Invalid analysis cache dimensions." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (length == length_ && width == width_) {
+        return;
+    }
+    std::vector<CacheEntry> resized(static_cast<std::size_t>(length) * width);
+    int keptLength {std::min(length, length_)};
+    int keptWidth {std::min(width, width_)};
+    for (int x = 0; x < keptLength; ++x) {
+        auto row = cells_.begin() + cellIndex(x, 0);
+        std::copy(row, row + keptWidth, resized.begin() + static_cast<std::size_t>(x) * width);
+    }
+    cells_ = std::move(resized);
+    length_ = length;
+    width_ = width;
+}
+
+// Passo di quantizzazione per tipo di sensore: corrisponde all'ampiezza dell'intervallo del rumore simulato in "sensor.cpp",
+// così che due letture dello stesso valore reale non differiscano mai di più di un passo.
+double AnalysisCache::getQuantizationStep(Sensor::SensorType type) {
+    switch (type) {
+        case Sensor::SensorType::MoistureSensor: return 4.0;
+        case Sensor::SensorType::SoilTemperatureSensor: return 1.0;
+        case Sensor::SensorType::HumiditySensor: return 6.0;
+        case Sensor::SensorType::AirTemperatureSensor: return 1.0;
+        default: return 1.0;
+    }
+}
+
+// Funzione che confronta la chiave della nuova analisi con quella memorizzata per la cella.
+// Restituisce true se la cella è invariata (stesso tipo di suolo, stessi sensori e valori quantizzati che differiscono al più di un passo),
+// altrimenti memorizza la nuova chiave e restituisce false.
+bool AnalysisCache::checkAndStore(int x, int y, Soil::SoilType soilType, const std::array<double, Sensor::SensorTypeCount>& values, const std::array<bool, Sensor::SensorTypeCount>& present) {
+    if (!contains(x, y)) {
+        return false;
+    }
+    CacheEntry key;
+    key.valid = true;
+    key.soiltype = soilType;
+    for (std::size_t index = 0; index < Sensor::SensorTypeCount; ++index) {
+        if (present[index]) {
+            key.presentmask |= static_cast<std::uint8_t>(1u << index);
+            key.quantized[index] = static_cast<std::int32_t>(std::lround(values[index] / getQuantizationStep(static_cast<Sensor::SensorType>(index))));
+        }
+    }
+    CacheEntry& entry = cells_[cellIndex(x, y)];
+    bool unchanged {entry.valid && entry.soiltype == key.soiltype && entry.presentmask == key.presentmask};
+    for (std::size_t index = 0; unchanged && index < Sensor::SensorTypeCount; ++index) {
+        unchanged = std::abs(entry.quantized[index] - key.quantized[index]) <= 1;
+    }
+    if (!unchanged) {
+        entry = key;
+    }
+    return unchanged;
+}
+
+// Funzione per dimenticare l'analisi di una cella: la prossima visita verrà analizzata da capo.
+void AnalysisCache::invalidateCell(int x, int y) {
+    if (contains(x, y)) {
+        cells_[cellIndex(x, y)].valid = false;
+    }
+}
+
+// Funzione per dimenticare l'analisi di tutte le celle.
+void AnalysisCache::invalidateAll() {
+    for (auto& entry : cells_) {
+        entry.valid = false;
+    }
+}
@@ -0,0 +1,42 @@
+// La classe "AnalysisCache" memorizza, per ogni cella del campo, la chiave dell'ultima analisi effettuata.
+// La chiave è formata dal tipo di suolo e dalle letture della visita quantizzate con un passo pari all'ampiezza del rumore del sensore.
+// Se una nuova visita produce una chiave che differisce al più di un passo per ogni sensore, le due visite sono compatibili con lo stesso valore reale:
+// le condizioni della cella non sono cambiate in modo apprezzabile e il control center può evitare di ricalcolare e registrare di nuovo il verdetto.
+// La chiave memorizzata è quella dell'ultima analisi completa, così che piccole variazioni successive non si accumulino senza essere rilevate.
+// Come per "CellStatistics", i dati sono memorizzati in modo denso per cella e la sincronizzazione è a carico del control center.
+// La descrizione delle funzioni è presente nel file "analysiscache.cpp".
+
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+#include "sensor.h"
+#include "soil.h"
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+class AnalysisCache {
+    public:
+        AnalysisCache();
+        AnalysisCache(int length, int width);
+        void resize(int length, int width);
+        bool checkAndStore(int x, int y, Soil::SoilType soilType, const std::array<double, Sensor::SensorTypeCount>& values, const std::array<bool, Sensor::SensorTypeCount>& present);
+        void invalidateCell(int x, int y);
+        void invalidateAll();
+        bool contains(int x, int y) const { return x >= 0 && x < length_ && y >= 0 && y < width_; }
+        static double getQuantizationStep(Sensor::SensorType type);
+
+    private:
+        struct CacheEntry {
+            bool valid = false;
+            Soil::SoilType soiltype = Soil::SoilType::loam;
+            std::uint8_t presentmask = 0;
+            std::array<std::int32_t, Sensor::SensorTypeCount> quantized{};
+        };
+        int length_;
+        int width_;
+        std::vector<CacheEntry> cells_;
+        std::size_t cellIndex(int x, int y) const { return static_cast<std::size_t>(x) * width_ + y; }
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "batchpool.h"
+#include <utility>
+
+// Costruttore: batchcapacity è il numero di letture per cui viene riservato spazio in ogni nuovo buffer, maxpooled il numero massimo di buffer tenuti da parte.
+BatchPool::BatchPool(std::size_t batchcapacity, std::size_t maxpooled)
+    : batchcapacity_{batchcapacity},
+    maxpooled_{maxpooled},
+    allocations_{0}
+    {
+        freebatches_.reserve(maxpooled_);
+    }
+
+// Funzione che restituisce un buffer vuoto: se la riserva è vuota ne viene creato uno nuovo con la capacità prevista.
+std::vector<SoilData> BatchPool::acquire() {
+    std::unique_lock<std::mutex> lock(poolmutex_);
+    if (!freebatches_.empty()) {
+        std::vector<SoilData> batch = std::move(freebatches_.back());
+        freebatches_.pop_back();
+        return batch;
+    }
+    ++allocations_;
+    lock.unlock(); // L'allocazione avviene fuori dal lock
+    std::vector<SoilData> batch;
+    batch.reserve(batchcapacity_);
+    return batch;
+}
+
+// Funzione che restituisce un buffer alla riserva: il contenuto viene svuotato ma la memoria già allocata viene mantenuta.
+void BatchPool::release(std::vector<SoilData>&& batch) {
+    batch.clear();
+    std::lock_guard<std::mutex> lock(poolmutex_);
+    if (freebatches_.size() < maxpooled_) {
+        freebatches_.push_back(std::move(batch));
+    }
+    // Se la riserva è piena il buffer viene semplicemente distrutto all'uscita dalla funzione
+}
+
+// Funzione che restituisce il numero di buffer creati dalla riserva: a regime tale numero non deve crescere.
+std::size_t BatchPool::getAllocations() const {
+    std::lock_guard<std::mutex> lock(poolmutex_);
+    return allocations_;
+}
+
+// Funzione che restituisce il numero di buffer attualmente disponibili nella riserva.
+std::size_t BatchPool::getPooledBatches() const {
+    std::lock_guard<std::mutex> lock(poolmutex_);
+    return freebatches_.size();
+}
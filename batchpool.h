@@ -0,0 +1,30 @@
+// La classe "BatchPool" è una riserva di buffer riutilizzabili per i batch di letture (vettori di SoilData).
+// I veicoli prendono un buffer vuoto dalla riserva, lo riempiono con le letture e lo consegnano al control center per spostamento (move), senza copie.
+// Una volta analizzato il batch, il control center restituisce il buffer alla riserva: a regime non si effettuano allocazioni per ogni lettura.
+// La riserva è protetta da un mutex perché viene usata contemporaneamente dai veicoli e dal control center.
+// La descrizione delle funzioni è presente nel file "batchpool.cpp".
+
+#ifndef BATCHPOOL_H
+#define BATCHPOOL_H
+#include "soildata.h"
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+class BatchPool {
+    public:
+        BatchPool(std::size_t batchcapacity, std::size_t maxpooled);
+        std::vector<SoilData> acquire();
+        void release(std::vector<SoilData>&& batch);
+        std::size_t getAllocations() const;
+        std::size_t getPooledBatches() const;
+
+    private:
+        std::vector<std::vector<SoilData>> freebatches_;
+        std::size_t batchcapacity_;
+        std::size_t maxpooled_;
+        std::size_t allocations_;
+        mutable std::mutex poolmutex_;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "cellstatistics.h"
+#include <iostream>
+#include <algorithm>
+
+// Costruttore di default: nessuna cella, le dimensioni vengono impostate in seguito con resize
+CellStatistics::CellStatistics()
+    : length_{0},
+    width_{0}
+    {}
+
+// Costruttore con parametri: una voce vuota per ogni cella del campo
+CellStatistics::CellStatistics(int length, int width)
+    : length_{0},
+    width_{0}
+    {
+        resize(length, width);
+    }
+
+// Funzione per adattare le statistiche a nuove dimensioni del campo: le celle già presenti mantengono i loro dati,
+// quelle rimaste fuori dal campo lasciano l'elenco delle celle visitate.
+void CellStatistics::resize(int length, int width) {
+    if (length < 0 || width < 0) {
+        std::cerr << "Invalid statistics dimensions." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (length == length_ && width == width_) {
+        return;
+    }
+    std::vector<CellEntry> resized(static_cast<std::size_t>(length) * width);
+    int keptLength {std::min(length, length_)};
+    int keptWidth {std::min(width, width_)};
+    for (int x = 0; x < keptLength; ++x) {
+        auto row = cells_.begin() + cellIndex(x, 0);
+        std::copy(row, row + keptWidth, resized.begin() + static_cast<std::size_t>(x) * width);
+    }
+    cells_ = std::move(resized);
+    length_ = length;
+    width_ = width;
+    visited_.erase(std::remove_if(visited_.begin(), visited_.end(), [this](const std::pair<int, int>& cell) {
+        return !contains(cell.first, cell.second);
+    }), visited_.end());
+    listed_.assign(cells_.size(), false);
+    for (const auto& cell : visited_) {
+        listed_[cellIndex(cell.first, cell.second)] = true;
+    }
+}
+
+// Funzione privata che aggiunge una cella all'elenco delle celle visitate, se non è già presente.
+void CellStatistics::markVisited(int x, int y) {
+    std::size_t index {cellIndex(x, y)};
+    if (!listed_[index]) {
+        listed_[index] = true;
+        visited_.emplace_back(x, y);
+    }
+}
+
+// Funzione per aggiungere una lettura alle statistiche della cella: aggiornamento in tempo costante con l'algoritmo di Welford.
+void CellStatistics::addReading(int x, int y, Sensor::SensorType type, double value, std::chrono::steady_clock::time_point now) {
+    if (!contains(x, y)) {
+        std::cerr << "Error: statistics requested for a cell out of field (" << x << ", " << y << ")" << std::endl;
+        return;
+    }
+    markVisited(x, y);
+    SensorStatistics& stats = cells_[cellIndex(x, y)][static_cast<std::size_t>(type)];
+    ++stats.count;
+    double delta {value - stats.mean};
+    stats.mean += delta / stats.count;
+    stats.m2 += delta * (value - stats.mean);
+    if (stats.count == 1) {
+        stats.min = value;
+        stats.max = value;
+    } else {
+        stats.min = std::min(stats.min, value);
+        stats.max = std::max(stats.max, value);
+    }
+    stats.last = value;
+    stats.lastseen = now;
+}
+
+// Funzione per cancellare lo storico di una cella, ad esempio quando le sue condizioni sono cambiate.
+// La cella resta nell'elenco delle celle visitate: chi lo scorre ignora le statistiche vuote.
+void CellStatistics::resetCell(int x, int y) {
+    if (!contains(x, y)) {
+        return;
+    }
+    cells_[cellIndex(x, y)] = CellEntry{};
+}
+
+// Funzione per sostituire le statistiche di un tipo di sensore per una cella, ad esempio al ripristino di un checkpoint.
+void CellStatistics::setStatistics(int x, int y, Sensor::SensorType type, const SensorStatistics& statistics) {
+    if (!contains(x, y)) {
+        return;
+    }
+    if (statistics.count > 0) {
+        markVisited(x, y);
+    }
+    cells_[cellIndex(x, y)][static_cast<std::size_t>(type)] = statistics;
+}
+
+// Funzione che restituisce le statistiche di un tipo di sensore per una cella: per celle fuori dal campo si restituiscono statistiche vuote.
+const SensorStatistics& CellStatistics::getStatistics(int x, int y, Sensor::SensorType type) const {
+    static const SensorStatistics empty{};
+    if (!contains(x, y)) {
+        return empty;
+    }
+    return cells_[cellIndex(x, y)][static_cast<std::size_t>(type)];
+}
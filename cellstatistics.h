@@ -0,0 +1,55 @@
+// La classe "CellStatistics" raccoglie in modo incrementale le statistiche delle letture ricevute per ogni cella del campo.
+// Per ogni cella e per ogni tipo di sensore vengono mantenuti numero di letture, media, varianza (algoritmo di Welford), minimo, massimo, ultimo valore e istante dell'ultima lettura.
+// Le statistiche sono memorizzate in modo denso in un unico vettore indicizzato per cella (riga per riga), così che ogni nuova visita di una cella aggiorni i dati in tempo costante senza dover riesaminare lo storico delle letture.
+// La classe tiene anche l'elenco delle celle con almeno una lettura, così che chi deve copiare tutte le statistiche (i checkpoint della missione)
+// esamini solo le celle visitate invece dell'intero campo.
+// La classe non è protetta da mutex: la sincronizzazione è a carico di chi la usa (il control center).
+// La descrizione delle funzioni è presente nel file "cellstatistics.cpp".
+
+#ifndef CELLSTATISTICS_H
+#define CELLSTATISTICS_H
+#include "sensor.h"
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+struct SensorStatistics {
+    std::size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // Somma dei quadrati degli scarti dalla media, usata da Welford per la varianza
+    double min = 0.0;
+    double max = 0.0;
+    double last = 0.0;
+    std::chrono::steady_clock::time_point lastseen{};
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double trend() const { return count > 0 ? last - mean : 0.0; } // Scostamento dell'ultima lettura dalla media storica
+};
+
+class CellStatistics {
+    public:
+        CellStatistics();
+        CellStatistics(int length, int width);
+        void resize(int length, int width);
+        void addReading(int x, int y, Sensor::SensorType type, double value, std::chrono::steady_clock::time_point now);
+        void resetCell(int x, int y);
+        void setStatistics(int x, int y, Sensor::SensorType type, const SensorStatistics& statistics);
+        const SensorStatistics& getStatistics(int x, int y, Sensor::SensorType type) const;
+        bool contains(int x, int y) const { return x >= 0 && x < length_ && y >= 0 && y < width_; }
+        int getLength() const { return length_; }
+        int getWidth() const { return width_; }
+        const std::vector<std::pair<int, int>>& getVisitedCells() const { return visited_; }
+
+    private:
+        using CellEntry = std::array<SensorStatistics, Sensor::SensorTypeCount>;
+        int length_;
+        int width_;
+        std::vector<CellEntry> cells_;
+        std::vector<std::pair<int, int>> visited_; // Celle che hanno ricevuto almeno una lettura, nell'ordine della prima lettura
+        std::vector<bool> listed_; // Per ogni cella, indica se è già presente in visited_
+        void markVisited(int x, int y);
+        std::size_t cellIndex(int x, int y) const { return static_cast<std::size_t>(x) * width_ + y; }
+};
+
+#endif
@@ -5,48 +5,331 @@
 #include <thread>
 #include <chrono>
 #include <iostream>
+#include <algorithm>
+#include <array>
 
 // Costruttore del control center: viene passato il campo come parametro per poter accedere ai dati del terreno
 ControlCenter::ControlCenter(const Field& field)
-    : field_(field)
+    : field_(field),
+    fleet_(64), // Numero massimo di veicoli gestibili dal control center
+    batchpool_(64, 32), // Buffer da 64 letture (16 celle con 4 sensori), al più 32 buffer tenuti da parte
+    cellstatistics_(field.getLength(), field.getWidth()),
+    analysiscache_(field.getLength(), field.getWidth())
 {}
 
+// Funzione per registrare un veicolo nel registro del control center: restituisce il suo indice denso
+int ControlCenter::registerVehicle(Vehicle& vehicle) {
+    std::lock_guard<std::mutex> lock(vehiclepositionmutex_);
+    return fleet_.registerVehicle(vehicle);
+}
+
+// Funzione per raccogliere i campioni di telemetria pubblicati da tutti i veicoli registrati: i veicoli non vengono mai bloccati.
+// Restituisce il numero di campioni aggiunti al vettore.
+std::size_t ControlCenter::collectTelemetry(std::vector<TelemetrySample>& samples) {
+    std::lock_guard<std::mutex> lock(telemetrymutex_);
+    std::size_t collected {0};
+    int size {fleet_.getSize()};
+    for (int index = 0; index < size; ++index) {
+        collected += fleet_.getVehicle(index)->getTelemetry().drain(samples);
+    }
+    return collected;
+}
+
 // Funzione per inviare un comando di movimento a un veicolo
 void ControlCenter::sendMovementCommandToVehicle(Vehicle& vehicle, int x, int y) {
-    std::unique_lock<std::mutex> lock(vehiclepositionmutex_); // Lock per proteggere l'accesso alla mappa delle posizioni dei veicoli
-    cellfreecv_.wait(lock, [this, x, y] { 
-        for (const auto& pos : vehiclepositions_) {
-            if (pos.second.first == x && pos.second.second == y) {
-                return false;
-            }
-        }
-        return true;
-    }); 
-    vehiclepositions_[vehicle.getId()] = {x, y}; 
+    std::unique_lock<std::mutex> lock(vehiclepositionmutex_); // Lock per proteggere l'accesso alle posizioni dei veicoli
+    int index {fleet_.registerVehicle(vehicle)}; // Un veicolo non ancora registrato viene registrato al primo comando
+    // Si attende che nessun altro veicolo occupi o abbia riservato la cella di destinazione
+    cellfreecv_.wait(lock, [this, x, y, index] { return !fleet_.isCellOccupied(x, y, index); }); 
+    fleet_.setPosition(index, x, y); // La cella di destinazione viene riservata
+    fleet_.setBusy(index, true);
     lock.unlock(); 
 
     vehicle.moveToTarget(x, y);
 
     lock.lock(); 
-    vehiclepositions_[vehicle.getId()] = {vehicle.getX(), vehicle.getY()}; // modified
+    fleet_.setPosition(index, vehicle.getX(), vehicle.getY());
+    fleet_.setBattery(index, vehicle.getBattery());
+    fleet_.setBusy(index, false);
     cellfreecv_.notify_all(); 
 }
 
 
-// Funzione per inviare un comando di lettura dei dati a un veicolo
-void ControlCenter::commandDataRead(Vehicle& vehicle) {
-    vehicle.readAndSendData(*this); // Il veicolo legge i dati e li invia al control center
+// Funzione per inviare un comando di lettura dei dati a un veicolo: restituisce false se il veicolo non ha potuto leggere la cella
+bool ControlCenter::commandDataRead(Vehicle& vehicle) {
+    return vehicle.readAndSendData(*this); // Il veicolo legge i dati e li accumula, inviandoli al control center quando il batch è pronto
+}
+
+// Funzione per chiedere a un veicolo di inviare subito le letture accumulate (ad esempio a fine percorso)
+void ControlCenter::commandDataFlush(Vehicle& vehicle) {
+    vehicle.flushData(*this);
+}
+
+// Funzione per avviare il pattugliamento continuo delle celle indicate, con un budget massimo di visite
+void ControlCenter::startPatrol(const std::vector<std::pair<int, int>>& cells, std::size_t budget) {
+    patrol_.start(field_.getLength(), field_.getWidth(), cells, budget, std::chrono::steady_clock::now());
+}
+
+// Funzione chiamata quando un veicolo si libera: il veicolo viene mandato nella cella di maggior valore e ne legge i dati.
+// Se tutte le celle sono assegnate ad altri veicoli si attende che una visita in corso termini.
+// Le letture vengono inviate subito, perché il loro esito aggiorna la priorità della cella; se il veicolo non raggiunge o non legge la cella,
+// la cella viene liberata. Restituisce Exhausted quando non ci sono più visite da assegnare.
+PatrolScheduler::Dispatch ControlCenter::dispatchPatrolVisit(Vehicle& vehicle) {
+    std::pair<int, int> cell;
+    PatrolScheduler::Dispatch result {patrol_.waitForDispatch(vehicle.getX(), vehicle.getY(), vehicle.getSpeed(), cell)};
+    if (result != PatrolScheduler::Dispatch::Visit) {
+        return result;
+    }
+    std::cout << "Debug: Patrol sends vehicle " << vehicle.getId() << " to (" << cell.first << ", " << cell.second << ")" << std::endl;
+    sendMovementCommandToVehicle(vehicle, cell.first, cell.second);
+    bool read {vehicle.getX() == cell.first && vehicle.getY() == cell.second && commandDataRead(vehicle)};
+    commandDataFlush(vehicle);
+    if (!read) {
+        std::cerr << "Patrol visit to (" << cell.first << ", " << cell.second << ") failed: the cell leaves the patrol." << std::endl;
+        patrol_.releaseCell(cell.first, cell.second);
+    }
+    return result;
+}
+
+// Funzione per fermare il pattugliamento: i veicoli non ricevono più celle da visitare
+void ControlCenter::stopPatrol() {
+    patrol_.stop();
+}
+
+// Funzione che restituisce in "cells" le celle con piante modificate dopo la generazione indicata del campo, da far rilevare di nuovo ai veicoli.
+// Il costo dipende dalle dimensioni delle aree modificate e non da quelle del campo, salvo quando il registro delle modifiche non risale più alla generazione richiesta.
+// Le statistiche e la cache delle analisi delle celle modificate vengono azzerate, perché le vecchie letture non descrivono più il suolo attuale.
+// Restituisce la generazione da usare per la richiesta successiva.
+std::uint64_t ControlCenter::getChangedPlantCells(std::uint64_t generation, std::vector<std::pair<int, int>>& cells) {
+    cells.clear();
+    std::uint64_t current {field_.getGeneration()}; // Letta prima del registro: una modifica concorrente verrà restituita anche alla richiesta successiva
+    int length {field_.getLength()};
+    int width {field_.getWidth()};
+    std::vector<int> changed;
+    std::vector<Field::ChangeRecord> changes;
+    if (field_.getChangesSince(generation, changes)) {
+        for (const auto& change : changes) {
+            // Le aree registrate prima di un ridimensionamento possono uscire dal campo attuale
+            for (int x = change.startlength; x <= std::min(change.endlength, length - 1); ++x) {
+                for (int y = change.startwidth; y <= std::min(change.endwidth, width - 1); ++y) {
+                    changed.push_back(x * width + y);
+                }
+            }
+        }
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    } else {
+        std::cout << "Debug: Change log does not reach generation " << generation << ", the whole field is considered changed" << std::endl;
+        changed.resize(static_cast<std::size_t>(length) * width);
+        for (std::size_t cell = 0; cell < changed.size(); ++cell) {
+            changed[cell] = static_cast<int>(cell);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> statisticsLock(statisticsmutex_);
+        for (int cell : changed) {
+            cellstatistics_.resetCell(cell / width, cell % width);
+            analysiscache_.invalidateCell(cell / width, cell % width);
+        }
+    }
+    for (int cell : changed) {
+        Soil soil;
+        if (field_.peekSoil(cell / width, cell % width, soil) && soil.getPlants()) {
+            cells.emplace_back(cell / width, cell % width);
+        }
+    }
+    return current;
+}
+
+// Funzione che copia lo stato della missione da salvare in un checkpoint, senza fermare veicoli e analisi:
+// i lock vengono tenuti solo per il tempo della copia. Dei risultati vengono copiati solo quelli a partire dall'indice resultsfrom,
+// così che chi salva i checkpoint possa scrivere solo quelli nuovi.
+// Se un batch sta aggiornando le statistiche si attende che abbia finito, così che ogni batch sia o tra quelli in attesa o già nei risultati.
+// Le statistiche vengono copiate dopo aver rilasciato il lock del buffer, così che i veicoli possano continuare a inviare dati:
+// l'analisi non applica nuovi batch finché la copia non è terminata, e vengono esaminate solo le celle che hanno ricevuto letture.
+void ControlCenter::captureMissionState(MissionState& state, std::size_t resultsfrom) {
+    state.batches.clear();
+    state.results.clear();
+    state.statistics.clear();
+    {
+        std::unique_lock<std::mutex> lock(bufferMutex_);
+        cvmissioncomplete_.wait(lock, [this] { return !applyingbatch_; });
+        if (analyzingbatch_ != nullptr) {
+            state.batches.emplace_back(analyzinglane_, analyzingbatch_->readings);
+        }
+        std::queue<PendingBatch> priority {prioritybuffer_};
+        for (; !priority.empty(); priority.pop()) {
+            state.batches.emplace_back(Lane::Priority, std::move(priority.front().readings));
+        }
+        std::queue<PendingBatch> normal {databuffer_};
+        for (; !normal.empty(); normal.pop()) {
+            state.batches.emplace_back(Lane::Normal, std::move(normal.front().readings));
+        }
+        state.resultcount = analysisResults_.size();
+        state.resultsfrom = std::min(resultsfrom, state.resultcount);
+        state.results.assign(analysisResults_.begin() + state.resultsfrom, analysisResults_.end());
+        state.activevehicles = activevehicles_;
+        ++capturingstatistics_;
+    }
+    {
+        std::lock_guard<std::mutex> statisticsLock(statisticsmutex_);
+        for (const auto& cell : cellstatistics_.getVisitedCells()) {
+            for (std::size_t index = 0; index < Sensor::SensorTypeCount; ++index) {
+                Sensor::SensorType type {static_cast<Sensor::SensorType>(index)};
+                const SensorStatistics& statistics = cellstatistics_.getStatistics(cell.first, cell.second, type);
+                if (statistics.count > 0) {
+                    state.statistics.push_back({cell.first, cell.second, type, statistics});
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    --capturingstatistics_;
+    cvmissioncomplete_.notify_all(); // L'analisi in attesa della fine della copia può applicare il batch
+}
+
+// Funzione che ripristina lo stato di una missione salvato in un checkpoint, prima di riavviare veicoli e analisi:
+// i batch tornano nelle corsie di analisi, i risultati e le statistiche delle celle vengono sostituiti.
+// La cache delle analisi non fa parte del checkpoint, quindi la prima analisi di ogni cella dopo il ripristino viene registrata di nuovo.
+void ControlCenter::restoreMissionState(const MissionState& state) {
+    {
+        std::lock_guard<std::mutex> statisticsLock(statisticsmutex_);
+        cellstatistics_ = CellStatistics(field_.getLength(), field_.getWidth());
+        for (const auto& entry : state.statistics) {
+            if (cellstatistics_.contains(entry.x, entry.y)) {
+                cellstatistics_.setStatistics(entry.x, entry.y, entry.type, entry.statistics);
+            }
+        }
+        analysiscache_.resize(field_.getLength(), field_.getWidth());
+        analysiscache_.invalidateAll();
+    }
+    {
+        std::lock_guard<std::mutex> lock(vehiclepositionmutex_);
+        for (int index = 0; index < fleet_.getSize(); ++index) {
+            const Vehicle* vehicle {fleet_.getVehicle(index)};
+            fleet_.setPosition(index, vehicle->getX(), vehicle->getY());
+            fleet_.setBattery(index, vehicle->getBattery());
+        }
+    }
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& batch : state.batches) {
+        if (batch.second.empty()) {
+            continue;
+        }
+        std::vector<SoilData> readings {batchpool_.acquire()};
+        readings.assign(batch.second.begin(), batch.second.end());
+        bufferedreadings_ += readings.size();
+        ++inflightbatches_;
+        (batch.first == Lane::Priority ? prioritybuffer_ : databuffer_).push({std::move(readings), now});
+    }
+    analysisResults_.assign(state.results.begin(), state.results.end());
+    activevehicles_ = state.activevehicles;
+    dataCollectionComplete_ = (activevehicles_ == 0);
+    cvnotdata_.notify_all();
 }
 
-// Funzione per aggiungere i dati al buffer del control center
-void ControlCenter::appendData(const std::vector<SoilData>& dataBatch) {
+// Funzione per aggiungere i dati al buffer del control center: l'id del veicolo che invia il batch serve solo alla registrazione della traccia
+void ControlCenter::appendData(std::vector<SoilData>&& dataBatch, int vehicleid) {
+    if (dataBatch.empty()) {
+        return;
+    }
+    if (tracerecorder_ != nullptr) {
+        tracerecorder_->record(vehicleid, dataBatch); // Il batch viene registrato così come è arrivato, prima della separazione in corsie
+    }
+    // Pre-classificazione fuori dal lock: le celle con letture sospette critiche passano nella corsia prioritaria
+    std::vector<SoilData> suspectBatch = extractSuspectCells(dataBatch);
+
     std::unique_lock<std::mutex> lock(bufferMutex_); // Protegge l'accesso al buffer: posso scrivere solo se nessun altro veicolo sta scrivendo
-    databuffer_.push(dataBatch);
-    std::cout << "Debug: Data appended to buffer" << std::endl;
+    // Backpressure: se il buffer ha superato la soglia, il veicolo attende che il control center smaltisca parte dei dati
+    cvbufferspace_.wait(lock, [this] { return bufferedreadings_ < bufferwatermark_; });
+    auto now = std::chrono::steady_clock::now();
+    std::size_t readings{dataBatch.size() + suspectBatch.size()};
+    bufferedreadings_ += readings;
+    if (!suspectBatch.empty()) {
+        ++inflightbatches_; // Il batch resta "in volo" finché i suoi risultati non sono stati registrati
+        prioritybuffer_.push({std::move(suspectBatch), now});
+        std::cout << "Debug: Suspect critical cells moved to the priority lane" << std::endl;
+    }
+    if (!dataBatch.empty()) {
+        ++inflightbatches_;
+        databuffer_.push({std::move(dataBatch), now}); // Il buffer passa al control center senza copie
+    } else {
+        batchpool_.release(std::move(dataBatch)); // Tutte le celle erano sospette: il buffer vuoto torna nella riserva
+    }
+    std::cout << "Debug: Data appended to buffer (" << readings << " readings)" << std::endl;
     cvnotdata_.notify_one(); // Notifica il control center che ci sono nuovi dati nel buffer
 }
 
-// Funzione per la lettura e l'analisi dei dati del buffer
+// Funzione privata che separa da un batch le celle con almeno una lettura sospetta critica, mantenendo l'ordine delle altre celle.
+// Le celle sospette vengono spostate in un nuovo buffer preso dalla riserva, che resta vuoto se nessuna cella è sospetta.
+std::vector<SoilData> ControlCenter::extractSuspectCells(std::vector<SoilData>& dataBatch) {
+    std::vector<SoilData> suspectBatch;
+    auto keep = dataBatch.begin();
+    auto cellBegin = dataBatch.begin();
+    while (cellBegin != dataBatch.end()) {
+        int x{cellBegin->x};
+        int y{cellBegin->y};
+        auto cellEnd = std::find_if(cellBegin, dataBatch.end(), [x, y](const SoilData& data) {
+            return data.x != x || data.y != y;
+        });
+        bool suspect = std::any_of(cellBegin, cellEnd, [this](const SoilData& data) { return isSuspectReading(data); });
+        if (suspect) {
+            if (suspectBatch.capacity() == 0) {
+                suspectBatch = batchpool_.acquire();
+            }
+            suspectBatch.insert(suspectBatch.end(), cellBegin, cellEnd);
+        } else {
+            keep = std::move(cellBegin, cellEnd, keep); // Le celle non sospette vengono compattate verso l'inizio del batch
+        }
+        cellBegin = cellEnd;
+    }
+    dataBatch.erase(keep, dataBatch.end());
+    return suspectBatch;
+}
+
+// Funzione privata che stabilisce se una singola lettura è sospetta critica, confrontandola con la tabella delle soglie del tipo di suolo della cella
+bool ControlCenter::isSuspectReading(const SoilData& data) const {
+    Soil::SoilType soilType;
+    if (!field_.getSoilType(data.x, data.y, soilType)) {
+        return false;
+    }
+    Verdict verdict {classifyValue(soilType, data.type, data.data)};
+    return verdict == Verdict::CriticalLow || verdict == Verdict::CriticalHigh;
+}
+
+// Funzione per registrare in una traccia tutti i batch ricevuti (nullptr per interrompere la registrazione).
+// Va chiamata prima che i veicoli inizino a inviare dati.
+void ControlCenter::setTraceRecorder(TraceRecorder* recorder) {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    tracerecorder_ = recorder;
+}
+
+// Funzione che collega il controllore dell'irrigazione: le celle con piante e suolo troppo asciutto verranno irrigate
+void ControlCenter::setIrrigationController(IrrigationController* irrigation) {
+    std::lock_guard<std::mutex> lock(statisticsmutex_);
+    irrigation_ = irrigation;
+}
+
+// Funzione che fornisce ai veicoli un buffer vuoto in cui accumulare le letture
+std::vector<SoilData> ControlCenter::acquireBatch() {
+    return batchpool_.acquire();
+}
+
+// Funzione per impostare la soglia (in numero di letture) oltre la quale i veicoli vengono rallentati
+void ControlCenter::setBufferWatermark(std::size_t readings) {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    bufferwatermark_ = readings > 0 ? readings : 1;
+    cvbufferspace_.notify_all();
+}
+
+// Funzione per impostare il tempo di analisi simulato per ogni batch (5 secondi di default)
+void ControlCenter::setAnalysisDelay(std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    analysisdelay_ = delay;
+}
+
+// Funzione per la lettura e l'analisi dei dati del buffer: i batch della corsia prioritaria vengono sempre analizzati per primi
 void ControlCenter::analyzeData() {
     std::cout << "Debug: Buffer size before analysis: " << databuffer_.size() << std::endl;
     std::unique_lock<std::mutex> lock(bufferMutex_); // Protegge l'accesso al buffer su cui agisce sia il control center che i veicoli
@@ -65,55 +348,62 @@ void ControlCenter::analyzeData() {
                   << ", dataCollectionComplete_ = " << dataCollectionComplete_
                   << ", databuffer_.empty() = " << databuffer_.empty() 
                   << std::endl;
-             return !databuffer_.empty() || dataCollectionComplete_; }); // Attendi finché non ci sono dati nel buffer o la raccolta dati non è completata
+             return !prioritybuffer_.empty() || !databuffer_.empty() || dataCollectionComplete_; }); // Attendi finché non ci sono dati nel buffer o la raccolta dati non è completata
         std::cout << "Debug (analyzeData): Uscito da wait, databuffer_.empty() = " 
               << databuffer_.empty() 
               << std::endl;
-        if (databuffer_.empty() && dataCollectionComplete_) { 
+        if (prioritybuffer_.empty() && databuffer_.empty() && dataCollectionComplete_) { 
             break; 
         }
-        std::cout << "Debug: Analyzing data..." << std::endl;
         isanalyzing_ = true; // Tale booleano indica che il control center sta analizzando i dati
 
-        auto dataBatch = databuffer_.front();
-        databuffer_.pop();
+        Lane lane {prioritybuffer_.empty() ? Lane::Normal : Lane::Priority};
+        std::queue<PendingBatch>& laneBuffer = (lane == Lane::Priority) ? prioritybuffer_ : databuffer_;
+        std::cout << "Debug: Analyzing data from the " << (lane == Lane::Priority ? "priority" : "normal") << " lane..." << std::endl;
+        PendingBatch pending = std::move(laneBuffer.front()); // Si prende possesso del buffer senza copiarlo
+        laneBuffer.pop();
+        analyzingbatch_ = &pending; // Finché non viene applicato, il batch fa ancora parte dello stato salvato nei checkpoint
+        analyzinglane_ = lane;
+        bufferedreadings_ -= pending.readings.size();
+        cvbufferspace_.notify_all(); // Si è liberato spazio nel buffer: i veicoli in attesa possono riprendere l'invio
+        std::chrono::milliseconds analysisDelay {analysisdelay_};
         lock.unlock();
 
         // Simula il tempo di analisi
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-
-        // Analisi del dato
-        std::map<Sensor::SensorType, double> dataMap;
-        for (const auto& data : dataBatch) {
-            dataMap[data.type] += data.data;
-        }
-
-        int x{dataBatch[0].x};
-        int y{dataBatch[0].y};
-        std::cout << "Debug: Analyzing data for cell (" << x << ", " << y << ")" << std::endl;
-        // Dalle coordinate del veicolo, si ottiene il tipo di suolo e si verifica la presenza di piante
-        Soil AnalyzedSoil;
-        field_.getSoil(x, y, AnalyzedSoil);
-        bool hasPlants{AnalyzedSoil.getPlants()};
-        std::string soilType = AnalyzedSoil.soilTypeToString(AnalyzedSoil.getSoilType());
-
-        std::cout << "Debug: Soil has plants: " << (hasPlants ? "Yes" : "No") << std::endl;
+        std::this_thread::sleep_for(analysisDelay);
+        lock.lock();
+        cvmissioncomplete_.wait(lock, [this] { return capturingstatistics_ == 0; }); // Un checkpoint sta copiando le statistiche
+        analyzingbatch_ = nullptr;
+        applyingbatch_ = true;
+        lock.unlock();
 
         std::vector<std::string> analysisResults;
-        // Se ci sono piante, si procede con l'analisi, altrimenti questa non è necessaria
-        if (hasPlants) {
-            std::cout << "Plants detected, proceeding with analysis." << std::endl;
-            for (const auto& sensorData : dataMap) {
-                std::string result = evaluateData(soilType, sensorData.first, sensorData.second, x, y);
-                std::cout << "  " << Sensor::sensorTypeToString(sensorData.first) << ": " << sensorData.second << " (" << result << ")" << std::endl;
-                analysisResults.push_back(result);
-            }
-        } else {
-            std::cout << "No plants in this area. No need for analysis." << std::endl;
+        // Un batch può contenere le letture di più celle: le letture di una stessa cella sono contigue e vengono analizzate insieme
+        const std::vector<SoilData>& dataBatch = pending.readings;
+        auto cellBegin = dataBatch.begin();
+        while (cellBegin != dataBatch.end()) {
+            int x{cellBegin->x};
+            int y{cellBegin->y};
+            auto cellEnd = std::find_if(cellBegin, dataBatch.end(), [x, y](const SoilData& data) {
+                return data.x != x || data.y != y;
+            });
+            analyzeCell(x, y, cellBegin, cellEnd, analysisResults);
+            cellBegin = cellEnd;
         }
 
+        batchpool_.release(std::move(pending.readings)); // Il buffer analizzato torna nella riserva per essere riutilizzato dai veicoli
+
         lock.lock(); // Riacquisisce il lock per scrivere
         analysisResults_.insert(analysisResults_.end(), analysisResults.begin(), analysisResults.end());
+        applyingbatch_ = false;
+        // Latenza della corsia: tempo trascorso dall'arrivo del batch alla registrazione dei suoi risultati
+        double latencyms {std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending.enqueued).count()};
+        LaneLatency& latency = lanelatency_[static_cast<std::size_t>(lane)];
+        ++latency.batches;
+        latency.totalms += latencyms;
+        latency.maxms = std::max(latency.maxms, latencyms);
+        --inflightbatches_;
+        cvmissioncomplete_.notify_all(); // Chi attende la fine della missione verifica se questo era l'ultimo batch
     }
 
     isanalyzing_ = false;
@@ -121,22 +411,154 @@ void ControlCenter::analyzeData() {
     std::cout << "Debug: Analysis complete for current buffer." << std::endl;
 }
 
+// Funzione privata che analizza le letture di una singola cella e aggiunge i verdetti al vettore dei risultati
+void ControlCenter::analyzeCell(int x, int y, std::vector<SoilData>::const_iterator cellBegin, std::vector<SoilData>::const_iterator cellEnd, std::vector<std::string>& analysisResults) {
+    // Analisi del dato: il verdetto si basa sulle letture della visita corrente (la media, per tipo di sensore, delle letture del batch per questa cella),
+    // così che un peggioramento improvviso non venga diluito dalle visite precedenti. Le letture aggiornano comunque le statistiche incrementali
+    // della cella, usate solo per le interrogazioni di tendenza e di riepilogo.
+    // I valori sono raccolti in array indicizzati per tipo di sensore, senza allocazioni.
+    std::array<double, Sensor::SensorTypeCount> dataMap{};
+    std::array<int, Sensor::SensorTypeCount> dataCount{};
+    std::array<bool, Sensor::SensorTypeCount> dataPresent{};
+    {
+        std::lock_guard<std::mutex> statisticsLock(statisticsmutex_);
+        if (!cellstatistics_.contains(x, y)) {
+            cellstatistics_.resize(field_.getLength(), field_.getWidth()); // Il campo potrebbe essere stato ridimensionato
+        }
+        auto now = std::chrono::steady_clock::now();
+        for (auto data = cellBegin; data != cellEnd; ++data) {
+            cellstatistics_.addReading(x, y, data->type, data->data, now);
+        }
+    }
+    for (auto data = cellBegin; data != cellEnd; ++data) {
+        std::size_t index {static_cast<std::size_t>(data->type)};
+        dataMap[index] += data->data;
+        ++dataCount[index];
+        dataPresent[index] = true;
+    }
+    for (std::size_t index = 0; index < Sensor::SensorTypeCount; ++index) {
+        if (dataPresent[index]) {
+            dataMap[index] /= dataCount[index];
+        }
+    }
+
+    std::cout << "Debug: Analyzing data for cell (" << x << ", " << y << ")" << std::endl;
+    // Dalle coordinate del veicolo, si ottiene il tipo di suolo e si verifica la presenza di piante
+    Soil AnalyzedSoil;
+    field_.getSoil(x, y, AnalyzedSoil);
+    bool hasPlants{AnalyzedSoil.getPlants()};
+    Soil::SoilType soilType {AnalyzedSoil.getSoilType()};
+
+    std::cout << "Debug: Soil has plants: " << (hasPlants ? "Yes" : "No") << std::endl;
+
+    // Se ci sono piante, si procede con l'analisi, altrimenti questa non è necessaria
+    if (hasPlants) {
+        // La gravità della cella (il peggiore dei verdetti) aggiorna la sua priorità nel pattugliamento, anche se l'analisi risulterà invariata
+        int severity {0};
+        for (std::size_t index = 0; index < Sensor::SensorTypeCount; ++index) {
+            if (dataPresent[index]) {
+                severity = std::max(severity, verdictSeverity(classifyValue(soilType, static_cast<Sensor::SensorType>(index), dataMap[index])));
+            }
+        }
+        patrol_.recordVisit(x, y, severity, std::chrono::steady_clock::now());
+        // Se la cella è già stata analizzata con gli stessi valori (entro il rumore dei sensori) il verdetto non cambia:
+        // invece di ricalcolare e registrare di nuovo i risultati si registra un solo risultato breve che segnala la cella come invariata,
+        // così che chi legge i risultati sappia che la cella è stata riletta.
+        {
+            std::lock_guard<std::mutex> cacheLock(statisticsmutex_);
+            if (!analysiscache_.contains(x, y)) {
+                analysiscache_.resize(field_.getLength(), field_.getWidth());
+            }
+            if (analysiscache_.checkAndStore(x, y, soilType, dataMap, dataPresent)) {
+                ++unchangedanalyses_;
+                std::string result {"Unchanged at position (" + std::to_string(x) + ", " + std::to_string(y) + ")"};
+                std::cout << result << std::endl;
+                analysisResults.push_back(result);
+                return;
+            }
+        }
+        std::cout << "Plants detected, proceeding with analysis." << std::endl;
+        for (std::size_t index = 0; index < Sensor::SensorTypeCount; ++index) {
+            if (!dataPresent[index]) {
+                continue;
+            }
+            Sensor::SensorType sensorType{static_cast<Sensor::SensorType>(index)};
+            std::string result = evaluateData(soilType, sensorType, dataMap[index], x, y);
+            std::cout << "  " << Sensor::sensorTypeToString(sensorType) << ": " << dataMap[index] << " (" << result << ")" << std::endl;
+            analysisResults.push_back(result);
+        }
+        // Un suolo troppo asciutto viene irrigato fino al centro dell'intervallo ottimale per il suo tipo
+        if (dataPresent[static_cast<std::size_t>(Sensor::SensorType::MoistureSensor)]
+            && classifyValue(soilType, Sensor::SensorType::MoistureSensor, dataMap[static_cast<std::size_t>(Sensor::SensorType::MoistureSensor)]) == Verdict::CriticalLow) {
+            std::lock_guard<std::mutex> irrigationLock(statisticsmutex_);
+            if (irrigation_) {
+                const Thresholds& thresholds = getThresholds(soilType, Sensor::SensorType::MoistureSensor);
+                irrigation_->requestIrrigation(x, y, (thresholds.optimalmin + thresholds.optimalmax) / 2);
+            }
+        }
+    } else {
+        std::cout << "No plants in this area. No need for analysis." << std::endl;
+        patrol_.releaseCell(x, y); // Una cella pattugliata senza più piante non produce analisi: viene liberata
+    }
+}
+
+
+// Tabella delle soglie usate per valutare le letture: per ogni tipo di suolo (nell'ordine dell'enumerazione SoilType: clay, sand, loam, silt)
+// e per ogni tipo di sensore (nell'ordine dell'enumerazione SensorType: umidità del suolo, temperatura del suolo, umidità dell'aria, temperatura dell'aria)
+// si indicano l'intervallo ottimale e l'intervallo "discreto" che lo contiene; fuori da quest'ultimo il valore è critico.
+// La stessa tabella è usata sia per il verdetto finale sia per la pre-classificazione dei batch in arrivo.
+static const ControlCenter::Thresholds ThresholdTable[4][Sensor::SensorTypeCount] = {
+    // Suoli argillosi: è bene che siano molto umidi, freddi e in ambienti areati
+    {{40, 60, 30, 70}, {15, 22, 10, 28}, {50, 70, 40, 80}, {18, 25, 15, 30}},
+    // Suoli sabbiosi: è bene che siano poco umidi, più caldi e in ambienti caldi
+    {{10, 30, 5, 40}, {18, 25, 10, 30}, {40, 60, 30, 70}, {20, 30, 15, 35}},
+    // Suoli di medio impasto: è bene che siano umidi, caldi e in ambienti caldi e umidi
+    {{25, 50, 20, 60}, {18, 25, 15, 30}, {50, 70, 40, 80}, {20, 28, 15, 32}},
+    // Suoli limosi: è bene che siano umidi, caldi e in ambienti areati e poco umidi
+    {{30, 50, 20, 60}, {16, 24, 10, 30}, {40, 65, 30, 75}, {18, 26, 15, 30}}
+};
+
+// Funzione che restituisce le soglie per un tipo di suolo e un tipo di sensore
+const ControlCenter::Thresholds& ControlCenter::getThresholds(Soil::SoilType soilType, Sensor::SensorType sensorType) {
+    return ThresholdTable[static_cast<std::size_t>(soilType)][static_cast<std::size_t>(sensorType)];
+}
+
+// Funzione che classifica un valore rispetto alla tabella delle soglie: è economica e non costruisce stringhe
+ControlCenter::Verdict ControlCenter::classifyValue(Soil::SoilType soilType, Sensor::SensorType sensorType, double value) {
+    const Thresholds& thresholds = getThresholds(soilType, sensorType);
+    if (value >= thresholds.optimalmin && value <= thresholds.optimalmax) return Verdict::Optimal;
+    if ((value >= thresholds.discretemin && value < thresholds.optimalmin) || (value > thresholds.optimalmax && value <= thresholds.discretemax)) return Verdict::Discrete;
+    return value < thresholds.discretemin ? Verdict::CriticalLow : Verdict::CriticalHigh;
+}
+
+// Funzione che converte un verdetto nella gravità usata dal pattugliamento: gli esiti critici pesano molto più di quelli discreti
+int ControlCenter::verdictSeverity(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Optimal:
+            return 0;
+        case Verdict::Discrete:
+            return 1;
+        default:
+            return 3;
+    }
+}
 
 // Funzione per valutare i dati in base al tipo di sensore e al tipo di suolo
-std::string ControlCenter::evaluateData(const std::string& soilType, Sensor::SensorType sensorType, double value, int x, int y) {
+std::string ControlCenter::evaluateData(Soil::SoilType soilType, Sensor::SensorType sensorType, double value, int x, int y) {
         std::string result;
+        Verdict verdict {classifyValue(soilType, sensorType, value)};
         switch (sensorType) {
         case Sensor::SensorType::MoistureSensor:
-            result = evaluateSoilMoisture(value, soilType);
+            result = evaluateSoilMoisture(verdict);
             break;
         case Sensor::SensorType::SoilTemperatureSensor:
-            result = evaluateSoilTemperature(value, soilType);
+            result = evaluateSoilTemperature(verdict);
             break;
         case Sensor::SensorType::HumiditySensor:
-            result = evaluateAirHumidity(value, soilType);
+            result = evaluateAirHumidity(verdict);
             break;
         case Sensor::SensorType::AirTemperatureSensor:
-            result = evaluateAirTemperature(value, soilType);
+            result = evaluateAirTemperature(verdict);
             break;
         default:
             return "Unrecognized sensor type";
@@ -147,111 +569,43 @@ std::string ControlCenter::evaluateData(const std::string& soilType, Sensor::Sen
     return result;
 }
 
-// Funzione per valutare l'umidità del suolo in base al tipo di suolo: suoli diversi hanno valori di umidità ottimali diversi
-std::string ControlCenter::evaluateSoilMoisture(double value, const std::string& soilType) {
-    if (soilType == "Sand") {
-        if (value >= 10 && value <= 30) return "Optimal soil moisture"; // Suoli sabbiosi è bene che siano poco umidi
-        if ((value >= 5 && value < 10) || (value > 30 && value <= 40)) return "Discrete soil moisture";
-        return "Critical: " + std::string(value < 5 ? "Too dry" : "Too wet");
-    }
-    else if (soilType == "Clay") {
-        if (value >= 40 && value <= 60) return "Optimal soil moisture"; // Suoli argillosi è bene che siano molto umidi
-        if ((value >= 30 && value < 40) || (value > 60 && value <= 70)) return "Discrete soil moisture";
-        return "Critical: " + std::string(value < 30 ? "Too dry" : "Too wet");
-    }
-    else if (soilType == "Silt") {
-        if (value >= 30 && value <= 50) return "Optimal soil moisture"; // Suoli limosi è bene che siano umidi
-        if ((value >= 20 && value < 30) || (value > 50 && value <= 60)) return "Discrete soil moisture";
-        return "Critical: " + std::string(value < 20 ? "Too dry" : "Too wet");
-    }
-    else if (soilType == "Loam") {
-        if (value >= 25 && value <= 50) return "Optimal soil moisture"; // Suoli limosi è bene che siano umidi
-        if ((value >= 20 && value < 25) || (value > 50 && value <= 60)) return "Discrete soil moisture";
-        return "Critical: " + std::string(value < 20 ? "Too dry" : "Too wet");
-    }
-    else {
-        return "Unrecognized soil type";
+// Funzione per tradurre in testo il verdetto sull'umidità del suolo: suoli diversi hanno valori di umidità ottimali diversi, già considerati nella tabella delle soglie
+std::string ControlCenter::evaluateSoilMoisture(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Optimal: return "Optimal soil moisture";
+        case Verdict::Discrete: return "Discrete soil moisture";
+        case Verdict::CriticalLow: return "Critical: Too dry";
+        default: return "Critical: Too wet";
     }
 }
 
-// Funzione per valutare la temperatura del suolo in base al tipo di suolo: suoli diversi hanno valori di temperatura ottimali diversi
-std::string ControlCenter::evaluateSoilTemperature(double value, const std::string& soilType) {
-    if (soilType == "Sand") {
-        if (value >= 18 && value <= 25) return "Optimal soil temperature"; // Suoli sabbiosi è bene che siano più caldi
-        if ((value >= 10 && value < 18) || (value > 25 && value <= 30)) return "Discrete soil temperature";
-        return "Critical: " + std::string(value < 10 ? "Too cold soil" : "Too hot soil");
-    }
-    else if (soilType == "Clay") {
-        if (value >= 15 && value <= 22) return "Optimal soil temperature"; // Suoli argillosi è bene che siano freddi
-        if ((value >= 10 && value < 15) || (value > 22 && value <= 28)) return "Discrete soil temperature";
-        return "Critical: " + std::string(value < 10 ? "Too cold soil" : "Too hot soil");
-    }
-    else if (soilType == "Silt") {
-        if (value >= 16 && value <= 24) return "Optimal soil temperature"; // Suoli limosi è bene che siano caldi
-        if ((value >= 10 && value < 16) || (value > 24 && value <= 30)) return "Discrete soil temperature";
-        return "Critical: " + std::string(value < 10 ? "Too cold soil" : "Too hot soil");
-    }
-    else if (soilType == "Loam") {
-        if (value >= 18 && value <= 25) return "Optimal soil temperature"; // Suoli limosi è bene che siano caldi
-        if ((value >= 15 && value < 18) || (value > 25 && value <= 30)) return "Discrete soil temperature";
-        return "Critical: " + std::string(value < 15 ? "Too cold soil" : "Too hot soil");
-    }
-    else {
-        return "Unrecognized soil type";
+// Funzione per tradurre in testo il verdetto sulla temperatura del suolo
+std::string ControlCenter::evaluateSoilTemperature(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Optimal: return "Optimal soil temperature";
+        case Verdict::Discrete: return "Discrete soil temperature";
+        case Verdict::CriticalLow: return "Critical: Too cold soil";
+        default: return "Critical: Too hot soil";
     }
 }
 
-// Funzione per valutare l'umidità dell'aria in base al tipo di suolo: suoli diversi hanno valori di umidità ottimali diversi
-std::string ControlCenter::evaluateAirHumidity(double value, const std::string& soilType) {
-    if (soilType == "Sand") {
-        if (value >= 40 && value <= 60) return "Optimal air humidity"; // Suoli sabbiosi è bene che siano poco umidi
-        if ((value >= 30 && value < 40) || (value > 60 && value <= 70)) return "Discrete air humidity";
-        return "Critical: " + std::string(value < 30 ? "Too dry air" : "Too humid");
-    }
-    else if (soilType == "Clay") {
-        if (value >= 50 && value <= 70) return "Optimal air humidity"; // Suoli argillosi è bene che siano molto umidi
-        if ((value >= 40 && value < 50) || (value > 70 && value <= 80)) return "Discrete air humidity";
-        return "Critical: " + std::string(value < 40 ? "Too dry air" : "Too humid");
-    }
-    else if (soilType == "Silt") {
-        if (value >= 40 && value <= 65) return "Optimal air humidity"; // Suoli limosi è bene che siano poco umidi
-        if ((value >= 30 && value < 40) || (value > 65 && value <= 75)) return "Discrete air humidity";
-        return "Critical: " + std::string(value < 30 ? "Too dry air" : "Too humid");
-    }
-    else if (soilType == "Loam") {
-        if (value >= 50 && value <= 70) return "Optimal air humidity"; // Suoli limosi è bene che siano tanto umidi
-        if ((value >= 40 && value < 50) || (value > 70 && value <= 80)) return "Discrete air humidity";
-        return "Critical: " + std::string(value < 40 ? "Too dry air" : "Too humid");
-    }
-    else {
-        return "Unrecognized soil type";
+// Funzione per tradurre in testo il verdetto sull'umidità dell'aria
+std::string ControlCenter::evaluateAirHumidity(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Optimal: return "Optimal air humidity";
+        case Verdict::Discrete: return "Discrete air humidity";
+        case Verdict::CriticalLow: return "Critical: Too dry air";
+        default: return "Critical: Too humid";
     }
 }
 
-// Funzione per valutare la temperatura dell'aria in base al tipo di suolo: suoli diversi hanno valori di temperatura ottimali diversi
-std::string ControlCenter::evaluateAirTemperature(double value, const std::string& soilType) {
-    if (soilType == "Sand") {
-        if (value >= 20 && value <= 30) return "Optimal air temperature"; // Suoli sabbiosi è bene che siano in ambienti caldi
-        if ((value >= 15 && value < 20) || (value > 30 && value <= 35)) return "Discrete air temperature";
-        return "Critical: " + std::string(value < 15 ? "Air too cold" : "Air too hot");
-    }
-    else if (soilType == "Clay") {
-        if (value >= 18 && value <= 25) return "Optimal air temperature"; // Suoli argillosi è bene che siano in ambienti areati
-        if ((value >= 15 && value < 18) || (value > 25 && value <= 30)) return "Discrete air temperature";
-        return "Critical: " + std::string(value < 15 ? "Air too cold" : "Air too hot");
-    }
-    else if (soilType == "Silt") {
-        if (value >= 18 && value <= 26) return "Optimal air temperature"; // Suoli limosi è bene che siano in ambienti areati
-        if ((value >= 15 && value < 18) || (value > 26 && value <= 30)) return "Discrete air temperature";
-        return "Critical: " + std::string(value < 15 ? "Air too cold" : "Air too hot");
-    }
-    else if (soilType == "Loam") {
-        if (value >= 20 && value <= 28) return "Optimal air temperature"; // Suoli limosi è bene che siano in ambienti caldi
-        if ((value >= 15 && value < 20) || (value > 28 && value <= 32)) return "Discrete air temperature";
-        return "Critical: " + std::string(value < 15 ? "Air too cold" : "Air too hot");
-    }
-    else {
-        return "Unrecognized soil type";
+// Funzione per tradurre in testo il verdetto sulla temperatura dell'aria
+std::string ControlCenter::evaluateAirTemperature(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Optimal: return "Optimal air temperature";
+        case Verdict::Discrete: return "Discrete air temperature";
+        case Verdict::CriticalLow: return "Critical: Air too cold";
+        default: return "Critical: Air too hot";
     }
 }
 
@@ -260,10 +614,28 @@ std::vector<std::string> ControlCenter::getAnalysisResults() const {
     return analysisResults_;
 }
 
+// Funzione per ottenere le statistiche aggregate di un tipo di sensore per una cella: la lettura è in tempo costante
+SensorStatistics ControlCenter::getCellStatistics(int x, int y, Sensor::SensorType type) const {
+    std::lock_guard<std::mutex> lock(statisticsmutex_);
+    return cellstatistics_.getStatistics(x, y, type);
+}
+
+// Funzione per ottenere la latenza misurata per una corsia di analisi
+ControlCenter::LaneLatency ControlCenter::getLaneLatency(Lane lane) const {
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    return lanelatency_[static_cast<std::size_t>(lane)];
+}
+
+// Funzione che restituisce quante analisi sono state evitate perché la cella era invariata rispetto alla visita precedente
+std::size_t ControlCenter::getUnchangedAnalyses() const {
+    std::lock_guard<std::mutex> lock(statisticsmutex_);
+    return unchangedanalyses_;
+}
+
 // Funzione per verificare se il buffer è vuoto
 bool ControlCenter::isBufferEmpty() {
     std::lock_guard<std::mutex> lock(bufferMutex_);
-    return dataBuffer_.empty();
+    return databuffer_.empty() && prioritybuffer_.empty();
 }
 
 // Funzione per notificare che la raccolta dati è completata
@@ -296,6 +668,7 @@ void ControlCenter::setDataCollectionComplete(bool status) {
               << std::endl;
     // Notifica tutti i thread in attesa che qualcosa è cambiato
     cvnotdata_.notify_all();
+    cvmissioncomplete_.notify_all();
 }
 
 // Funzione per impostare la flag di completamento dell'analisi
@@ -303,6 +676,24 @@ void ControlCenter::setAnalysisComplete(bool status) {
     analysisComplete_ = status;
 }
 
+// Funzione per impostare il numero di veicoli che invieranno dati: può essere richiamata per avviare una nuova fase della missione
 void ControlCenter::setActiveVehicles(int activevehicles) {
-    activevehicles_ = activevehicles;
+    std::lock_guard<std::mutex> lock(bufferMutex_);
+    activevehicles_ = activevehicles > 0 ? activevehicles : 0;
+    dataCollectionComplete_ = (activevehicles_ == 0);
+    cvnotdata_.notify_all();
+    cvmissioncomplete_.notify_all();
+}
+
+// Funzione che blocca il chiamante fino al termine della missione: tutti i veicoli hanno finito di inviare dati
+// e i risultati di tutti i batch ricevuti sono stati registrati. Ritorna nel momento in cui viene registrato l'ultimo risultato.
+void ControlCenter::waitForMissionComplete() {
+    std::unique_lock<std::mutex> lock(bufferMutex_);
+    cvmissioncomplete_.wait(lock, [this] { return dataCollectionComplete_ && inflightbatches_ == 0; });
+}
+
+// Come la precedente, ma con un tempo massimo di attesa: restituisce false se la missione non è terminata entro il timeout
+bool ControlCenter::waitForMissionComplete(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(bufferMutex_);
+    return cvmissioncomplete_.wait_for(lock, timeout, [this] { return dataCollectionComplete_ && inflightbatches_ == 0; });
 }
\ No newline at end of file
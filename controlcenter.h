@@ -1,7 +1,7 @@
 // La classe "ControlCenter" rappresenta il centro di controllo del sistema di monitoraggio agricolo.
 // Per tale ragione, essa viene definita passando per const reference un oggetto di tipo "Field" che rappresenta il campo agricolo da monitorare.
 // Sfruttando i concetti basilari della programmazione concorrente, la classe "ControlCenter" comanda i veicoli sul campo e riceve i dati da essi.
-// All'interno della classe ho infatti un buffer di dati raccolti tramite sensori, oltre che una mappa che tiene traccia delle posizioni dei veicoli.
+// All'interno della classe ho infatti un buffer di dati raccolti tramite sensori, oltre che un registro dei veicoli che tiene traccia delle loro posizioni e del loro stato.
 // La classe ha anche un mutex per proteggere l'accesso a tali strutture dati.
 // Sono presenti vari metodi legati all'invio di comandi ai veicoli, alla raccolta dei dati, all'analisi dei dati e alla restituzione dei risultati.
 // La classe è inoltre dotata di vari metodi per la gestione del buffer e delle variabili di stato.
@@ -12,30 +12,89 @@
 #include "vehicle.h"
 #include "field.h"
 #include "sensor.h"
+#include "soildata.h"
+#include "batchpool.h"
+#include "cellstatistics.h"
+#include "analysiscache.h"
+#include "fleetregistry.h"
+#include "patrolscheduler.h"
+#include "tracerecorder.h"
+#include "irrigationcontroller.h"
 #include <vector>
-#include <map>
 #include <mutex>
 #include <condition_variable>
 using std::condition_variable;
 using std::mutex;
 #include <queue>
+#include <array>
+#include <chrono>
+#include <cstdint>
 
 
-struct SoilData {
-    int x;
-    int y;
-    Sensor::SensorType type;
-    double data; 
-};
-
 class ControlCenter {
     public:
+        // Soglie di valutazione di un tipo di sensore per un tipo di suolo: intervallo ottimale e intervallo discreto che lo contiene
+        struct Thresholds {
+            double optimalmin;
+            double optimalmax;
+            double discretemin;
+            double discretemax;
+        };
+        enum class Verdict {Optimal, Discrete, CriticalLow, CriticalHigh};
+        // Corsie di analisi: i batch con celle sospette critiche passano nella corsia prioritaria
+        enum class Lane {Priority, Normal};
+        struct LaneLatency {
+            std::size_t batches = 0;
+            double totalms = 0.0;
+            double maxms = 0.0;
+            double meanms() const { return batches > 0 ? totalms / batches : 0.0; }
+        };
+        // Statistiche di un tipo di sensore in una cella, come vengono salvate nei checkpoint della missione
+        struct CellStatisticsEntry {
+            int x;
+            int y;
+            Sensor::SensorType type;
+            SensorStatistics statistics;
+        };
+        // Stato della missione salvato nei checkpoint: batch in attesa di analisi (compreso quello in analisi), risultati e statistiche delle celle
+        struct MissionState {
+            std::vector<std::pair<Lane, std::vector<SoilData>>> batches; // Nell'ordine in cui verranno analizzati in ogni corsia
+            std::size_t resultsfrom = 0; // Indice del primo risultato contenuto in results
+            std::size_t resultcount = 0; // Numero totale di risultati registrati
+            std::vector<std::string> results;
+            int activevehicles = 0;
+            std::vector<CellStatisticsEntry> statistics; // Solo le celle con almeno una lettura
+        };
         ControlCenter(const Field& field);
+        int registerVehicle(Vehicle& vehicle);
+        const FleetRegistry& getFleet() const { return fleet_; }
+        std::size_t collectTelemetry(std::vector<TelemetrySample>& samples);
         void sendMovementCommandToVehicle(Vehicle& vehicle, int x, int y);
-        void commandDataRead(Vehicle& vehicle);
-        void appendData(const std::vector<SoilData>& dataBatch);
+        bool commandDataRead(Vehicle& vehicle);
+        void commandDataFlush(Vehicle& vehicle);
+        void startPatrol(const std::vector<std::pair<int, int>>& cells, std::size_t budget);
+        PatrolScheduler::Dispatch dispatchPatrolVisit(Vehicle& vehicle);
+        void stopPatrol();
+        std::uint64_t getChangedPlantCells(std::uint64_t generation, std::vector<std::pair<int, int>>& cells);
+        void captureMissionState(MissionState& state, std::size_t resultsfrom);
+        void restoreMissionState(const MissionState& state);
+        std::size_t getPatrolVisits() const { return patrol_.getVisits(); }
+        int getPatrolSeverity(int x, int y) const { return patrol_.getSeverity(x, y); }
+        void appendData(std::vector<SoilData>&& dataBatch, int vehicleid = -1);
+        void setTraceRecorder(TraceRecorder* recorder);
+        void setIrrigationController(IrrigationController* irrigation);
+        std::vector<SoilData> acquireBatch();
+        std::size_t getBatchAllocations() const { return batchpool_.getAllocations(); }
+        void setBufferWatermark(std::size_t readings);
+        void setAnalysisDelay(std::chrono::milliseconds delay);
         void analyzeData();
         std::vector<std::string> getAnalysisResults() const;
+        SensorStatistics getCellStatistics(int x, int y, Sensor::SensorType type) const;
+        LaneLatency getLaneLatency(Lane lane) const;
+        std::size_t getUnchangedAnalyses() const;
+        static const Thresholds& getThresholds(Soil::SoilType soilType, Sensor::SensorType sensorType);
+        static Verdict classifyValue(Soil::SoilType soilType, Sensor::SensorType sensorType, double value);
+        static int verdictSeverity(Verdict verdict);
         bool isBufferEmpty();
         void notifyDataCollectionComplete();
         bool isAnalyzing();
@@ -44,23 +103,53 @@ class ControlCenter {
         bool isAnalysisComplete() const { return analysisComplete_; }
         void setAnalysisComplete(bool status);
         void setActiveVehicles(int activevehicles);
+        void waitForMissionComplete();
+        bool waitForMissionComplete(std::chrono::milliseconds timeout);
 
     private:
         const Field& field_;
-        std::map<int, std::pair<int, int>> vehiclepositions_;
-        std::queue<vector<SoilData>> databuffer_;
-        std::mutex bufferMutex_;
+        FleetRegistry fleet_; // Registro denso dei veicoli comandati: posizioni, batteria, stato
+        std::mutex telemetrymutex_; // Garantisce un solo lettore alla volta per i buffer di telemetria dei veicoli
+        // Batch in attesa di analisi, con l'istante di arrivo per misurare la latenza della corsia
+        struct PendingBatch {
+            std::vector<SoilData> readings;
+            std::chrono::steady_clock::time_point enqueued;
+        };
+        std::queue<PendingBatch> prioritybuffer_;
+        std::queue<PendingBatch> databuffer_;
+        const PendingBatch* analyzingbatch_ = nullptr; // Batch prelevato e in attesa del tempo di analisi, non ancora applicato alle statistiche
+        Lane analyzinglane_ = Lane::Normal;
+        bool applyingbatch_ = false; // Vero mentre le letture di un batch aggiornano statistiche e risultati
+        int capturingstatistics_ = 0; // Numero di checkpoint che stanno copiando le statistiche: nel frattempo nessun batch viene applicato
+        std::array<LaneLatency, 2> lanelatency_{};
+        mutable std::mutex bufferMutex_;
         std::mutex vehiclepositionmutex_;
         std::condition_variable cvnotdata_;
         std::condition_variable cellfreecv_;
-        std::vector<std::string> dataBuffer_;
+        std::condition_variable cvbufferspace_;
+        std::size_t bufferedreadings_ = 0; // Numero di letture attualmente in attesa nel buffer
+        std::size_t bufferwatermark_ = 256; // Oltre questa soglia i veicoli attendono prima di inviare altri dati
+        std::chrono::milliseconds analysisdelay_{5000}; // Tempo di analisi simulato per ogni batch
+        BatchPool batchpool_; // Riserva di buffer riutilizzati tra veicoli e control center
+        CellStatistics cellstatistics_; // Statistiche incrementali delle letture di ogni cella
+        AnalysisCache analysiscache_; // Chiave dell'ultima analisi di ogni cella, per evitare di ripetere analisi invariate
+        std::size_t unchangedanalyses_ = 0;
+        TraceRecorder* tracerecorder_ = nullptr; // Se impostato, registra ogni batch ricevuto
+        IrrigationController* irrigation_ = nullptr; // Se impostato, riceve una richiesta di irrigazione per ogni cella con suolo troppo asciutto
+        PatrolScheduler patrol_; // Coda di priorità delle celle da rivisitare durante il pattugliamento
+        mutable std::mutex statisticsmutex_; // Protegge statistiche e cache delle analisi
         std::vector<std::string> analysisResults_;
-        std::string evaluateData(const std::string& soilType, Sensor::SensorType sensorType, double value, int x, int y);
-        std::string evaluateSoilMoisture(double value, const std::string& soilType);
-        std::string evaluateSoilTemperature(double value, const std::string& soilType);
-        std::string evaluateAirTemperature(double value, const std::string& soilType);
-        std::string evaluateAirHumidity(double value, const std::string& soilType);
-        int activevehicles_;
+        std::vector<SoilData> extractSuspectCells(std::vector<SoilData>& dataBatch);
+        bool isSuspectReading(const SoilData& data) const;
+        void analyzeCell(int x, int y, std::vector<SoilData>::const_iterator cellBegin, std::vector<SoilData>::const_iterator cellEnd, std::vector<std::string>& analysisResults);
+        std::string evaluateData(Soil::SoilType soilType, Sensor::SensorType sensorType, double value, int x, int y);
+        std::string evaluateSoilMoisture(Verdict verdict);
+        std::string evaluateSoilTemperature(Verdict verdict);
+        std::string evaluateAirTemperature(Verdict verdict);
+        std::string evaluateAirHumidity(Verdict verdict);
+        std::condition_variable cvmissioncomplete_;
+        std::size_t inflightbatches_ = 0; // Batch ricevuti i cui risultati non sono ancora stati registrati
+        int activevehicles_ = 0;
         bool isanalyzing_ = false;
         bool dataCollectionComplete_ = false;
         bool analysisComplete_ = false;
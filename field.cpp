@@ -3,27 +3,302 @@ using std::vector;
 #include <algorithm>
 using std::fill;
 using std::for_each;
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <limits>
 #include "field.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Formato binario del campo (versione 1), con tutti i valori little-endian:
+// - un'intestazione di 128 byte: "AGFIELD\0", versione, flag (riservati, a zero), lunghezza, larghezza, lunghezza del nome, un campo riservato,
+//   la posizione nel file dei sei blocchi di colonne e il nome del campo (al più 48 caratteri, non terminato);
+// - i blocchi di colonne, ognuno allineato a 64 byte: tipo di suolo (un byte per cella), bitmap delle piante (parole da 64 bit),
+//   umidità del suolo (double), temperatura dell'aria (float), umidità dell'aria (double) e temperatura del suolo (float).
+// Le celle sono in ordine di riga come in memoria, quindi il file mappato si usa direttamente al posto dei vettori.
+namespace {
+    constexpr char SnapshotMagic[8] = {'A', 'G', 'F', 'I', 'E', 'L', 'D', '\0'};
+    constexpr std::uint32_t SnapshotVersion = 1;
+    constexpr std::size_t SnapshotAlignment = 64;
+    constexpr std::size_t SnapshotNameLength = 48;
+    constexpr std::uint8_t SoilTypeCount = static_cast<std::uint8_t>(Soil::SoilType::silt) + 1; // I byte del tipo di suolo devono essere minori
+
+    struct SnapshotHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t flags;
+        std::uint32_t length;
+        std::uint32_t width;
+        std::uint32_t namelength;
+        std::uint32_t reserved;
+        std::uint64_t offsets[6];
+        char name[SnapshotNameLength];
+    };
+    static_assert(sizeof(SnapshotHeader) == 128, "L'intestazione del formato binario deve occupare 128 byte");
+
+    // Il formato è little-endian e viene usato senza conversioni: su macchine big-endian salvataggio e apertura vengono rifiutati
+    bool littleEndianHost()
+    {
+        const std::uint16_t probe {1};
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    std::size_t alignOffset(std::size_t offset)
+    {
+        return (offset + SnapshotAlignment - 1) / SnapshotAlignment * SnapshotAlignment;
+    }
+
+    // Codifica compatta: le percentuali in cinquecentesimi di punto (0 - 50000), le temperature in centesimi di grado con segno.
+    // L'arrotondamento al valore più vicino dà un errore massimo di mezzo passo.
+    // Le scale sono quelle delle proiezioni delle viste ("fieldview.h"), che decodificano i valori allo stesso modo.
+    constexpr double PercentageScale = PercentageProjection::Scale;
+    constexpr double TemperatureScale = TemperatureProjection::Scale;
+
+    std::uint16_t encodePercentage(double value)
+    {
+        return static_cast<std::uint16_t>(std::lround(std::min(100.0, std::max(0.0, value)) * PercentageScale));
+    }
+
+    double decodePercentage(std::uint16_t code)
+    {
+        return code / PercentageScale;
+    }
+
+    std::int16_t encodeTemperature(float value)
+    {
+        return static_cast<std::int16_t>(std::lround(std::min(327.67, std::max(-327.68, static_cast<double>(value))) * TemperatureScale));
+    }
+
+    float decodeTemperature(std::int16_t code)
+    {
+        return static_cast<float>(code / TemperatureScale);
+    }
+
+    // Dimensioni in byte dei sei blocchi di colonne per un campo di n celle
+    void blockSizes(std::size_t cells, std::size_t sizes[6])
+    {
+        sizes[0] = cells * sizeof(std::uint8_t);
+        sizes[1] = (cells + 63) / 64 * sizeof(std::uint64_t);
+        sizes[2] = cells * sizeof(double);
+        sizes[3] = cells * sizeof(float);
+        sizes[4] = cells * sizeof(double);
+        sizes[5] = cells * sizeof(float);
+    }
+}
 
 // Costruttore di default: viene inizializzato un campo di dimensioni 1x1 con nome "???".
 Field::Field()
     :fieldname_{"???"},
     length_{1},
     width_{1},
-    field_{vector<vector<Soil>>(1, vector<Soil>(1))} // Si è scelto di inizializzare il campo con tale elemento per simulare l'idea di "costruire da zero" il proprio campo.
-    {}
+    columns_{},
+    compact_{},
+    compacted_{false},
+    mapping_{nullptr},
+    mappingsize_{0},
+    mapped_{false},
+    generation_{0},
+    loggeneration_{0},
+    pyramidstale_{true}
+    {
+        allocateColumns(length_, width_); // Si è scelto di inizializzare il campo con Soil() per simulare l'idea di "costruire da zero" il proprio campo.
+    }
 // Costruttore con parametri: crea una matrice length*witdh riempendola del tipo di suolo Soil()
 Field::Field(std::string fieldname, int length, int width)
     :fieldname_{fieldname},
     length_{length},
     width_{width},
-    field_{vector<vector<Soil>>(length, vector<Soil>(width))}
+    columns_{},
+    compact_{},
+    compacted_{false},
+    mapping_{nullptr},
+    mappingsize_{0},
+    mapped_{false},
+    generation_{0},
+    loggeneration_{0},
+    pyramidstale_{true}
     {
-        for (auto row = field_.begin(); row != field_.end(); ++row)
-        {
-            std::fill((*row).begin(), (*row).end(), Soil());
+        allocateColumns(length_, width_);
+    }
+
+// Distruttore: rilascia l'eventuale immagine mappata in memoria
+Field::~Field()
+{
+    unmap();
+}
+
+// Funzione privata che crea colonne di dimensione length*width riempite con i valori di Soil()
+void Field::allocateColumns(int length, int width)
+{
+    const Soil soil;
+    std::size_t cells {static_cast<std::size_t>(length) * width};
+    soiltypes_.assign(cells, static_cast<std::uint8_t>(soil.soiltype_));
+    plants_.assign((cells + 63) / 64, soil.plants_ ? ~std::uint64_t{0} : 0);
+    soilmoisture_.assign(cells, soil.soilmoisture_);
+    airtemperature_.assign(cells, soil.airtemperature_);
+    airhumidity_.assign(cells, soil.airhumidity_);
+    soiltemperature_.assign(cells, soil.soiltemperature_);
+    bindColumns();
+}
+
+// Funzione privata che fa puntare le colonne di lettura ai vettori in memoria privata
+void Field::bindColumns()
+{
+    columns_ = {soiltypes_.data(), plants_.data(), soilmoisture_.data(), airtemperature_.data(), airhumidity_.data(), soiltemperature_.data()};
+    mapped_ = false;
+    compacted_ = false;
+}
+
+// Funzione privata, chiamata con il mutex acquisito prima di ogni scrittura: se il campo è ancora quello mappato, ne copia le colonne in memoria privata.
+// L'immagine resta mappata, così che un lettore che sta ancora usando i vecchi puntatori non acceda a memoria rilasciata.
+void Field::materialize()
+{
+    if (compacted_) {
+        expand();
+        return;
+    }
+    if (!mapped_) {
+        return;
+    }
+    std::size_t cells {static_cast<std::size_t>(length_) * width_};
+    soiltypes_.assign(columns_.soiltype, columns_.soiltype + cells);
+    plants_.assign(columns_.plants, columns_.plants + (cells + 63) / 64);
+    soilmoisture_.assign(columns_.soilmoisture, columns_.soilmoisture + cells);
+    airtemperature_.assign(columns_.airtemperature, columns_.airtemperature + cells);
+    airhumidity_.assign(columns_.airhumidity, columns_.airhumidity + cells);
+    soiltemperature_.assign(columns_.soiltemperature, columns_.soiltemperature + cells);
+    bindColumns();
+}
+
+// Funzione che comprime le colonne del campo nella codifica compatta descritta in "field.h" e rilascia quelle normali:
+// le colonne passano da 25 a 9 byte per cella, il 36% della memoria.
+// Le colonne normali vengono liberate: come changeDimensions, va chiamata quando nessun altro thread sta leggendo il campo.
+// Il contenuto del campo non cambia entro la precisione della codifica, quindi la generazione resta la stessa.
+void Field::compact()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (compacted_) {
+        return;
+    }
+    std::size_t cells {static_cast<std::size_t>(length_) * width_};
+    compact_.soilcells.resize(cells);
+    compact_.soilmoisture.resize(cells);
+    compact_.airtemperature.resize(cells);
+    compact_.airhumidity.resize(cells);
+    compact_.soiltemperature.resize(cells);
+    for (std::size_t index = 0; index < cells; ++index) {
+        compact_.soilcells[index] = static_cast<std::uint8_t>(columns_.soiltype[index] | (hasPlants(index) ? 0x80 : 0));
+        compact_.soilmoisture[index] = encodePercentage(columns_.soilmoisture[index]);
+        compact_.airtemperature[index] = encodeTemperature(columns_.airtemperature[index]);
+        compact_.airhumidity[index] = encodePercentage(columns_.airhumidity[index]);
+        compact_.soiltemperature[index] = encodeTemperature(columns_.soiltemperature[index]);
+    }
+    compacted_ = true;
+    pyramidstale_ = true; // I valori decodificati differiscono da quelli originali entro la precisione della codifica
+    mapped_ = false; // Un'eventuale immagine mappata resta aperta fino alla distruzione del campo, ma non viene più letta
+    columns_ = {};
+    vector<std::uint8_t>().swap(soiltypes_);
+    vector<std::uint64_t>().swap(plants_);
+    vector<double>().swap(soilmoisture_);
+    vector<float>().swap(airtemperature_);
+    vector<double>().swap(airhumidity_);
+    vector<float>().swap(soiltemperature_);
+}
+
+// Funzione privata, chiamata con il mutex acquisito, che riporta un campo compatto nelle colonne normali in memoria privata e libera le colonne compatte,
+// così che il campo espanso non occupi la memoria di entrambe le codifiche
+void Field::expand()
+{
+    std::size_t cells {static_cast<std::size_t>(length_) * width_};
+    soiltypes_.resize(cells);
+    plants_.assign((cells + 63) / 64, 0);
+    soilmoisture_.resize(cells);
+    airtemperature_.resize(cells);
+    airhumidity_.resize(cells);
+    soiltemperature_.resize(cells);
+    for (std::size_t index = 0; index < cells; ++index) {
+        std::uint8_t soilcell {compact_.soilcells[index]};
+        soiltypes_[index] = soilcell & 0x7F;
+        if (soilcell & 0x80) {
+            plants_[index >> 6] |= std::uint64_t{1} << (index & 63);
         }
+        soilmoisture_[index] = decodePercentage(compact_.soilmoisture[index]);
+        airtemperature_[index] = decodeTemperature(compact_.airtemperature[index]);
+        airhumidity_[index] = decodePercentage(compact_.airhumidity[index]);
+        soiltemperature_[index] = decodeTemperature(compact_.soiltemperature[index]);
+    }
+    bindColumns();
+    compact_ = CompactColumns();
+}
+
+// Funzione che restituisce la memoria occupata dalle colonne del campo, compatte e normali, esclusa un'eventuale immagine mappata
+std::size_t Field::getColumnBytes() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return soiltypes_.capacity() * sizeof(std::uint8_t) + plants_.capacity() * sizeof(std::uint64_t) + soilmoisture_.capacity() * sizeof(double)
+           + airtemperature_.capacity() * sizeof(float) + airhumidity_.capacity() * sizeof(double) + soiltemperature_.capacity() * sizeof(float)
+           + compact_.soilcells.capacity() * sizeof(std::uint8_t) + compact_.soilmoisture.capacity() * sizeof(std::uint16_t)
+           + compact_.airtemperature.capacity() * sizeof(std::int16_t) + compact_.airhumidity.capacity() * sizeof(std::uint16_t)
+           + compact_.soiltemperature.capacity() * sizeof(std::int16_t);
+}
+
+// Funzione privata che rilascia l'immagine mappata in memoria
+void Field::unmap()
+{
+    if (mapping_ == nullptr) {
+        return;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(mapping_, mappingsize_);
+#endif
+    mapping_ = nullptr;
+    mappingsize_ = 0;
+}
+
+// Funzione privata che ricompone la cella di indice dato a partire dalle colonne
+Soil Field::cellAt(std::size_t index) const
+{
+    Soil soil;
+    if (compacted_) {
+        std::uint8_t soilcell {compact_.soilcells[index]};
+        soil.soiltype_ = static_cast<Soil::SoilType>(soilcell & 0x7F);
+        soil.plants_ = (soilcell & 0x80) != 0;
+        soil.soilmoisture_ = decodePercentage(compact_.soilmoisture[index]);
+        soil.airtemperature_ = decodeTemperature(compact_.airtemperature[index]);
+        soil.airhumidity_ = decodePercentage(compact_.airhumidity[index]);
+        soil.soiltemperature_ = decodeTemperature(compact_.soiltemperature[index]);
+        return soil;
+    }
+    soil.soiltype_ = static_cast<Soil::SoilType>(columns_.soiltype[index]);
+    soil.plants_ = hasPlants(index);
+    soil.soilmoisture_ = columns_.soilmoisture[index];
+    soil.airtemperature_ = columns_.airtemperature[index];
+    soil.airhumidity_ = columns_.airhumidity[index];
+    soil.soiltemperature_ = columns_.soiltemperature[index];
+    return soil;
+}
+
+// Funzione privata che scrive la cella di indice dato nelle colonne in memoria privata
+void Field::storeCell(std::size_t index, const Soil& soil)
+{
+    soiltypes_[index] = static_cast<std::uint8_t>(soil.soiltype_);
+    if (soil.plants_) {
+        plants_[index >> 6] |= std::uint64_t{1} << (index & 63);
+    } else {
+        plants_[index >> 6] &= ~(std::uint64_t{1} << (index & 63));
     }
+    soilmoisture_[index] = soil.soilmoisture_;
+    airtemperature_[index] = soil.airtemperature_;
+    airhumidity_[index] = soil.airhumidity_;
+    soiltemperature_[index] = soil.soiltemperature_;
+}
 
 // Setta il tipo di suolo, comprensivo di tutti i parametri della classe Soil, in un'area specifica della matrice
 void Field::setSoil(const Soil& soil, int startlength, int endlength, int startwidth, int endwidth)
@@ -34,14 +309,29 @@ void Field::setSoil(const Soil& soil, int startlength, int endlength, int startw
                 std::cerr << "Selected range is out of boundaries." << std::endl;
                 exit(EXIT_FAILURE);
         }
-        // Per ogni riga della matrice, si riempie l'area selezionata con il tipo di suolo Soil() usando il concetto di iteratori ed algoritmi della libreria standard.
-        for (auto row = field_.begin() + startlength; row != field_.begin() + endlength + 1; ++row) { 
-                std::fill((*row).begin() + startwidth, (*row).begin() + endwidth + 1, soil);
-
+        materialize();
+        // Per ogni riga della matrice, si riempie l'area selezionata di ogni colonna usando gli algoritmi della libreria standard.
+        for (int row = startlength; row <= endlength; ++row) {
+                std::size_t first {cellIndex(row, startwidth)};
+                std::size_t last {cellIndex(row, endwidth) + 1};
+                std::fill(soiltypes_.begin() + first, soiltypes_.begin() + last, static_cast<std::uint8_t>(soil.soiltype_));
+                std::fill(soilmoisture_.begin() + first, soilmoisture_.begin() + last, soil.soilmoisture_);
+                std::fill(airtemperature_.begin() + first, airtemperature_.begin() + last, soil.airtemperature_);
+                std::fill(airhumidity_.begin() + first, airhumidity_.begin() + last, soil.airhumidity_);
+                std::fill(soiltemperature_.begin() + first, soiltemperature_.begin() + last, soil.soiltemperature_);
+                for (std::size_t index = first; index < last; ++index) {
+                        if (soil.plants_) {
+                                plants_[index >> 6] |= std::uint64_t{1} << (index & 63);
+                        } else {
+                                plants_[index >> 6] &= ~(std::uint64_t{1} << (index & 63));
+                        }
+                }
         }
+        recordChange(startlength, endlength, startwidth, endwidth);
     }
 
 // Tale funzione si usa nel momento in cui si voglia cambiare una sola specifica proprietà del suolo in un'area specifica del campo e non l'intera cella.
+// Ogni cella viene ricomposta dalle colonne, modificata e riscritta.
 void Field::modifySoilProperty(int startlength, int endlength, int startwidth, int endwidth, std::function<void(Soil&)> modifyFunc)
     {
          std::lock_guard<std::mutex> lock(mtx_);
@@ -49,9 +339,88 @@ void Field::modifySoilProperty(int startlength, int endlength, int startwidth, i
                 std::cerr << "Selected range is out of boundaries." << std::endl;
                 exit(EXIT_FAILURE);
         }
+        materialize();
+        for (int row = startlength; row <= endlength; ++row) {
+                for (int col = startwidth; col <= endwidth; ++col) {
+                        std::size_t index {cellIndex(row, col)};
+                        Soil soil {cellAt(index)};
+                        modifyFunc(soil);
+                        storeCell(index, soil);
+                }
+        }
+        recordChange(startlength, endlength, startwidth, endwidth);
+    }
+
+// Funzione che applica in una sola scrittura le nuove condizioni atmosferiche di più aree del campo: il lucchetto viene preso una volta,
+// le colonne dell'aria vengono riempite riga per riga e la temperatura del suolo ricalcolata, come farebbero i setter di Soil.
+// Tutte le aree vengono controllate prima di modificare il campo; la generazione del campo aumenta di uno per l'intero gruppo di aree.
+void Field::applyRegionUpdates(const std::vector<RegionUpdate>& updates)
+    {
+        if (updates.empty()) {
+                return;
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const RegionUpdate& update : updates) {
+                if (!CheckBoundaries(update.startlength, update.endlength, update.startwidth, update.endwidth)) {
+                        std::cerr << "Selected range is out of boundaries." << std::endl;
+                        exit(EXIT_FAILURE);
+                }
+                if (update.airhumidity < 0 || update.airhumidity > 100) {
+                        std::cerr << "Invalid humidity or moisture value. Humidity and moisture must be between 0 and 100." << std::endl;
+                        exit(EXIT_FAILURE);
+                }
+        }
+        materialize();
+        ++generation_;
+        for (const RegionUpdate& update : updates) {
+                for (int row = update.startlength; row <= update.endlength; ++row) {
+                        std::size_t first {cellIndex(row, update.startwidth)};
+                        std::size_t last {cellIndex(row, update.endwidth) + 1};
+                        std::fill(airtemperature_.begin() + first, airtemperature_.begin() + last, update.airtemperature);
+                        std::fill(airhumidity_.begin() + first, airhumidity_.begin() + last, update.airhumidity);
+                        for (std::size_t index = first; index < last; ++index) {
+                                soiltemperature_[index] = Soil::soilTemperature(static_cast<Soil::SoilType>(soiltypes_[index]), soilmoisture_[index],
+                                                                                update.airtemperature, update.airhumidity);
+                        }
+                }
+                logChange(update.startlength, update.endlength, update.startwidth, update.endwidth);
+        }
+    }
 
-        for (auto row = field_.begin() + startlength; row != field_.begin() + endlength + 1; ++row) {
-                std::for_each((*row).begin() + startwidth, (*row).begin() + endwidth + 1, modifyFunc);
+// Funzione che applica in una sola scrittura i comandi di irrigazione di più aree del campo: nelle celle più asciutte del valore indicato
+// l'umidità del suolo viene portata a quel valore e la temperatura del suolo ricalcolata. Come per le aree meteo, tutte le aree vengono controllate
+// prima di modificare il campo e la generazione del campo aumenta di uno per l'intero gruppo.
+void Field::applyIrrigation(const std::vector<IrrigationUpdate>& updates)
+    {
+        if (updates.empty()) {
+                return;
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const IrrigationUpdate& update : updates) {
+                if (!CheckBoundaries(update.startlength, update.endlength, update.startwidth, update.endwidth)) {
+                        std::cerr << "Selected range is out of boundaries." << std::endl;
+                        exit(EXIT_FAILURE);
+                }
+                if (update.soilmoisture < 0 || update.soilmoisture > 100) {
+                        std::cerr << "Invalid humidity or moisture value. Humidity and moisture must be between 0 and 100." << std::endl;
+                        exit(EXIT_FAILURE);
+                }
+        }
+        materialize();
+        ++generation_;
+        for (const IrrigationUpdate& update : updates) {
+                for (int row = update.startlength; row <= update.endlength; ++row) {
+                        std::size_t first {cellIndex(row, update.startwidth)};
+                        std::size_t last {cellIndex(row, update.endwidth) + 1};
+                        for (std::size_t index = first; index < last; ++index) {
+                                if (soilmoisture_[index] < update.soilmoisture) {
+                                        soilmoisture_[index] = update.soilmoisture;
+                                        soiltemperature_[index] = Soil::soilTemperature(static_cast<Soil::SoilType>(soiltypes_[index]), update.soilmoisture,
+                                                                                        airtemperature_[index], airhumidity_[index]);
+                                }
+                        }
+                }
+                logChange(update.startlength, update.endlength, update.startwidth, update.endwidth);
         }
     }
 
@@ -68,9 +437,7 @@ void Field::changeDimensions(int lengthChange, int widthChange)
     calculateNewDimensions(lengthChange, widthChange, newLength, newWidth); // Calcola le nuove dimensioni del campo con la funzione calculateNewDimensions
     int oldLength {length_}; 
     int oldWidth  {width_};
-    resizeField(newLength, newWidth); // Ridimensiona il campo 
-    length_ = newLength; // Aggiorna la lunghezza del campo
-    width_ = newWidth;  // Aggiorna la larghezza del campo
+    resizeField(newLength, newWidth); // Ridimensiona il campo e ne aggiorna lunghezza e larghezza
     // Se le nuove dimensioni sono maggiori delle vecchie, allora si riempie la parte aggiunta con il tipo di suolo Soil()
     if (newLength > oldLength) {
         setSoil(Soil(), oldLength, newLength - 1, 0, newWidth - 1);
@@ -103,90 +470,544 @@ void Field::calculateNewDimensions(int lengthChange, int widthChange, int& newLe
     }
 }
 
-// Funzione privata usata per ridimensionare il campo
+// Funzione privata usata per ridimensionare il campo: le colonne vengono ricostruite con le nuove dimensioni, copiando riga per riga la parte comune.
+// Le dimensioni vengono aggiornate insieme alle colonne, così che l'indice delle celle sia sempre coerente con esse.
 void Field::resizeField(int newlength, int newwidth)
 {
     std::lock_guard<std::mutex> lock(mtx_); // Nel mentre in cui si ridimensiona il campo, si protegge l'accesso alla matrice per evitare che altri thread possano accedervi.
-    field_.resize(newlength); 
-    for (auto& row : field_) {
-        row.resize(newwidth);
+    if (compacted_) {
+        expand();
+    }
+    std::size_t cells {static_cast<std::size_t>(newlength) * newwidth};
+    vector<std::uint8_t> soiltypes(cells);
+    vector<std::uint64_t> plants((cells + 63) / 64, 0);
+    vector<double> soilmoisture(cells);
+    vector<float> airtemperature(cells);
+    vector<double> airhumidity(cells);
+    vector<float> soiltemperature(cells);
+    int rows {std::min(length_, newlength)};
+    int cols {std::min(width_, newwidth)};
+    for (int row = 0; row < rows; ++row) {
+        std::size_t from {cellIndex(row, 0)};
+        std::size_t to {static_cast<std::size_t>(row) * newwidth};
+        std::copy(columns_.soiltype + from, columns_.soiltype + from + cols, soiltypes.begin() + to);
+        std::copy(columns_.soilmoisture + from, columns_.soilmoisture + from + cols, soilmoisture.begin() + to);
+        std::copy(columns_.airtemperature + from, columns_.airtemperature + from + cols, airtemperature.begin() + to);
+        std::copy(columns_.airhumidity + from, columns_.airhumidity + from + cols, airhumidity.begin() + to);
+        std::copy(columns_.soiltemperature + from, columns_.soiltemperature + from + cols, soiltemperature.begin() + to);
+        for (int col = 0; col < cols; ++col) {
+            if (hasPlants(from + col)) {
+                plants[(to + col) >> 6] |= std::uint64_t{1} << ((to + col) & 63);
+            }
+        }
     }
+    soiltypes_.swap(soiltypes);
+    plants_.swap(plants);
+    soilmoisture_.swap(soilmoisture);
+    airtemperature_.swap(airtemperature);
+    airhumidity_.swap(airhumidity);
+    soiltemperature_.swap(soiltemperature);
+    bindColumns();
+    length_ = newlength;
+    width_ = newwidth;
+    ++generation_; // Le celle eliminate non vanno rilevate; quelle aggiunte vengono registrate da setSoil
+    pyramidstale_ = true;
 }
 
-// Funzione che restituisce la presenza di piante in un'area specifica del campo
-vector<vector<bool>> Field::getPlants(int startlength, int endlength, int startwidth, int endwidth) const
+// Funzione privata, chiamata con il mutex acquisito, che registra un'area modificata con una nuova generazione.
+// Una scrittura che copre l'area dell'ultima modifica la sostituisce, senza allungare il registro: chi deve rilevare l'area vecchia rileva comunque quella nuova.
+void Field::recordChange(int startlength, int endlength, int startwidth, int endwidth)
 {
-    if (!CheckBoundaries(startlength, endlength, startwidth, endwidth)) {
-            std::cerr << "Selected range is out of boundaries." << std::endl;
-            exit(EXIT_FAILURE);
+    ++generation_;
+    logChange(startlength, endlength, startwidth, endwidth);
+}
+
+// Funzione privata che aggiunge al registro un rettangolo modificato con la generazione attuale e aggiorna la piramide in quel rettangolo.
+// Una modifica dell'intero campo rimanda invece la ricostruzione della piramide alla prima sintesi.
+void Field::logChange(int startlength, int endlength, int startwidth, int endwidth)
+{
+    if (startlength == 0 && endlength == length_ - 1 && startwidth == 0 && endwidth == width_ - 1) {
+        pyramidstale_ = true;
+    } else if (!pyramidstale_) {
+        pyramid_.update(pyramidSources(), startlength, endlength, startwidth, endwidth);
+    }
+    if (!changelog_.empty()) {
+        ChangeRecord& last = changelog_.back();
+        if (startlength <= last.startlength && endlength >= last.endlength && startwidth <= last.startwidth && endwidth >= last.endwidth) {
+            last = {generation_, startlength, endlength, startwidth, endwidth};
+            return;
         }
+    }
+    changelog_.push_back({generation_, startlength, endlength, startwidth, endwidth});
+    if (changelog_.size() > MaxChangeRecords) {
+        loggeneration_ = changelog_.front().generation; // Le richieste precedenti a questa generazione non sono più soddisfacibili
+        changelog_.pop_front();
+    }
+}
 
-    vector<vector<bool>> plants(endlength - startlength + 1, vector<bool>(endwidth - startwidth + 1)); // 
-    auto row = field_.begin() + startlength;
-    for (int i = 0; row != field_.begin() + endlength + 1; ++row, ++i) {
-        transform((*row).begin() + startwidth, (*row).begin() + endwidth + 1, plants[i].begin(), [](const Soil& soil) {
-            return soil.getPlants();
-        });
+// Funzione che restituisce la generazione attuale del campo
+std::uint64_t Field::getGeneration() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return generation_;
+}
+
+// Funzione che restituisce le aree modificate dopo la generazione indicata, dalla più recente alla più vecchia.
+// Restituisce false se il registro non risale più a quella generazione: in tal caso va considerato modificato l'intero campo.
+bool Field::getChangesSince(std::uint64_t generation, std::vector<ChangeRecord>& changes) const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    changes.clear();
+    if (generation < loggeneration_) {
+        return false;
+    }
+    for (auto record = changelog_.rbegin(); record != changelog_.rend() && record->generation > generation; ++record) {
+        changes.push_back(*record);
     }
+    return true;
+}
+
+// Funzione che restituisce la presenza di piante in un'area specifica del campo, copiata da una vista
+vector<vector<bool>> Field::getPlants(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    PlantView view {viewPlants(startlength, endlength, startwidth, endwidth)};
+    vector<vector<bool>> plants(view.rows(), vector<bool>(view.columns()));
+    view.forEach([&plants](int row, int column, bool value) { plants[row][column] = value; });
     return plants;
 }
 
-// Funzione che restituisce il tipo di suolo in un'area specifica del campo
+// Funzione che restituisce il tipo di suolo in un'area specifica del campo, copiato da una vista
 vector<vector<Soil::SoilType>> Field::getSoilTypes(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    SoilTypeView view {viewSoilTypes(startlength, endlength, startwidth, endwidth)};
+    vector<vector<Soil::SoilType>> soilTypes(view.rows(), vector<Soil::SoilType>(view.columns()));
+    view.forEach([&soilTypes](int row, int column, Soil::SoilType value) { soilTypes[row][column] = value; });
+    return soilTypes;
+}
+
+// Funzione privata che controlla i limiti dell'area di una vista e restituisce l'indice della sua prima cella
+std::size_t Field::viewOrigin(int startlength, int endlength, int startwidth, int endwidth) const
 {
     if (!CheckBoundaries(startlength, endlength, startwidth, endwidth)) {
             std::cerr << "Selected range is out of boundaries." << std::endl;
             exit(EXIT_FAILURE);
         }
+    return cellIndex(startlength, startwidth);
+}
 
-    vector<vector<Soil::SoilType>> soilTypes(endlength - startlength + 1, vector<Soil::SoilType>(endwidth - startwidth + 1));
-    auto row = field_.begin() + startlength;
-    for (int i = 0; row != field_.begin() + endlength + 1; ++row, ++i) {
-        transform((*row).begin() + startwidth, (*row).begin() + endwidth + 1, soilTypes[i].begin(), [](const Soil& soil) {
-            return soil.getSoilType();
-        });
-    }
-    return soilTypes;
+// Funzioni che restituiscono una vista su una proprietà in un'area specifica del campo, senza copiarne le celle.
+// La proiezione riceve la colonna della codifica in uso e un puntatore nullo per l'altra.
+Field::SoilTypeView Field::viewSoilTypes(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    SoilTypeProjection projection {compacted_ ? nullptr : columns_.soiltype, compacted_ ? compact_.soilcells.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
+}
+
+Field::PlantView Field::viewPlants(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    PlantProjection projection {compacted_ ? nullptr : columns_.plants, compacted_ ? compact_.soilcells.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
+}
+
+Field::PercentageView Field::viewSoilMoisture(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    PercentageProjection projection {compacted_ ? nullptr : columns_.soilmoisture, compacted_ ? compact_.soilmoisture.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
+}
+
+Field::TemperatureView Field::viewAirTemperature(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    TemperatureProjection projection {compacted_ ? nullptr : columns_.airtemperature, compacted_ ? compact_.airtemperature.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
+}
+
+Field::PercentageView Field::viewAirHumidity(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    PercentageProjection projection {compacted_ ? nullptr : columns_.airhumidity, compacted_ ? compact_.airhumidity.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
+}
+
+Field::TemperatureView Field::viewSoilTemperature(int startlength, int endlength, int startwidth, int endwidth) const
+{
+    TemperatureProjection projection {compacted_ ? nullptr : columns_.soiltemperature, compacted_ ? compact_.soiltemperature.data() : nullptr};
+    return makeView(projection, startlength, endlength, startwidth, endwidth);
 }
 
 // funzione per la restituzione del tipo di suolo in una specifica posizione del campo
 bool Field::getSoil(int x, int y, Soil& soil) const
 {
-    //controllo se la posizione è all'interno dei limiti della matrice
-    if (x < 0 || x >= length_ || y < 0 || y >= width_) {
+    if (!peekSoil(x, y, soil)) {
         return false;
     }
-    auto row = field_.begin() + x;
-    auto col = (*row).begin() + y;
-    soil = *col; // Assegna il tipo di suolo della posizione alla variabile soil
     // Stampa di debug per verificare i dati del suolo
     std::cout << "Debug: getSoil at (" << x << ", " << y << ") - hasPlants: " << (soil.getPlants() ? "Yes" : "No") << std::endl;
     return true;
     
 }
 
-// Funzione che stampa i tipi di suolo presenti nel campo
+// Come getSoil ma senza stampe di debug: usata dalle simulazioni con molti veicoli, dove le letture sono moltissime.
+// Le letture di una cella prendono il mutex del campo, così che possano avvenire durante una missione mentre un altro thread scrive
+// (ad esempio l'irrigazione periodica), anche quando la prima scrittura espande un campo compatto o copia un campo mappato.
+bool Field::peekSoil(int x, int y, Soil& soil) const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    //controllo se la posizione è all'interno dei limiti della matrice
+    if (x < 0 || x >= length_ || y < 0 || y >= width_) {
+        return false;
+    }
+    soil = cellAt(cellIndex(x, y)); // Assegna il tipo di suolo della posizione alla variabile soil
+    return true;
+}
+
+// Funzione per la sola lettura del tipo di suolo in una specifica posizione: non copia la cella e non stampa messaggi di debug.
+// Come peekSoil, prende il mutex del campo.
+bool Field::getSoilType(int x, int y, Soil::SoilType& soilType) const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (x < 0 || x >= length_ || y < 0 || y >= width_) {
+        return false;
+    }
+    soilType = static_cast<Soil::SoilType>(soilTypeAt(cellIndex(x, y)));
+    return true;
+}
+
+// Funzione che stampa i tipi di suolo presenti nel campo.
+// Un campo più grande di MaxPrintRows x MaxPrintColumns viene stampato come griglia del tipo di suolo prevalente.
 void Field::printSoilTypes() const
 {
-    for (auto row = field_.begin(); row != field_.end(); ++row) {
-        for (auto col = (*row).begin(); col != (*row).end(); ++col) {
-            std::cout << Soil::soilTypeToString((*col).getSoilType()) << " ";
+    if (length_ > MaxPrintRows || width_ > MaxPrintColumns) {
+        printSoilTypes(std::min(length_, MaxPrintRows), std::min(width_, MaxPrintColumns));
+        return;
+    }
+    for (int row = 0; row < length_; ++row) {
+        for (int col = 0; col < width_; ++col) {
+            std::cout << Soil::soilTypeToString(static_cast<Soil::SoilType>(soilTypeAt(cellIndex(row, col)))) << " ";
         }
         std::cout << std::endl;
     }
 }
 
-// Funzione che stampa la presenza di piante nel campo
+// Funzione che stampa la presenza di piante nel campo.
+// Un campo più grande di MaxPrintRows x MaxPrintColumns viene stampato come griglia della densità delle piante.
 void Field::printPlantPresence() const
 {
-    for (auto row = field_.begin(); row != field_.end(); ++row) {
-        for (auto col = (*row).begin(); col != (*row).end(); ++col) {
-            std::cout << ((*col).getPlants() ? "P " : "x ");
+    if (length_ > MaxPrintRows || width_ > MaxPrintColumns) {
+        printPlantPresence(std::min(length_, MaxPrintRows), std::min(width_, MaxPrintColumns));
+        return;
+    }
+    for (int row = 0; row < length_; ++row) {
+        for (int col = 0; col < width_; ++col) {
+            std::cout << (hasPlants(cellIndex(row, col)) ? "P " : "x ");
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Funzione privata che restituisce le viste sull'intero campo da cui la piramide legge le celle
+FieldPyramid::Sources Field::pyramidSources() const
+{
+    return {viewSoilTypes(0, length_ - 1, 0, width_ - 1), viewPlants(0, length_ - 1, 0, width_ - 1), viewSoilMoisture(0, length_ - 1, 0, width_ - 1),
+            viewAirTemperature(0, length_ - 1, 0, width_ - 1), viewAirHumidity(0, length_ - 1, 0, width_ - 1), viewSoilTemperature(0, length_ - 1, 0, width_ - 1)};
+}
+
+// Funzione che riassume un'area specifica del campo in una griglia di rows x columns valori aggregati, in ordine di riga, usando la piramide.
+// Il costo dipende dalle dimensioni della griglia e non da quelle dell'area; la piramide viene prima ricostruita se non è aggiornata.
+void Field::summarize(int startlength, int endlength, int startwidth, int endwidth, int rows, int columns, std::vector<Summary>& summaries) const
+{
+    if (!CheckBoundaries(startlength, endlength, startwidth, endwidth)) {
+            std::cerr << "Selected range is out of boundaries." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    if (rows <= 0 || columns <= 0) {
+        std::cerr << "Invalid summary size: rows and columns must be greater than 0." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    FieldPyramid::Sources sources {pyramidSources()};
+    if (pyramidstale_) {
+        pyramid_.rebuild(sources);
+        pyramidstale_ = false;
+    }
+    pyramid_.summarize(sources, startlength, endlength, startwidth, endwidth, rows, columns, summaries);
+}
+
+// Funzione che stampa il tipo di suolo prevalente del campo in una griglia di rows x columns elementi, con le prime due lettere del nome
+void Field::printSoilTypes(int rows, int columns) const
+{
+    std::vector<Summary> summaries;
+    summarize(0, length_ - 1, 0, width_ - 1, rows, columns, summaries);
+    std::cout << "Prevailing soil types, " << rows << " x " << columns << " (Cl = clay, Sa = sand, Lo = loam, Si = silt):" << std::endl;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            std::cout << Soil::soilTypeToString(summaries[static_cast<std::size_t>(row) * columns + col].soiltype).substr(0, 2) << " ";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Funzione che stampa la densità delle piante del campo in una griglia di rows x columns elementi:
+// "P" dove almeno metà delle celle ha piante, "p" dove ne ha qualcuna, "x" dove non ce ne sono
+void Field::printPlantPresence(int rows, int columns) const
+{
+    std::vector<Summary> summaries;
+    summarize(0, length_ - 1, 0, width_ - 1, rows, columns, summaries);
+    std::cout << "Plant density, " << rows << " x " << columns << " (P = at least half, p = some, x = none):" << std::endl;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            double density {summaries[static_cast<std::size_t>(row) * columns + col].plantdensity};
+            std::cout << (density >= 0.5 ? "P " : density > 0.0 ? "p " : "x ");
         }
         std::cout << std::endl;
     }
 }
 
+// Funzione che stampa una mappa di calore di una proprietà in un'area specifica del campo, in una griglia di rows x columns caratteri:
+// i valori medi vengono divisi in dieci fasce tra il minimo e il massimo della griglia, dalla più bassa (" ") alla più alta ("@")
+void Field::printHeatmap(HeatmapProperty property, int startlength, int endlength, int startwidth, int endwidth, int rows, int columns) const
+{
+    static const char shades[] = " .:-=+*#%@";
+    static const char* names[] = {"plant density", "soil moisture", "air temperature", "air humidity", "soil temperature"};
+    std::vector<Summary> summaries;
+    summarize(startlength, endlength, startwidth, endwidth, rows, columns, summaries);
+    double minimum {summaries[0].value(property)};
+    double maximum {minimum};
+    for (const Summary& summary : summaries) {
+        minimum = std::min(minimum, summary.value(property));
+        maximum = std::max(maximum, summary.value(property));
+    }
+    std::cout << "Heatmap of " << names[static_cast<int>(property)] << " in (" << startlength << "-" << endlength << ", " << startwidth << "-" << endwidth
+              << "), " << rows << " x " << columns << ": \" \" = " << minimum << ", \"@\" = " << maximum << std::endl;
+    for (int row = 0; row < rows; ++row) {
+        std::string line(columns, shades[0]);
+        for (int col = 0; col < columns; ++col) {
+            double value {summaries[static_cast<std::size_t>(row) * columns + col].value(property)};
+            int shade {maximum > minimum ? static_cast<int>((value - minimum) / (maximum - minimum) * 9.0 + 0.5) : 0};
+            line[col] = shades[shade];
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+// Funzione che restituisce la memoria occupata dalla piramide dei valori aggregati
+std::size_t Field::getPyramidBytes() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return pyramid_.getBytes();
+}
+
+// Funzione che salva il campo nel formato binario descritto in testa al file.
+// Restituisce false, con un messaggio di errore, se il file non può essere scritto.
+bool Field::saveSnapshot(const std::string& path) const
+{
+    if (!littleEndianHost()) {
+        std::cerr << "Field snapshots are only supported on little-endian machines." << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mtx_); // Il campo non deve cambiare durante il salvataggio
+    std::size_t cells {static_cast<std::size_t>(length_) * width_};
+    std::size_t sizes[6];
+    blockSizes(cells, sizes);
+    SnapshotHeader header {};
+    std::memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+    header.version = SnapshotVersion;
+    header.length = static_cast<std::uint32_t>(length_);
+    header.width = static_cast<std::uint32_t>(width_);
+    header.namelength = static_cast<std::uint32_t>(std::min(fieldname_.size(), SnapshotNameLength)); // I nomi più lunghi vengono troncati
+    std::memcpy(header.name, fieldname_.data(), header.namelength);
+    std::size_t offset {alignOffset(sizeof(SnapshotHeader))};
+    for (int block = 0; block < 6; ++block) {
+        header.offsets[block] = offset;
+        offset = alignOffset(offset + sizes[block]);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Unable to create field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    const void* blocks[6] = {columns_.soiltype, columns_.plants, columns_.soilmoisture, columns_.airtemperature, columns_.airhumidity, columns_.soiltemperature};
+    const char padding[SnapshotAlignment] = {};
+    std::vector<char> decoded; // Un campo compatto viene salvato nel formato normale, decodificando un blocco alla volta
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::size_t written {sizeof(header)};
+    for (int block = 0; block < 6; ++block) {
+        file.write(padding, header.offsets[block] - written); // Riempimento fino all'allineamento del blocco
+        if (compacted_) {
+            decoded.resize(sizes[block]);
+            decodeBlock(block, decoded.data());
+            blocks[block] = decoded.data();
+        }
+        file.write(static_cast<const char*>(blocks[block]), sizes[block]);
+        written = header.offsets[block] + sizes[block];
+    }
+    if (!file) {
+        std::cerr << "Error while writing field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Funzione privata che decodifica un blocco di colonne di un campo compatto nel formato del file binario
+void Field::decodeBlock(int block, char* destination) const
+{
+    std::size_t cells {static_cast<std::size_t>(length_) * width_};
+    if (block == 1) {
+        std::vector<std::uint64_t> plants((cells + 63) / 64, 0);
+        for (std::size_t index = 0; index < cells; ++index) {
+            if (compact_.soilcells[index] & 0x80) {
+                plants[index >> 6] |= std::uint64_t{1} << (index & 63);
+            }
+        }
+        std::memcpy(destination, plants.data(), plants.size() * sizeof(std::uint64_t));
+        return;
+    }
+    for (std::size_t index = 0; index < cells; ++index) {
+        switch (block) {
+            case 0: {
+                std::uint8_t soiltype {static_cast<std::uint8_t>(compact_.soilcells[index] & 0x7F)};
+                std::memcpy(destination + index, &soiltype, sizeof(soiltype));
+                break;
+            }
+            case 2: {
+                double value {decodePercentage(compact_.soilmoisture[index])};
+                std::memcpy(destination + index * sizeof(double), &value, sizeof(value));
+                break;
+            }
+            case 3: {
+                float value {decodeTemperature(compact_.airtemperature[index])};
+                std::memcpy(destination + index * sizeof(float), &value, sizeof(value));
+                break;
+            }
+            case 4: {
+                double value {decodePercentage(compact_.airhumidity[index])};
+                std::memcpy(destination + index * sizeof(double), &value, sizeof(value));
+                break;
+            }
+            default: {
+                float value {decodeTemperature(compact_.soiltemperature[index])};
+                std::memcpy(destination + index * sizeof(float), &value, sizeof(value));
+                break;
+            }
+        }
+    }
+}
+
+// Funzione che sostituisce il campo con quello salvato nel file indicato, mappandolo in memoria in sola lettura:
+// non c'è alcuna conversione e le pagine vengono caricate dal sistema operativo solo quando vengono lette.
+// Sui sistemi senza mmap il file viene letto interamente in memoria privata.
+// Restituisce false, con un messaggio di errore, se il file non esiste o non è un campo valido; in tal caso il campo non viene modificato.
+bool Field::openSnapshot(const std::string& path)
+{
+    if (!littleEndianHost()) {
+        std::cerr << "Field snapshots are only supported on little-endian machines." << std::endl;
+        return false;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    int descriptor {open(path.c_str(), O_RDONLY)};
+    if (descriptor < 0) {
+        std::cerr << "Unable to open field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(SnapshotHeader)) {
+        std::cerr << "Invalid field snapshot " << path << "." << std::endl;
+        close(descriptor);
+        return false;
+    }
+    std::size_t filesize {static_cast<std::size_t>(status.st_size)};
+    void* image {mmap(nullptr, filesize, PROT_READ, MAP_SHARED, descriptor, 0)};
+    close(descriptor); // La mappatura resta valida anche dopo la chiusura del file
+    if (image == MAP_FAILED) {
+        std::cerr << "Unable to map field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    const char* data {static_cast<const char*>(image)};
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Unable to open field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    std::size_t filesize {static_cast<std::size_t>(file.tellg())};
+    std::vector<std::uint64_t> buffer((filesize + 7) / 8); // Allineato a 8 byte come i blocchi di colonne
+    file.seekg(0);
+    if (filesize < sizeof(SnapshotHeader) || !file.read(reinterpret_cast<char*>(buffer.data()), filesize)) {
+        std::cerr << "Invalid field snapshot " << path << "." << std::endl;
+        return false;
+    }
+    const char* data {reinterpret_cast<const char*>(buffer.data())};
+#endif
+
+    // Controllo dell'intestazione: firma, versione, dimensioni e posizione dei blocchi all'interno del file.
+    // Il numero di celle deve essere tale che le dimensioni dei blocchi (fino a 8 byte per cella) non superino la capacità di size_t.
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    bool valid {std::memcmp(header.magic, SnapshotMagic, sizeof(header.magic)) == 0 && header.version == SnapshotVersion
+                && header.length > 0 && header.width > 0 && header.length <= INT32_MAX && header.width <= INT32_MAX
+                && header.namelength <= SnapshotNameLength
+                && header.width <= std::numeric_limits<std::size_t>::max() / sizeof(double) / header.length};
+    std::size_t cells {valid ? static_cast<std::size_t>(header.length) * header.width : 0};
+    std::size_t sizes[6];
+    blockSizes(cells, sizes);
+    for (int block = 0; valid && block < 6; ++block) {
+        valid = header.offsets[block] % SnapshotAlignment == 0 && header.offsets[block] >= sizeof(SnapshotHeader)
+                && header.offsets[block] <= filesize && sizes[block] <= filesize - header.offsets[block];
+    }
+    // I tipi di suolo vengono controllati una sola volta all'apertura: un valore fuori dall'enumerazione farebbe leggere fuori dalle tabelle
+    // indicizzate per tipo di suolo (soglie del control center, diffusività, aggregati della piramide)
+    if (valid) {
+        const std::uint8_t* soiltypes {reinterpret_cast<const std::uint8_t*>(data + header.offsets[0])};
+        valid = std::all_of(soiltypes, soiltypes + cells, [](std::uint8_t soiltype) { return soiltype < SoilTypeCount; });
+    }
+    if (!valid) {
+        std::cerr << "Invalid field snapshot " << path << "." << std::endl;
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(image, filesize);
+#endif
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    compacted_ = false;
+    compact_ = CompactColumns(); // Le colonne compatte del campo precedente non servono più
+    fieldname_.assign(header.name, header.namelength);
+    length_ = static_cast<int>(header.length);
+    width_ = static_cast<int>(header.width);
+#if defined(__unix__) || defined(__APPLE__)
+    unmap(); // L'eventuale immagine aperta in precedenza non è più necessaria
+    mapping_ = image;
+    mappingsize_ = filesize;
+    columns_ = {reinterpret_cast<const std::uint8_t*>(data + header.offsets[0]),
+                reinterpret_cast<const std::uint64_t*>(data + header.offsets[1]),
+                reinterpret_cast<const double*>(data + header.offsets[2]),
+                reinterpret_cast<const float*>(data + header.offsets[3]),
+                reinterpret_cast<const double*>(data + header.offsets[4]),
+                reinterpret_cast<const float*>(data + header.offsets[5])};
+    mapped_ = true;
+    // Le colonne private non servono più finché il campo non viene modificato
+    vector<std::uint8_t>().swap(soiltypes_);
+    vector<std::uint64_t>().swap(plants_);
+    vector<double>().swap(soilmoisture_);
+    vector<float>().swap(airtemperature_);
+    vector<double>().swap(airhumidity_);
+    vector<float>().swap(soiltemperature_);
+#else
+    soiltypes_.assign(reinterpret_cast<const std::uint8_t*>(data + header.offsets[0]), reinterpret_cast<const std::uint8_t*>(data + header.offsets[0]) + cells);
+    plants_.assign(reinterpret_cast<const std::uint64_t*>(data + header.offsets[1]), reinterpret_cast<const std::uint64_t*>(data + header.offsets[1]) + (cells + 63) / 64);
+    soilmoisture_.assign(reinterpret_cast<const double*>(data + header.offsets[2]), reinterpret_cast<const double*>(data + header.offsets[2]) + cells);
+    airtemperature_.assign(reinterpret_cast<const float*>(data + header.offsets[3]), reinterpret_cast<const float*>(data + header.offsets[3]) + cells);
+    airhumidity_.assign(reinterpret_cast<const double*>(data + header.offsets[4]), reinterpret_cast<const double*>(data + header.offsets[4]) + cells);
+    soiltemperature_.assign(reinterpret_cast<const float*>(data + header.offsets[5]), reinterpret_cast<const float*>(data + header.offsets[5]) + cells);
+    bindColumns();
+#endif
+    // Tutto il campo è cambiato: chi lo ha rilevato prima dell'apertura deve rilevarlo di nuovo per intero
+    ++generation_;
+    changelog_.clear();
+    loggeneration_ = generation_;
+    pyramidstale_ = true; // Le pagine dell'immagine vengono lette solo quando serve, anche per la piramide
+    return true;
+}
+
 // Overloading dell'operatore di output per la stampa dei dati di base del campo
 std::ostream& operator<<(std::ostream& os, const Field& field)
 {
@@ -3,6 +3,29 @@
 // Ciò per simulare l'idea di "costruire da zero" il proprio campo: in questo modo all'inizio della simulazione il campo sarà riempito con lo stesso tipo di suolo e le stesse condizioni atmosferiche.
 // Per mettere condizioni diverse in aree diverse del campo, la classe ha un metodo che prende come input una sotto-parte del campo e un oggetto Soil, e imposta l'oggetto Soil nella sotto-parte.
 // Sono presenti diversi metodi la cui funzione è sintetizzata nel file "field.cpp".
+// Le proprietà delle celle sono memorizzate per colonne (una per proprietà, in ordine di riga), con la presenza di piante in una bitmap:
+// le letture di una sola proprietà su un'area scorrono memoria contigua, e il campo può essere salvato in un file binario con lo stesso formato
+// e riaperto mappandolo in memoria, senza alcuna conversione (la descrizione del formato è in "field.cpp").
+// Un campo aperto da file è in sola lettura e più processi possono condividere la stessa immagine; alla prima scrittura le colonne vengono copiate in memoria privata.
+// Un campo grande e letto molto più spesso di quanto venga scritto può essere compresso con compact: tipo di suolo e piante in un byte,
+// umidità e temperature in valori a virgola fissa da 16 bit, 9 byte per cella invece di 25 (il 36% della memoria delle colonne normali).
+// Le letture decodificano i valori con un errore massimo di PercentagePrecision punti percentuali per le umidità e di TemperaturePrecision gradi
+// per le temperature (limitate tra -327.68 e 327.67 gradi): mezzo passo della codifica più l'arrotondamento del valore decodificato;
+// tipo di suolo e piante restano esatti. Come per un campo mappato, alla prima scrittura le colonne vengono espanse in memoria privata
+// e le colonne compatte vengono liberate: come compact, la prima scrittura su un campo compatto va fatta quando nessun altro thread sta leggendo il campo.
+// Le letture di una proprietà su un'area possono passare da una vista (viewSoilTypes, viewPlants, viewSoilMoisture, ...), che non copia le celle
+// e decodifica i valori in entrambe le codifiche; getSoilTypes e getPlants ne copiano il contenuto in matrici, per chi ha bisogno di una copia.
+// Una vista resta valida finché le colonne restano al loro posto: la invalidano la prima scrittura su un campo mappato o compatto, compact,
+// changeDimensions, openSnapshot, la generazione di un nuovo campo e, per l'umidità del suolo, ogni passo del motore di dinamica.
+// Le viste non prendono il mutex del campo: mentre un altro thread scrive sul campo, le letture vanno fatte cella per cella
+// con getSoil, peekSoil e getSoilType, che lo prendono.
+// Il campo mantiene anche una piramide di valori aggregati a più risoluzioni (vedi "fieldpyramid.h"), aggiornata a ogni scrittura solo nelle aree modificate:
+// summarize riassume un'area in una griglia di dimensioni date, e le stampe a griglia (printSoilTypes e printPlantPresence con righe e colonne, printHeatmap)
+// costano in proporzione alla griglia stampata invece che al campo. Le scritture sull'intero campo, l'apertura di un file e le altre operazioni che
+// rimpiazzano tutte le colonne rimandano la ricostruzione della piramide alla prima sintesi, così che una serie di passi della dinamica non la ricalcoli ogni volta.
+// Ogni scrittura sul campo incrementa un contatore di generazione e registra il rettangolo modificato in un registro delle modifiche di dimensione limitata
+// (una scrittura a blocchi di più rettangoli, come un passo di una serie meteo o di irrigazione, produce una sola generazione con un rettangolo per area):
+// chi ha già rilevato il campo a una certa generazione può chiedere solo le aree modificate da allora, invece di riesaminare tutto il campo.
 // Allo stato attuale del progetto, il campo è statico e hardcoded, ma l'idea è di poter avere un campo con condizioni diverse in aree diverse con apposite future implementazioni. 
 
 #ifndef FIELD_H
@@ -12,39 +35,168 @@ using std::vector;
 #include <string>
 using std::string;
 #include "soil.h"
+#include "fieldview.h"
+#include "fieldpyramid.h"
 #include <iostream>
 using std::ostream;
 #include <functional>
 using std::function;
 #include <mutex>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
 
 class Field {
     public:
+        // Rettangolo di celle (estremi inclusi) modificato da una scrittura, con la generazione del campo prodotta dalla scrittura
+        struct ChangeRecord {
+            std::uint64_t generation;
+            int startlength;
+            int endlength;
+            int startwidth;
+            int endwidth;
+        };
+        // Nuove condizioni atmosferiche per un rettangolo di celle (estremi inclusi), ad esempio un passo di una serie meteo
+        struct RegionUpdate {
+            int startlength;
+            int endlength;
+            int startwidth;
+            int endwidth;
+            float airtemperature;
+            double airhumidity;
+        };
+        // Comando di irrigazione per un rettangolo di celle (estremi inclusi): l'umidità del suolo viene portata almeno al valore indicato
+        struct IrrigationUpdate {
+            int startlength;
+            int endlength;
+            int startwidth;
+            int endwidth;
+            double soilmoisture;
+        };
+        // Viste non proprietarie su un'area del campo, una per proprietà (vedi "fieldview.h")
+        using SoilTypeView = FieldView<SoilTypeProjection>;
+        using PlantView = FieldView<PlantProjection>;
+        using PercentageView = FieldView<PercentageProjection>;
+        using TemperatureView = FieldView<TemperatureProjection>;
+        // Valori aggregati di un'area e proprietà mostrabili in una mappa di calore
+        using Summary = FieldPyramid::Summary;
+        using HeatmapProperty = FieldPyramid::Property;
         Field();
         Field(std::string fieldname, int length, int width);
+        ~Field();
+        Field(const Field&) = delete;
+        Field& operator=(const Field&) = delete;
         void setSoil(const Soil& soil, int startlength, int endlength, int startwidth, int endwidth);
         void modifySoilProperty(int startlength, int endlength, int startwidth, int endwidth, std::function<void(Soil&)> modifyFunc);
+        void applyRegionUpdates(const std::vector<RegionUpdate>& updates);
+        void applyIrrigation(const std::vector<IrrigationUpdate>& updates);
         void changeFieldname(std::string fieldname);
         void changeDimensions(int lengthchange, int widthchange);
         std::string getFieldname() const {return fieldname_;}
         int getLength() const {return length_;}
         int getWidth() const {return width_;}
         bool getSoil(int x, int y, Soil& soil) const;
+        bool peekSoil(int x, int y, Soil& soil) const;
+        bool getSoilType(int x, int y, Soil::SoilType& soilType) const;
         vector<vector<Soil::SoilType>> getSoilTypes(int startlength, int endlength, int startwidth, int endwidth) const;
         vector<vector<bool>> getPlants(int startlength, int endlength, int startwidth, int endwidth) const;
+        SoilTypeView viewSoilTypes(int startlength, int endlength, int startwidth, int endwidth) const;
+        PlantView viewPlants(int startlength, int endlength, int startwidth, int endwidth) const;
+        PercentageView viewSoilMoisture(int startlength, int endlength, int startwidth, int endwidth) const;
+        TemperatureView viewAirTemperature(int startlength, int endlength, int startwidth, int endwidth) const;
+        PercentageView viewAirHumidity(int startlength, int endlength, int startwidth, int endwidth) const;
+        TemperatureView viewSoilTemperature(int startlength, int endlength, int startwidth, int endwidth) const;
         void printSoilTypes() const;
         void printPlantPresence() const;
+        void summarize(int startlength, int endlength, int startwidth, int endwidth, int rows, int columns, std::vector<Summary>& summaries) const;
+        void printSoilTypes(int rows, int columns) const;
+        void printPlantPresence(int rows, int columns) const;
+        void printHeatmap(HeatmapProperty property, int startlength, int endlength, int startwidth, int endwidth, int rows, int columns) const;
+        std::size_t getPyramidBytes() const;
+        std::uint64_t getGeneration() const;
+        bool getChangesSince(std::uint64_t generation, std::vector<ChangeRecord>& changes) const;
+        bool saveSnapshot(const std::string& path) const;
+        bool openSnapshot(const std::string& path);
+        bool isMapped() const { return mapped_; }
+        void compact();
+        bool isCompact() const { return compacted_; }
+        std::size_t getColumnBytes() const;
+        // Errori massimi della codifica compatta: mezzo passo (un millesimo di punto per le umidità, mezzo centesimo di grado per le temperature)
+        // più l'arrotondamento del valore decodificato, trascurabile in double per le umidità e al più di 1.53e-5 gradi in float sotto i 512 gradi
+        static constexpr double PercentagePrecision = 0.001 + 1e-12;
+        static constexpr double TemperaturePrecision = 0.005 + 1.6e-5;
 
 
     private:
+        friend class FieldDynamics; // Il motore di dinamica del campo aggiorna direttamente le colonne, con un'unica scrittura per passo
+        friend class FieldGenerator; // Il generatore di campi per le prove di carico scrive direttamente le colonne, da più thread
+        // Puntatori di lettura alle colonne: indicano i vettori di proprietà del campo oppure i blocchi dell'immagine mappata in memoria
+        struct ColumnView {
+            const std::uint8_t* soiltype;
+            const std::uint64_t* plants;
+            const double* soilmoisture;
+            const float* airtemperature;
+            const double* airhumidity;
+            const float* soiltemperature;
+        };
         std::string fieldname_;
         int length_;
         int width_;
-        std::vector<std::vector<Soil>> field_;
+        // Colonne del campo, indicizzate da x * width + y
+        std::vector<std::uint8_t> soiltypes_;
+        std::vector<std::uint64_t> plants_; // Un bit per cella
+        std::vector<double> soilmoisture_;
+        std::vector<float> airtemperature_;
+        std::vector<double> airhumidity_;
+        std::vector<float> soiltemperature_;
+        ColumnView columns_;
+        // Colonne della codifica compatta, usate al posto di quelle normali quando compacted_ è vero
+        struct CompactColumns {
+            std::vector<std::uint8_t> soilcells; // Tipo di suolo nei bit bassi, presenza di piante nel bit più alto
+            std::vector<std::uint16_t> soilmoisture; // Umidità in cinquecentesimi di punto percentuale
+            std::vector<std::int16_t> airtemperature; // Temperature in centesimi di grado
+            std::vector<std::uint16_t> airhumidity;
+            std::vector<std::int16_t> soiltemperature;
+        };
+        CompactColumns compact_; // Vuota se il campo non è compatto: viene liberata all'espansione
+        bool compacted_; // Vero se le letture devono usare le colonne compatte
+        void* mapping_; // Immagine del file mappata in memoria, mantenuta fino alla distruzione del campo o all'apertura di un altro file
+        std::size_t mappingsize_;
+        bool mapped_; // Vero se le colonne puntano ancora all'immagine mappata
+        std::size_t cellIndex(int x, int y) const { return static_cast<std::size_t>(x) * width_ + y; }
+        bool hasPlants(std::size_t index) const {
+            return compacted_ ? (compact_.soilcells[index] >> 7) != 0 : ((columns_.plants[index >> 6] >> (index & 63)) & 1u) != 0;
+        }
+        std::uint8_t soilTypeAt(std::size_t index) const { return compacted_ ? compact_.soilcells[index] & 0x7F : columns_.soiltype[index]; }
+        Soil cellAt(std::size_t index) const;
+        void storeCell(std::size_t index, const Soil& soil);
+        void allocateColumns(int length, int width);
+        void bindColumns();
+        void materialize();
+        void expand();
+        void decodeBlock(int block, char* destination) const;
+        void unmap();
+        std::size_t viewOrigin(int startlength, int endlength, int startwidth, int endwidth) const;
+        template <typename Projection>
+        FieldView<Projection> makeView(Projection projection, int startlength, int endlength, int startwidth, int endwidth) const {
+            return FieldView<Projection>(projection, viewOrigin(startlength, endlength, startwidth, endwidth), endlength - startlength + 1,
+                                         endwidth - startwidth + 1, width_, 1);
+        }
         bool CheckBoundaries(int startlength, int endlength, int startwidth, int endwidth) const;
         void calculateNewDimensions(int lengthChange, int widthChange, int& newLength, int& newWidth) const;
         void resizeField(int newlength, int newwidth);
-        std::mutex mtx_;
+        void recordChange(int startlength, int endlength, int startwidth, int endwidth);
+        void logChange(int startlength, int endlength, int startwidth, int endwidth);
+        static constexpr std::size_t MaxChangeRecords = 1024; // Oltre questo numero le modifiche più vecchie vengono dimenticate
+        static constexpr int MaxPrintRows = 50; // Oltre queste dimensioni le stampe cella per cella diventano stampe a griglia
+        static constexpr int MaxPrintColumns = 80;
+        std::uint64_t generation_;
+        std::uint64_t loggeneration_; // Il registro è completo per le richieste a partire da questa generazione
+        std::deque<ChangeRecord> changelog_;
+        mutable FieldPyramid pyramid_; // Ricostruita, se necessario, alla prima sintesi: per questo modificabile anche dalle funzioni const
+        mutable bool pyramidstale_; // Vero se la piramide non corrisponde più alle colonne e va ricostruita per intero
+        FieldPyramid::Sources pyramidSources() const;
+        mutable std::mutex mtx_;
 
 };
 std::ostream& operator<<(std::ostream& os, const Field& field);
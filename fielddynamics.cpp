@@ -0,0 +1,207 @@
+#include "fielddynamics.h"
+#include "soil.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// Costruttore: il gruppo di thread viene creato una volta sola e riusato ad ogni passo
+FieldDynamics::FieldDynamics(Field& field, int threads)
+    : field_{field},
+    parameters_{defaultParameters()},
+    steps_{0},
+    substeps_{0},
+    simulatedhours_{0.0},
+    dt_{0.0},
+    thermalrelaxation_{},
+    tilesperrow_{0},
+    tiles_{0},
+    generation_{0},
+    pendingworkers_{0},
+    stopping_{false}
+    {
+        for (int worker = 1; worker < threads; ++worker) {
+            workers_.emplace_back(&FieldDynamics::workerLoop, this, worker);
+        }
+    }
+
+// Distruttore: i thread del gruppo vengono fermati e attesi
+FieldDynamics::~FieldDynamics() {
+    {
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        stopping_ = true;
+    }
+    cvwork_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Coefficienti di default: la sabbia drena e si scalda in fretta, l'argilla trattiene l'acqua e ha più inerzia termica
+FieldDynamics::Parameters FieldDynamics::defaultParameters() {
+    Parameters parameters;
+    parameters.diffusivity = {0.02, 0.12, 0.06, 0.04};
+    parameters.evaporationrate = 0.4;
+    parameters.thermaltimeconstant = {8.0, 2.0, 4.0, 6.0};
+    return parameters;
+}
+
+// Funzione per cambiare i coefficienti del modello
+void FieldDynamics::setParameters(const Parameters& parameters) {
+    for (std::size_t type = 0; type < 4; ++type) {
+        if (parameters.diffusivity[type] < 0 || parameters.thermaltimeconstant[type] <= 0) {
+            std::cerr << "Invalid field dynamics parameters." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (parameters.evaporationrate < 0) {
+        std::cerr << "Invalid field dynamics parameters." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    parameters_ = parameters;
+}
+
+// Funzione che fa avanzare il campo di un passo della durata indicata, in ore.
+// Se il passo è troppo lungo per una diffusione stabile viene diviso in sotto-passi uguali; il campo viene bloccato per tutta la durata del passo.
+void FieldDynamics::step(double hours) {
+    if (hours <= 0) {
+        std::cerr << "Invalid step duration: it must be greater than 0." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::lock_guard<std::mutex> lock(field_.mtx_);
+    field_.materialize(); // Un campo aperto da file viene copiato in memoria privata prima della prima scrittura
+    int length {field_.length_};
+    int width {field_.width_};
+    std::size_t cells {static_cast<std::size_t>(length) * width};
+    if (nextmoisture_.size() != cells) {
+        nextmoisture_.assign(cells, 0.0);
+    }
+    tilesperrow_ = (width + TileColumns - 1) / TileColumns;
+    tiles_ = static_cast<std::size_t>((length + TileRows - 1) / TileRows) * tilesperrow_;
+
+    double maxdiffusivity {*std::max_element(parameters_.diffusivity.begin(), parameters_.diffusivity.end())};
+    int substeps {std::max(1, static_cast<int>(std::ceil(hours * maxdiffusivity / MaxExchange)))};
+    dt_ = hours / substeps;
+    for (std::size_t type = 0; type < 4; ++type) {
+        thermalrelaxation_[type] = 1.0 - std::exp(-dt_ / parameters_.thermaltimeconstant[type]);
+    }
+    for (int substep = 0; substep < substeps; ++substep) {
+        parallelFor([this](std::size_t begin, std::size_t end) {
+            for (std::size_t tile = begin; tile < end; ++tile) {
+                updateTile(tile);
+            }
+        });
+        // La nuova colonna di umidità prende il posto di quella vecchia, che verrà riscritta al sotto-passo successivo
+        field_.soilmoisture_.swap(nextmoisture_);
+        field_.bindColumns();
+    }
+    field_.recordChange(0, length - 1, 0, width - 1);
+    ++steps_;
+    substeps_ += substeps;
+    simulatedhours_ += hours;
+}
+
+// Funzione che esegue più passi della stessa durata
+void FieldDynamics::run(std::size_t steps, double hours) {
+    for (std::size_t executed = 0; executed < steps; ++executed) {
+        step(hours);
+    }
+}
+
+// Funzione privata che aggiorna le celle di un blocco: diffusione e evaporazione dell'umidità, poi rilassamento della temperatura del suolo
+// verso l'equilibrio calcolato con la nuova umidità. Le celle ai bordi del campo non scambiano umidità verso l'esterno.
+void FieldDynamics::updateTile(std::size_t tile) {
+    int width {field_.width_};
+    int length {field_.length_};
+    int firstrow {static_cast<int>(tile / tilesperrow_) * TileRows};
+    int firstcolumn {static_cast<int>(tile % tilesperrow_) * TileColumns};
+    int lastrow {std::min(length, firstrow + TileRows)};
+    int lastcolumn {std::min(width, firstcolumn + TileColumns)};
+    const double* moisture {field_.soilmoisture_.data()};
+    const std::uint8_t* soiltype {field_.soiltypes_.data()};
+    const float* airtemperature {field_.airtemperature_.data()};
+    const double* airhumidity {field_.airhumidity_.data()};
+    float* soiltemperature {field_.soiltemperature_.data()};
+    double* next {nextmoisture_.data()};
+    const std::array<double, 4>& diffusivity = parameters_.diffusivity;
+    double evaporation {parameters_.evaporationrate * dt_};
+
+    for (int x = firstrow; x < lastrow; ++x) {
+        std::size_t row {static_cast<std::size_t>(x) * width};
+        for (int y = firstcolumn; y < lastcolumn; ++y) {
+            std::size_t index {row + y};
+            double current {moisture[index]};
+            double own {diffusivity[soiltype[index]]};
+            // Lo scambio con ogni vicino usa la media dei coefficienti delle due celle, così che l'acqua ceduta da una sia ricevuta dall'altra
+            double flux {0.0};
+            if (x > 0) {
+                flux += 0.5 * (own + diffusivity[soiltype[index - width]]) * (moisture[index - width] - current);
+            }
+            if (x + 1 < length) {
+                flux += 0.5 * (own + diffusivity[soiltype[index + width]]) * (moisture[index + width] - current);
+            }
+            if (y > 0) {
+                flux += 0.5 * (own + diffusivity[soiltype[index - 1]]) * (moisture[index - 1] - current);
+            }
+            if (y + 1 < width) {
+                flux += 0.5 * (own + diffusivity[soiltype[index + 1]]) * (moisture[index + 1] - current);
+            }
+            double air {airtemperature[index]};
+            double humidity {airhumidity[index]};
+            double evaporated {evaporation * std::max(0.0, 1.0 + 0.04 * (air - 20.0)) * (1.0 - humidity / 100.0) * (current / 100.0)};
+            double updated {std::min(100.0, std::max(0.0, current + dt_ * flux - evaporated))};
+            next[index] = updated;
+            Soil::SoilType type {static_cast<Soil::SoilType>(soiltype[index])};
+            float equilibrium {Soil::soilTemperature(type, updated, static_cast<float>(air), humidity)};
+            soiltemperature[index] += static_cast<float>((equilibrium - soiltemperature[index]) * thermalrelaxation_[soiltype[index]]);
+        }
+    }
+}
+
+// Funzione privata che divide i tile tra il thread chiamante e i thread del gruppo e attende che tutti abbiano finito
+void FieldDynamics::parallelFor(const std::function<void(std::size_t, std::size_t)>& job) {
+    if (workers_.empty()) {
+        job(0, tiles_);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        job_ = job;
+        pendingworkers_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    cvwork_.notify_all();
+    std::pair<std::size_t, std::size_t> range = chunk(0);
+    job(range.first, range.second);
+    std::unique_lock<std::mutex> lock(poolmutex_);
+    cvdone_.wait(lock, [this] { return pendingworkers_ == 0; });
+    job_ = nullptr;
+}
+
+// Ciclo di un thread del gruppo: attende un nuovo lavoro, esegue il proprio blocco di tile e segnala il termine
+void FieldDynamics::workerLoop(int worker) {
+    std::size_t seen {0};
+    while (true) {
+        std::function<void(std::size_t, std::size_t)> job;
+        {
+            std::unique_lock<std::mutex> lock(poolmutex_);
+            cvwork_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+        }
+        std::pair<std::size_t, std::size_t> range = chunk(worker);
+        job(range.first, range.second);
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        if (--pendingworkers_ == 0) {
+            cvdone_.notify_one();
+        }
+    }
+}
+
+// Funzione privata che restituisce il blocco di tile assegnato a un thread
+std::pair<std::size_t, std::size_t> FieldDynamics::chunk(int worker) const {
+    std::size_t threads {workers_.size() + 1};
+    return {tiles_ * worker / threads, tiles_ * (worker + 1) / threads};
+}
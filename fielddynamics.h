@@ -0,0 +1,75 @@
+// La classe "FieldDynamics" fa evolvere nel tempo le condizioni del campo, che altrimenti cambierebbero solo con chiamate esplicite ai setter.
+// Ad ogni passo di simulazione vengono aggiornati:
+// 1) l'umidità del suolo, che si diffonde tra celle vicine con una velocità che dipende dal tipo di suolo (più veloce nella sabbia, più lenta nell'argilla);
+// 2) l'evaporazione, più intensa con aria calda e secca e con suolo bagnato;
+// 3) la temperatura del suolo, che tende a quella di equilibrio calcolata da Soil con un ritardo dovuto all'inerzia termica del tipo di suolo.
+// I tre aggiornamenti sono fusi in un unico stencil a cinque punti che lavora direttamente sulle colonne del campo: la griglia è divisa in blocchi
+// (tile) abbastanza piccoli da restare in cache, e i blocchi sono divisi tra un gruppo di thread fissi. Ogni cella legge l'umidità dei vicini
+// dalla colonna del passo precedente e scrive in una colonna separata, quindi il risultato non dipende dal numero di thread.
+// Un passo di simulazione è una sola scrittura sul campo: la generazione del campo aumenta di uno e l'intero campo risulta modificato.
+// La descrizione delle funzioni è presente nel file "fielddynamics.cpp".
+
+#ifndef FIELDDYNAMICS_H
+#define FIELDDYNAMICS_H
+#include "field.h"
+#include <vector>
+#include <array>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+#include <cstddef>
+
+class FieldDynamics {
+    public:
+        // Coefficienti del modello, per tipo di suolo nell'ordine dell'enumerazione SoilType (clay, sand, loam, silt)
+        struct Parameters {
+            std::array<double, 4> diffusivity; // Frazione della differenza di umidità scambiata con ogni vicino in un'ora
+            double evaporationrate; // Punti percentuali di umidità evaporati in un'ora da suolo saturo a 20 gradi con aria secca
+            std::array<double, 4> thermaltimeconstant; // Ore in cui la temperatura del suolo recupera circa due terzi della distanza dall'equilibrio
+        };
+        FieldDynamics(Field& field, int threads);
+        ~FieldDynamics();
+        FieldDynamics(const FieldDynamics&) = delete;
+        FieldDynamics& operator=(const FieldDynamics&) = delete;
+        void setParameters(const Parameters& parameters);
+        const Parameters& getParameters() const { return parameters_; }
+        static Parameters defaultParameters();
+        void step(double hours);
+        void run(std::size_t steps, double hours);
+        std::size_t getSteps() const { return steps_; }
+        std::size_t getSubsteps() const { return substeps_; }
+        double getSimulatedHours() const { return simulatedhours_; }
+
+    private:
+        static constexpr int TileRows = 32; // Un blocco di 32 x 256 celle: le righe di umidità lette e scritte restano in cache
+        static constexpr int TileColumns = 256;
+        static constexpr double MaxExchange = 0.2; // Massimo scambio per vicino in un sotto-passo, per la stabilità della diffusione
+        Field& field_;
+        Parameters parameters_;
+        std::vector<double> nextmoisture_; // Colonna di umidità del sotto-passo in corso, scambiata con quella del campo alla fine
+        std::size_t steps_;
+        std::size_t substeps_;
+        double simulatedhours_;
+        // Parametri del sotto-passo in corso, letti dai thread del gruppo
+        double dt_;
+        std::array<double, 4> thermalrelaxation_;
+        int tilesperrow_;
+        std::size_t tiles_;
+        void updateTile(std::size_t tile);
+        // Gruppo di thread fissi, come nel motore a tick: ad ogni sotto-passo ogni thread aggiorna un blocco contiguo di tile
+        std::vector<std::thread> workers_;
+        std::mutex poolmutex_;
+        std::condition_variable cvwork_;
+        std::condition_variable cvdone_;
+        std::function<void(std::size_t, std::size_t)> job_;
+        std::size_t generation_;
+        int pendingworkers_;
+        bool stopping_;
+        void parallelFor(const std::function<void(std::size_t, std::size_t)>& job);
+        void workerLoop(int worker);
+        std::pair<std::size_t, std::size_t> chunk(int worker) const;
+};
+
+#endif
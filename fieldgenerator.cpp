@@ -0,0 +1,177 @@
+#include "fieldgenerator.h"
+#include "soil.h"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Funzione di mescolamento splitmix64: trasforma un intero in un valore pseudocasuale ben distribuito
+    std::uint64_t mix(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    // Ridimensiona una colonna senza copiarne il contenuto precedente, che verrà comunque riscritto
+    template <typename T>
+    void resetColumn(std::vector<T>& column, std::size_t size)
+    {
+        if (column.size() != size) {
+            std::vector<T>().swap(column);
+            column.resize(size);
+        }
+    }
+}
+
+// Costruttore: i parametri restano gli stessi per tutti i campi generati, quindi lo stesso generatore produce sempre lo stesso campo
+FieldGenerator::FieldGenerator(const Parameters& parameters, int threads)
+    : parameters_{parameters},
+    threads_{std::max(1, threads)},
+    plantcells_{0},
+    lastseconds_{0.0}
+    {
+        if (parameters_.patchsize <= 0 || parameters_.rowspacing <= 0 || parameters_.plantcoverage < 0 || parameters_.plantcoverage > 1
+            || parameters_.moisturemin < 0 || parameters_.moisturemax > 100 || parameters_.airhumiditymin < 0 || parameters_.airhumiditymax > 100) {
+            std::cerr << "Invalid field generator parameters." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+// Parametri di default: macchie di suolo di una cinquantina di celle, un filare ogni tre righe coltivato per circa metà della sua lunghezza
+FieldGenerator::Parameters FieldGenerator::defaultParameters(std::uint64_t seed) {
+    Parameters parameters;
+    parameters.seed = seed;
+    parameters.patchsize = 48.0;
+    parameters.rowspacing = 3;
+    parameters.plantcoverage = 0.5;
+    parameters.moisturemax = 70.0;
+    parameters.moisturemin = 15.0;
+    parameters.airtemperaturemin = 12.0f;
+    parameters.airtemperaturemax = 32.0f;
+    parameters.airhumiditymax = 80.0;
+    parameters.airhumiditymin = 35.0;
+    return parameters;
+}
+
+// Funzione che sostituisce il contenuto del campo con un campo generato di dimensioni length x width.
+// Il campo viene bloccato per tutta la generazione e risulta modificato per intero con una sola nuova generazione.
+void FieldGenerator::generate(Field& field, int length, int width) {
+    if (length <= 0 || width <= 0) {
+        std::cerr << "Invalid dimensions for the generated field." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(field.mtx_);
+    std::size_t cells {static_cast<std::size_t>(length) * width};
+    resetColumn(field.soiltypes_, cells);
+    resetColumn(field.plants_, (cells + 63) / 64);
+    resetColumn(field.soilmoisture_, cells);
+    resetColumn(field.airtemperature_, cells);
+    resetColumn(field.airhumidity_, cells);
+    resetColumn(field.soiltemperature_, cells);
+    field.compact_ = Field::CompactColumns(); // Un campo compatto viene sostituito per intero
+    field.length_ = length;
+    field.width_ = width;
+
+    // Ogni thread riceve un intervallo di parole della bitmap delle piante e le celle corrispondenti
+    std::size_t words {field.plants_.size()};
+    std::vector<std::size_t> plantcells(threads_, 0);
+    std::vector<std::thread> workers;
+    for (int worker = 1; worker < threads_; ++worker) {
+        workers.emplace_back([this, &field, &plantcells, words, cells, worker] {
+            plantcells[worker] = fillRange(field, std::min(cells, words * worker / threads_ * 64), std::min(cells, words * (worker + 1) / threads_ * 64));
+        });
+    }
+    plantcells[0] = fillRange(field, 0, std::min(cells, words / threads_ * 64));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    field.bindColumns();
+    field.recordChange(0, length - 1, 0, width - 1);
+    plantcells_ = 0;
+    for (std::size_t count : plantcells) {
+        plantcells_ += count;
+    }
+    lastseconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Funzione privata che riempie le celle di indice compreso tra begin (multiplo di 64) ed end, e restituisce quante hanno piante.
+// Le parole della bitmap vengono composte in un registro e scritte intere.
+std::size_t FieldGenerator::fillRange(Field& field, std::size_t begin, std::size_t end) const {
+    int length {field.length_};
+    int width {field.width_};
+    double lengthscale {length > 1 ? 1.0 / (length - 1) : 0.0};
+    double widthscale {width > 1 ? 1.0 / (width - 1) : 0.0};
+    double patch {1.0 / parameters_.patchsize};
+    int x {static_cast<int>(begin / width)};
+    int y {static_cast<int>(begin % width)};
+    std::uint64_t word {0};
+    std::size_t plantcells {0};
+    for (std::size_t index = begin; index < end; ++index) {
+        double px {x * patch};
+        double py {y * patch};
+        // Macchie di suolo: i valori del rumore frattale, concentrati attorno a 0.5, vengono divisi in quattro fasce
+        double soilnoise {fractalNoise(px, py, 1)};
+        Soil::SoilType type {soilnoise < 0.42 ? Soil::SoilType::clay : soilnoise < 0.5 ? Soil::SoilType::loam
+                             : soilnoise < 0.58 ? Soil::SoilType::silt : Soil::SoilType::sand};
+        // Filari: una riga ogni rowspacing, coltivata dove il rumore è sotto la copertura richiesta
+        bool plants {x % parameters_.rowspacing == 0 && valueNoise(px, py, 2) < parameters_.plantcoverage};
+        // Gradienti con variazioni locali
+        double moisture {parameters_.moisturemax + (parameters_.moisturemin - parameters_.moisturemax) * x * lengthscale + 15.0 * (fractalNoise(px, py, 3) - 0.5)};
+        moisture = std::min(100.0, std::max(0.0, moisture));
+        double local {valueNoise(px * 0.25, py * 0.25, 4) - 0.5};
+        float airtemperature {static_cast<float>(parameters_.airtemperaturemin + (parameters_.airtemperaturemax - parameters_.airtemperaturemin) * y * widthscale + 2.0 * local)};
+        double airhumidity {parameters_.airhumiditymax + (parameters_.airhumiditymin - parameters_.airhumiditymax) * y * widthscale - 10.0 * local};
+        airhumidity = std::min(100.0, std::max(0.0, airhumidity));
+
+        field.soiltypes_[index] = static_cast<std::uint8_t>(type);
+        field.soilmoisture_[index] = moisture;
+        field.airtemperature_[index] = airtemperature;
+        field.airhumidity_[index] = airhumidity;
+        field.soiltemperature_[index] = Soil::soilTemperature(type, moisture, airtemperature, airhumidity);
+        if (plants) {
+            word |= std::uint64_t{1} << (index & 63);
+            ++plantcells;
+        }
+        if ((index & 63) == 63 || index + 1 == end) {
+            field.plants_[index >> 6] = word;
+            word = 0;
+        }
+        if (++y == width) {
+            y = 0;
+            ++x;
+        }
+    }
+    return plantcells;
+}
+
+// Funzione privata che restituisce un rumore a valori in [0, 1): valori pseudocasuali sui punti a coordinate intere, interpolati in modo continuo
+double FieldGenerator::valueNoise(double x, double y, std::uint64_t salt) const {
+    double floorx {std::floor(x)};
+    double floory {std::floor(y)};
+    std::int64_t cellx {static_cast<std::int64_t>(floorx)};
+    std::int64_t celly {static_cast<std::int64_t>(floory)};
+    std::uint64_t base {mix(parameters_.seed ^ mix(salt))};
+    auto corner = [base](std::int64_t cx, std::int64_t cy) {
+        std::uint64_t hash {mix(base ^ mix(static_cast<std::uint64_t>(cx) * 0x8CB92BA72F3D8DD7ULL + static_cast<std::uint64_t>(cy)))};
+        return (hash >> 11) * (1.0 / 9007199254740992.0);
+    };
+    double fx {x - floorx};
+    double fy {y - floory};
+    fx = fx * fx * (3.0 - 2.0 * fx);
+    fy = fy * fy * (3.0 - 2.0 * fy);
+    double top {corner(cellx, celly) + (corner(cellx + 1, celly) - corner(cellx, celly)) * fx};
+    double bottom {corner(cellx, celly + 1) + (corner(cellx + 1, celly + 1) - corner(cellx, celly + 1)) * fx};
+    return top + (bottom - top) * fy;
+}
+
+// Funzione privata che somma tre ottave di rumore a valori, ognuna con frequenza doppia e peso dimezzato rispetto alla precedente
+double FieldGenerator::fractalNoise(double x, double y, std::uint64_t salt) const {
+    double noise {valueNoise(x, y, salt) + 0.5 * valueNoise(2.0 * x, 2.0 * y, salt + 16) + 0.25 * valueNoise(4.0 * x, 4.0 * y, salt + 32)};
+    return noise / 1.75;
+}
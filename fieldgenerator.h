@@ -0,0 +1,48 @@
+// La classe "FieldGenerator" costruisce campi di grandi dimensioni per le prove di carico, in modo deterministico a partire da un seme.
+// Le proprietà di ogni cella dipendono solo dal seme e dalle coordinate:
+// 1) il tipo di suolo forma macchie irregolari, ottenute da un rumore a valori (value noise) su più ottave;
+// 2) le piante sono disposte in filari paralleli alla larghezza del campo, con tratti non coltivati decisi da un secondo rumore;
+// 3) l'umidità del suolo cala lungo la lunghezza del campo, la temperatura dell'aria sale lungo la larghezza e l'umidità dell'aria scende con essa,
+//    con piccole variazioni locali; la temperatura del suolo è quella di equilibrio calcolata da Soil.
+// Il campo viene scritto direttamente nelle sue colonne, senza passare da oggetti Soil, da un gruppo di thread: ognuno riempie un intervallo
+// contiguo di celle che inizia su una parola della bitmap delle piante, quindi i thread non scrivono mai la stessa memoria
+// e il risultato non dipende dal numero di thread.
+// La descrizione delle funzioni è presente nel file "fieldgenerator.cpp".
+
+#ifndef FIELDGENERATOR_H
+#define FIELDGENERATOR_H
+#include "field.h"
+#include <cstdint>
+#include <cstddef>
+
+class FieldGenerator {
+    public:
+        struct Parameters {
+            std::uint64_t seed;
+            double patchsize; // Dimensione tipica, in celle, delle macchie di suolo
+            int rowspacing; // Distanza tra due filari di piante, in righe
+            double plantcoverage; // Frazione indicativa di ogni filare coltivata, tra 0 e 1
+            double moisturemax; // Umidità del suolo alla prima riga
+            double moisturemin; // Umidità del suolo all'ultima riga
+            float airtemperaturemin; // Temperatura dell'aria alla prima colonna
+            float airtemperaturemax; // Temperatura dell'aria all'ultima colonna
+            double airhumiditymax; // Umidità dell'aria alla prima colonna
+            double airhumiditymin; // Umidità dell'aria all'ultima colonna
+        };
+        FieldGenerator(const Parameters& parameters, int threads);
+        static Parameters defaultParameters(std::uint64_t seed);
+        void generate(Field& field, int length, int width);
+        std::size_t getPlantCells() const { return plantcells_; }
+        double getLastSeconds() const { return lastseconds_; }
+
+    private:
+        Parameters parameters_;
+        int threads_;
+        std::size_t plantcells_; // Celle con piante nell'ultimo campo generato
+        double lastseconds_; // Durata dell'ultima generazione
+        std::size_t fillRange(Field& field, std::size_t begin, std::size_t end) const;
+        double valueNoise(double x, double y, std::uint64_t salt) const;
+        double fractalNoise(double x, double y, std::uint64_t salt) const;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "fieldpyramid.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Costruttore: la piramide è vuota finché non viene costruita con rebuild o alla prima chiamata di update
+FieldPyramid::FieldPyramid()
+    : length_{0},
+    width_{0}
+    {}
+
+// Funzione che restituisce il valore aggregato di una proprietà, ad esempio per una mappa di calore
+double FieldPyramid::Summary::value(Property property) const {
+    switch (property) {
+        case Property::PlantDensity:
+            return plantdensity;
+        case Property::SoilMoisture:
+            return soilmoisture;
+        case Property::AirTemperature:
+            return airtemperature;
+        case Property::AirHumidity:
+            return airhumidity;
+        case Property::SoilTemperature:
+            return soiltemperature;
+    }
+    return 0.0;
+}
+
+// Funzione che ricostruisce l'intera piramide per il campo descritto dalle viste, anche se le sue dimensioni sono cambiate
+void FieldPyramid::rebuild(const Sources& sources) {
+    length_ = sources.soiltypes.rows();
+    width_ = sources.soiltypes.columns();
+    levels_.clear();
+    int tile {BaseTile};
+    while (true) {
+        Level level;
+        level.tile = tile;
+        level.rows = (length_ + tile - 1) / tile;
+        level.columns = (width_ + tile - 1) / tile;
+        level.nodes.assign(static_cast<std::size_t>(level.rows) * level.columns, Node{});
+        levels_.push_back(std::move(level));
+        if (levels_.back().rows == 1 && levels_.back().columns == 1) {
+            break;
+        }
+        tile *= 2;
+    }
+    update(sources, 0, length_ - 1, 0, width_ - 1);
+}
+
+// Funzione che aggiorna la piramide dopo la modifica di un'area del campo (estremi inclusi):
+// le mattonelle del livello più fine che toccano l'area vengono ricalcolate dalle celle, quelle dei livelli superiori dai loro figli.
+// Se le dimensioni del campo sono cambiate la piramide viene ricostruita per intero.
+void FieldPyramid::update(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth) {
+    if (levels_.empty() || sources.soiltypes.rows() != length_ || sources.soiltypes.columns() != width_) {
+        rebuild(sources);
+        return;
+    }
+    int firstrow {startlength / BaseTile};
+    int lastrow {endlength / BaseTile};
+    int firstcolumn {startwidth / BaseTile};
+    int lastcolumn {endwidth / BaseTile};
+    Level& base = levels_[0];
+    for (int row = firstrow; row <= lastrow; ++row) {
+        for (int column = firstcolumn; column <= lastcolumn; ++column) {
+            Node node {};
+            addCells(sources, row * BaseTile, std::min(length_, (row + 1) * BaseTile) - 1,
+                     column * BaseTile, std::min(width_, (column + 1) * BaseTile) - 1, node);
+            base.nodes[static_cast<std::size_t>(row) * base.columns + column] = node;
+        }
+    }
+    for (std::size_t level = 1; level < levels_.size(); ++level) {
+        const Level& children = levels_[level - 1];
+        Level& parents = levels_[level];
+        firstrow /= 2;
+        lastrow /= 2;
+        firstcolumn /= 2;
+        lastcolumn /= 2;
+        for (int row = firstrow; row <= lastrow; ++row) {
+            for (int column = firstcolumn; column <= lastcolumn; ++column) {
+                Node node {};
+                for (int child = 2 * row; child <= std::min(2 * row + 1, children.rows - 1); ++child) {
+                    for (int childcolumn = 2 * column; childcolumn <= std::min(2 * column + 1, children.columns - 1); ++childcolumn) {
+                        addNode(children.nodes[static_cast<std::size_t>(child) * children.columns + childcolumn], node);
+                    }
+                }
+                parents.nodes[static_cast<std::size_t>(row) * parents.columns + column] = node;
+            }
+        }
+    }
+}
+
+// Funzione che riassume un'area del campo (estremi inclusi) in una griglia di rows x columns elementi, in ordine di riga.
+// Ogni elemento copre una parte dell'area di circa (lunghezza / rows) x (larghezza / columns) celle, la sua impronta.
+// Viene usato il livello con le mattonelle più grandi che non superano l'impronta più stretta, o più grandi ancora se l'impronta è molto allungata,
+// così che ogni elemento legga al massimo circa MaxTilesPerCell mattonelle; ogni mattonella viene assegnata all'elemento che ne contiene il centro.
+// Se le mattonelle più piccole sono ancora troppo grandi, ogni elemento viene calcolato esattamente dalle celle della sua impronta, che sono poche.
+void FieldPyramid::summarize(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth, int rows, int columns,
+                             std::vector<Summary>& summaries) const {
+    summaries.assign(static_cast<std::size_t>(rows) * columns, Summary{});
+    std::int64_t height {endlength - startlength + 1};
+    std::int64_t width {endwidth - startwidth + 1};
+    double rowfootprint {static_cast<double>(height) / rows};
+    double columnfootprint {static_cast<double>(width) / columns};
+    double wanted {std::max(std::min(rowfootprint, columnfootprint), std::sqrt(rowfootprint * columnfootprint / MaxTilesPerCell))};
+    const Level* level {nullptr};
+    for (const Level& candidate : levels_) {
+        if (candidate.tile <= wanted) {
+            level = &candidate;
+        }
+    }
+    for (int row = 0; row < rows; ++row) {
+        int firstx {startlength + static_cast<int>(row * height / rows)};
+        int lastx {std::max(firstx, startlength + static_cast<int>((row + 1) * height / rows) - 1)};
+        for (int column = 0; column < columns; ++column) {
+            int firsty {startwidth + static_cast<int>(column * width / columns)};
+            int lasty {std::max(firsty, startwidth + static_cast<int>((column + 1) * width / columns) - 1)};
+            Node node {};
+            if (level == nullptr) {
+                addCells(sources, firstx, lastx, firsty, lasty, node);
+            } else {
+                int firstrow, lastrow, firstcolumn, lastcolumn;
+                tileRange(level->tile, length_, firstx, lastx, firstrow, lastrow);
+                tileRange(level->tile, width_, firsty, lasty, firstcolumn, lastcolumn);
+                for (int tilerow = firstrow; tilerow <= lastrow; ++tilerow) {
+                    for (int tilecolumn = firstcolumn; tilecolumn <= lastcolumn; ++tilecolumn) {
+                        addNode(level->nodes[static_cast<std::size_t>(tilerow) * level->columns + tilecolumn], node);
+                    }
+                }
+            }
+            summaries[static_cast<std::size_t>(row) * columns + column] = toSummary(node);
+        }
+    }
+}
+
+// Funzione che restituisce la memoria occupata dalla piramide
+std::size_t FieldPyramid::getBytes() const {
+    std::size_t bytes {0};
+    for (const Level& level : levels_) {
+        bytes += level.nodes.capacity() * sizeof(Node);
+    }
+    return bytes;
+}
+
+// Funzione privata che aggiunge agli aggregati le celle di un'area (estremi inclusi)
+void FieldPyramid::addCells(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth, Node& node) {
+    for (int x = startlength; x <= endlength; ++x) {
+        for (int y = startwidth; y <= endwidth; ++y) {
+            ++node.soiltypes[static_cast<std::size_t>(sources.soiltypes(x, y))];
+            node.plants += sources.plants(x, y);
+            node.soilmoisture += sources.soilmoisture(x, y);
+            node.airtemperature += sources.airtemperature(x, y);
+            node.airhumidity += sources.airhumidity(x, y);
+            node.soiltemperature += sources.soiltemperature(x, y);
+        }
+    }
+    node.cells += static_cast<std::uint64_t>(endlength - startlength + 1) * (endwidth - startwidth + 1);
+}
+
+// Funzione privata che aggiunge gli aggregati di una mattonella a quelli di un'altra
+void FieldPyramid::addNode(const Node& from, Node& to) {
+    for (std::size_t type = 0; type < to.soiltypes.size(); ++type) {
+        to.soiltypes[type] += from.soiltypes[type];
+    }
+    to.plants += from.plants;
+    to.cells += from.cells;
+    to.soilmoisture += from.soilmoisture;
+    to.airtemperature += from.airtemperature;
+    to.airhumidity += from.airhumidity;
+    to.soiltemperature += from.soiltemperature;
+}
+
+// Funzione privata che ricava tipo di suolo prevalente, densità delle piante e valori medi dagli aggregati
+FieldPyramid::Summary FieldPyramid::toSummary(const Node& node) {
+    Summary summary {};
+    summary.cells = node.cells;
+    std::size_t majority {static_cast<std::size_t>(std::max_element(node.soiltypes.begin(), node.soiltypes.end()) - node.soiltypes.begin())};
+    summary.soiltype = static_cast<Soil::SoilType>(majority);
+    if (node.cells > 0) {
+        double cells {static_cast<double>(node.cells)};
+        summary.plantdensity = node.plants / cells;
+        summary.soilmoisture = node.soilmoisture / cells;
+        summary.airtemperature = node.airtemperature / cells;
+        summary.airhumidity = node.airhumidity / cells;
+        summary.soiltemperature = node.soiltemperature / cells;
+    }
+    return summary;
+}
+
+// Funzione privata che trova, lungo una dimensione di lunghezza extent, le mattonelle di lato tile con il centro nell'intervallo di celle [first, last].
+// Se nessun centro cade nell'intervallo, più stretto di una mattonella, viene scelta la mattonella che contiene il centro dell'intervallo.
+void FieldPyramid::tileRange(int tile, int extent, int first, int last, int& firsttile, int& lasttile) {
+    // Doppio del centro di una mattonella, che può essere più corta delle altre se è l'ultima
+    auto doubledCentre = [tile, extent](int index) { return 2 * index * tile + std::min(tile, extent - index * tile); };
+    firsttile = first / tile;
+    lasttile = last / tile;
+    if (doubledCentre(firsttile) < 2 * first) {
+        ++firsttile;
+    }
+    if (doubledCentre(lasttile) >= 2 * (last + 1)) {
+        --lasttile;
+    }
+    if (firsttile > lasttile) {
+        firsttile = (first + last) / 2 / tile;
+        lasttile = firsttile;
+    }
+}
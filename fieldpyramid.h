@@ -0,0 +1,83 @@
+// La classe "FieldPyramid" mantiene una piramide a più risoluzioni (mipmap) delle proprietà aggregate del campo.
+// Il livello più fine divide il campo in mattonelle di BaseTile x BaseTile celle; ogni livello successivo unisce le mattonelle a gruppi di 2 x 2,
+// fino a una sola mattonella che copre l'intero campo. Ogni mattonella conserva il numero di celle per tipo di suolo, il numero di celle con piante
+// e le somme di umidità e temperature, da cui si ricavano tipo di suolo prevalente, densità delle piante e valori medi.
+// Quando un'area del campo viene modificata, vengono ricalcolate dalle celle solo le mattonelle del livello più fine che la toccano,
+// poi i loro antenati a partire dai figli: il costo dipende dall'area modificata, non dalle dimensioni del campo.
+// Una sintesi di un'area in una griglia di righe x colonne (per una panoramica o una mappa di calore a qualsiasi scala) legge per ogni elemento
+// della griglia le mattonelle del livello adatto alla sua impronta, al massimo qualche decina, o le celle stesse quando l'impronta è piccola:
+// il costo dipende dalle dimensioni della griglia, non da quelle dell'area. Sulle impronte grandi i bordi sono approssimati a mattonelle intere.
+// La piramide non conserva puntatori al campo: le celle vengono lette da viste (vedi "fieldview.h") passate a ogni chiamata.
+// La descrizione delle funzioni è presente nel file "fieldpyramid.cpp".
+
+#ifndef FIELDPYRAMID_H
+#define FIELDPYRAMID_H
+#include "fieldview.h"
+#include "soil.h"
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+class FieldPyramid {
+    public:
+        static constexpr int BaseTile = 8; // Lato in celle delle mattonelle del livello più fine
+        static constexpr int SoilTypes = 4;
+        static constexpr double MaxTilesPerCell = 16.0; // Mattonelle lette al massimo, circa, per ogni elemento di una sintesi
+        // Proprietà che può essere mostrata in una mappa di calore
+        enum class Property {PlantDensity, SoilMoisture, AirTemperature, AirHumidity, SoilTemperature};
+        // Viste sull'intero campo da cui vengono lette le celle
+        struct Sources {
+            FieldView<SoilTypeProjection> soiltypes;
+            FieldView<PlantProjection> plants;
+            FieldView<PercentageProjection> soilmoisture;
+            FieldView<TemperatureProjection> airtemperature;
+            FieldView<PercentageProjection> airhumidity;
+            FieldView<TemperatureProjection> soiltemperature;
+        };
+        // Valori aggregati di un'area del campo
+        struct Summary {
+            std::uint64_t cells;
+            Soil::SoilType soiltype; // Tipo di suolo prevalente
+            double plantdensity; // Frazione delle celle con piante
+            double soilmoisture; // Valori medi
+            double airtemperature;
+            double airhumidity;
+            double soiltemperature;
+            double value(Property property) const;
+        };
+        FieldPyramid();
+        void rebuild(const Sources& sources);
+        void update(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth);
+        void summarize(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth, int rows, int columns,
+                       std::vector<Summary>& summaries) const;
+        int getLevels() const { return static_cast<int>(levels_.size()); }
+        std::size_t getBytes() const;
+
+    private:
+        // Aggregati di una mattonella: conteggi e somme, così che quelli di una mattonella siano la somma di quelli dei figli
+        struct Node {
+            std::array<std::uint64_t, SoilTypes> soiltypes;
+            std::uint64_t plants;
+            std::uint64_t cells;
+            double soilmoisture;
+            double airtemperature;
+            double airhumidity;
+            double soiltemperature;
+        };
+        struct Level {
+            int tile; // Lato in celle di una mattonella
+            int rows;
+            int columns;
+            std::vector<Node> nodes; // In ordine di riga
+        };
+        int length_;
+        int width_;
+        std::vector<Level> levels_;
+        static void addCells(const Sources& sources, int startlength, int endlength, int startwidth, int endwidth, Node& node);
+        static void addNode(const Node& from, Node& to);
+        static Summary toSummary(const Node& node);
+        static void tileRange(int tile, int extent, int first, int last, int& firsttile, int& lasttile);
+};
+
+#endif
@@ -0,0 +1,138 @@
+// La classe template "FieldView" è una vista non proprietaria su un'area rettangolare del campo, sul modello di std::mdspan:
+// non copia le celle ma ricorda da quale indice parte l'area, quante righe e colonne contiene e di quanto avanzare nelle colonne del campo
+// per passare alla riga o alla colonna successiva (i passi, che permettono anche di vedere una riga ogni n o una colonna ogni n).
+// Il valore di ogni cella viene letto da una proiezione, che conosce la colonna di una proprietà nelle due codifiche del campo
+// (normale, anche se mappata da file, e compatta) e restituisce il valore già decodificato:
+// - SoilTypeProjection: tipo di suolo;
+// - PlantProjection: presenza di piante, letta dalla bitmap o dal bit alto della codifica compatta;
+// - PercentageProjection: umidità del suolo o dell'aria;
+// - TemperatureProjection: temperatura dell'aria o del suolo.
+// Una vista costa pochi puntatori e interi, si copia per valore e si scorre con forEach o count senza allocare memoria.
+// Come gli iteratori di un vettore, resta valida finché il campo non sposta le sue colonne (vedi "field.h").
+// La classe è un template, quindi è interamente definita in questo file.
+
+#ifndef FIELDVIEW_H
+#define FIELDVIEW_H
+#include "soil.h"
+#include <cstdint>
+#include <cstddef>
+
+// Proiezione del tipo di suolo: colonna normale oppure bit bassi delle celle compatte
+struct SoilTypeProjection {
+    using value_type = Soil::SoilType;
+    const std::uint8_t* wide;
+    const std::uint8_t* compact;
+    value_type operator()(std::size_t index) const {
+        return static_cast<Soil::SoilType>(wide ? wide[index] : compact[index] & 0x7F);
+    }
+};
+
+// Proiezione della presenza di piante: un bit per cella nella bitmap oppure bit alto delle celle compatte
+struct PlantProjection {
+    using value_type = bool;
+    const std::uint64_t* bitmap;
+    const std::uint8_t* compact;
+    value_type operator()(std::size_t index) const {
+        return bitmap ? ((bitmap[index >> 6] >> (index & 63)) & 1u) != 0 : (compact[index] >> 7) != 0;
+    }
+};
+
+// Proiezione di un'umidità: colonna normale oppure cinquecentesimi di punto percentuale
+struct PercentageProjection {
+    using value_type = double;
+    static constexpr double Scale = 500.0;
+    const double* wide;
+    const std::uint16_t* compact;
+    value_type operator()(std::size_t index) const {
+        return wide ? wide[index] : compact[index] / Scale;
+    }
+};
+
+// Proiezione di una temperatura: colonna normale oppure centesimi di grado con segno
+struct TemperatureProjection {
+    using value_type = float;
+    static constexpr double Scale = 100.0;
+    const float* wide;
+    const std::int16_t* compact;
+    value_type operator()(std::size_t index) const {
+        return wide ? wide[index] : static_cast<float>(compact[index] / Scale);
+    }
+};
+
+template <typename Projection>
+class FieldView {
+    public:
+        using value_type = typename Projection::value_type;
+
+        // Vista vuota, senza righe né colonne
+        FieldView()
+            : projection_{},
+            origin_{0},
+            rows_{0},
+            columns_{0},
+            rowstride_{0},
+            columnstride_{0}
+            {}
+
+        // Vista di rows x columns celle che parte dalla cella di indice origin; i passi sono espressi in celle del campo
+        FieldView(Projection projection, std::size_t origin, int rows, int columns, std::ptrdiff_t rowstride, std::ptrdiff_t columnstride)
+            : projection_{projection},
+            origin_{origin},
+            rows_{rows},
+            columns_{columns},
+            rowstride_{rowstride},
+            columnstride_{columnstride}
+            {}
+
+        int rows() const { return rows_; }
+        int columns() const { return columns_; }
+        std::size_t size() const { return static_cast<std::size_t>(rows_) * columns_; }
+        bool empty() const { return rows_ == 0 || columns_ == 0; }
+        std::ptrdiff_t rowStride() const { return rowstride_; }
+        std::ptrdiff_t columnStride() const { return columnstride_; }
+
+        // Valore della cella alla riga e colonna indicate, relative all'angolo della vista; non viene fatto alcun controllo sui limiti
+        value_type operator()(int row, int column) const {
+            return projection_(origin_ + row * rowstride_ + column * columnstride_);
+        }
+
+        // Sotto-vista di rows x columns celle a partire dalla riga e colonna indicate, che devono essere interne alla vista
+        FieldView subview(int firstrow, int firstcolumn, int rows, int columns) const {
+            return FieldView(projection_, origin_ + firstrow * rowstride_ + firstcolumn * columnstride_, rows, columns, rowstride_, columnstride_);
+        }
+
+        // Vista di una riga ogni rowstep e di una colonna ogni columnstep, a partire dalla prima: ad esempio un campione regolare di un'area grande
+        FieldView strided(int rowstep, int columnstep) const {
+            return FieldView(projection_, origin_, (rows_ + rowstep - 1) / rowstep, (columns_ + columnstep - 1) / columnstep,
+                             rowstride_ * rowstep, columnstride_ * columnstep);
+        }
+
+        // Chiama function(riga, colonna, valore) per ogni cella della vista, riga per riga
+        template <typename Function>
+        void forEach(Function&& function) const {
+            for (int row = 0; row < rows_; ++row) {
+                std::size_t index {static_cast<std::size_t>(origin_ + row * rowstride_)};
+                for (int column = 0; column < columns_; ++column) {
+                    function(row, column, projection_(index));
+                    index += columnstride_;
+                }
+            }
+        }
+
+        // Numero di celle della vista con il valore indicato
+        std::size_t count(value_type value) const {
+            std::size_t matches {0};
+            forEach([&matches, value](int, int, value_type cell) { matches += cell == value; });
+            return matches;
+        }
+
+    private:
+        Projection projection_;
+        std::size_t origin_;
+        int rows_;
+        int columns_;
+        std::ptrdiff_t rowstride_;
+        std::ptrdiff_t columnstride_;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "fleetregistry.h"
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+// Costruttore: gli array di stato vengono allocati una sola volta per il numero massimo di veicoli gestibili
+FleetRegistry::FleetRegistry(int capacity)
+    : capacity_{capacity},
+    size_{0},
+    x_{new std::atomic<int>[capacity > 0 ? capacity : 0]},
+    y_{new std::atomic<int>[capacity > 0 ? capacity : 0]},
+    battery_{new std::atomic<float>[capacity > 0 ? capacity : 0]},
+    busy_{new std::atomic<bool>[capacity > 0 ? capacity : 0]},
+    type_(capacity > 0 ? capacity : 0, Vehicle::VehicleType::FieldVehicle),
+    vehicles_(capacity > 0 ? capacity : 0, nullptr)
+    {
+        if (capacity <= 0) {
+            std::cerr << "Invalid fleet capacity: at least one vehicle is required." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+// Funzione per registrare un veicolo: l'indice denso viene assegnato sotto il mutex di registrazione e salvato nella mappa del registro.
+// Se il veicolo è già registrato in questo registro viene restituito il suo indice, senza occupare un nuovo posto.
+int FleetRegistry::registerVehicle(Vehicle& vehicle) {
+    std::lock_guard<std::mutex> lock(registermutex_);
+    auto found = indices_.find(&vehicle);
+    if (found != indices_.end()) {
+        return found->second;
+    }
+    int index {size_.load()};
+    if (index >= capacity_) {
+        std::cerr << "Fleet registry is full: cannot register vehicle " << vehicle.getName() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    vehicles_[index] = &vehicle;
+    type_[index] = vehicle.getType();
+    x_[index].store(vehicle.getX());
+    y_[index].store(vehicle.getY());
+    battery_[index].store(vehicle.getBattery());
+    busy_[index].store(false);
+    indices_.emplace(&vehicle, index);
+    // Il veicolo diventa visibile ai lettori senza lock solo dopo che il suo stato è stato scritto
+    size_.store(index + 1);
+    return index;
+}
+
+// Funzione che restituisce l'indice di un veicolo in questo registro, o -1 se il veicolo non è registrato
+int FleetRegistry::findVehicle(const Vehicle& vehicle) const {
+    std::lock_guard<std::mutex> lock(registermutex_);
+    auto found = indices_.find(&vehicle);
+    return found != indices_.end() ? found->second : -1;
+}
+
+// Funzione che restituisce il numero di veicoli registrati
+int FleetRegistry::getSize() const {
+    return size_.load();
+}
+
+// Funzione che restituisce il veicolo associato a un indice, o nullptr se l'indice non è valido
+Vehicle* FleetRegistry::getVehicle(int index) const {
+    return validIndex(index) ? vehicles_[index] : nullptr;
+}
+
+// Funzioni per aggiornare e leggere lo stato di un veicolo: la lettura non richiede lock
+void FleetRegistry::setPosition(int index, int x, int y) {
+    if (validIndex(index)) {
+        x_[index].store(x);
+        y_[index].store(y);
+    }
+}
+
+std::pair<int, int> FleetRegistry::getPosition(int index) const {
+    if (!validIndex(index)) {
+        return {-1, -1};
+    }
+    return {x_[index].load(), y_[index].load()};
+}
+
+void FleetRegistry::setBattery(int index, float battery) {
+    if (validIndex(index)) {
+        battery_[index].store(battery);
+    }
+}
+
+float FleetRegistry::getBattery(int index) const {
+    return validIndex(index) ? battery_[index].load() : 0.0f;
+}
+
+void FleetRegistry::setBusy(int index, bool busy) {
+    if (validIndex(index)) {
+        busy_[index].store(busy);
+    }
+}
+
+bool FleetRegistry::isBusy(int index) const {
+    return validIndex(index) ? busy_[index].load() : false;
+}
+
+Vehicle::VehicleType FleetRegistry::getType(int index) const {
+    return validIndex(index) ? type_[index] : Vehicle::VehicleType::FieldVehicle;
+}
+
+// Funzione che verifica, con una passata lineare sugli array, se una cella è occupata o riservata da un veicolo diverso da quello indicato
+bool FleetRegistry::isCellOccupied(int x, int y, int excludedindex) const {
+    int size {getSize()};
+    for (int index = 0; index < size; ++index) {
+        if (index != excludedindex && x_[index].load() == x && y_[index].load() == y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Funzione che restituisce l'indice del veicolo libero più vicino a una cella (distanza di Chebyshev, come i movimenti dei veicoli), o -1 se sono tutti impegnati
+int FleetRegistry::findNearestFreeVehicle(int x, int y) const {
+    int size {getSize()};
+    int nearest {-1};
+    int nearestDistance {0};
+    for (int index = 0; index < size; ++index) {
+        if (busy_[index].load()) {
+            continue;
+        }
+        int distance {std::max(std::abs(x_[index].load() - x), std::abs(y_[index].load() - y))};
+        if (nearest < 0 || distance < nearestDistance) {
+            nearest = index;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
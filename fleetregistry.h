@@ -0,0 +1,53 @@
+// La classe "FleetRegistry" è il registro dei veicoli gestiti dal control center.
+// Ad ogni veicolo registrato viene assegnato un indice denso (0, 1, 2, ...), e lo stato del veicolo
+// (posizione, batteria, flag di impegno, tipo) è memorizzato in array contigui indicizzati da tale indice.
+// L'indice di ogni veicolo è conservato nel registro stesso (una mappa dal veicolo al suo indice), così che uno stesso veicolo
+// possa essere registrato in più registri; la registrazione avviene sotto un mutex ed è idempotente anche se chiamata da più thread.
+// In questo modo il control center trova un veicolo in tempo costante e scorre tutti i veicoli con una passata lineare sulla memoria.
+// Gli array hanno una capacità fissata alla costruzione, così da non essere mai riallocati mentre altri thread li leggono;
+// i campi di stato sono atomici e possono essere letti senza lock, mentre la coerenza tra più campi è garantita dal mutex delle posizioni del control center.
+// La descrizione delle funzioni è presente nel file "fleetregistry.cpp".
+
+#ifndef FLEETREGISTRY_H
+#define FLEETREGISTRY_H
+#include "vehicle.h"
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <mutex>
+#include <unordered_map>
+
+class FleetRegistry {
+    public:
+        FleetRegistry(int capacity);
+        int registerVehicle(Vehicle& vehicle);
+        int findVehicle(const Vehicle& vehicle) const;
+        int getSize() const;
+        int getCapacity() const { return capacity_; }
+        Vehicle* getVehicle(int index) const;
+        void setPosition(int index, int x, int y);
+        std::pair<int, int> getPosition(int index) const;
+        void setBattery(int index, float battery);
+        float getBattery(int index) const;
+        void setBusy(int index, bool busy);
+        bool isBusy(int index) const;
+        Vehicle::VehicleType getType(int index) const;
+        bool isCellOccupied(int x, int y, int excludedindex) const;
+        int findNearestFreeVehicle(int x, int y) const;
+
+    private:
+        int capacity_;
+        std::atomic<int> size_; // Numero di veicoli completamente registrati e visibili agli altri thread
+        mutable std::mutex registermutex_; // Protegge la registrazione e la mappa degli indici
+        std::unordered_map<const Vehicle*, int> indices_; // Indice di ogni veicolo registrato in questo registro
+        std::unique_ptr<std::atomic<int>[]> x_;
+        std::unique_ptr<std::atomic<int>[]> y_;
+        std::unique_ptr<std::atomic<float>[]> battery_;
+        std::unique_ptr<std::atomic<bool>[]> busy_;
+        std::vector<Vehicle::VehicleType> type_;
+        std::vector<Vehicle*> vehicles_;
+        bool validIndex(int index) const { return index >= 0 && index < getSize(); }
+};
+
+#endif
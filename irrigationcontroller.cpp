@@ -0,0 +1,144 @@
+#include "irrigationcontroller.h"
+#include <iostream>
+#include <algorithm>
+#include <tuple>
+
+// Costruttore: i passi vengono eseguiti su chiamata ad applyPending o periodicamente dopo startPeriodic
+IrrigationController::IrrigationController(Field& field)
+    : field_{field},
+    start_{std::chrono::steady_clock::now()},
+    stopping_{false}
+    {}
+
+// Distruttore: il thread dei passi periodici viene fermato e le richieste rimaste vengono applicate
+IrrigationController::~IrrigationController() {
+    stop();
+}
+
+// Funzione chiamata dal control center per chiedere di irrigare una cella fino all'umidità indicata.
+// La richiesta viene solo accodata: sarà applicata al campo al prossimo passo.
+void IrrigationController::requestIrrigation(int x, int y, double targetmoisture) {
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    pending_.push_back({x, y, std::min(100.0, std::max(0.0, targetmoisture))});
+    ++throughput_.commands;
+}
+
+// Funzione che esegue un passo: le richieste accumulate vengono fuse in rettangoli e applicate al campo con una sola scrittura.
+// Restituisce il numero di rettangoli scritti.
+std::size_t IrrigationController::applyPending() {
+    std::lock_guard<std::mutex> applyLock(applymutex_);
+    {
+        std::lock_guard<std::mutex> lock(requestmutex_);
+        working_.swap(pending_); // pending_ riceve il vettore vuoto del passo precedente, con la sua capacità
+    }
+    if (working_.empty()) {
+        return 0;
+    }
+    auto start = std::chrono::steady_clock::now();
+    coalesce(working_, rectangles_);
+    field_.applyIrrigation(rectangles_);
+    double seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    std::size_t rectangles {rectangles_.size()};
+    {
+        std::lock_guard<std::mutex> lock(requestmutex_);
+        throughput_.appliedcommands += working_.size();
+        throughput_.rectangles += rectangles;
+        ++throughput_.steps;
+        throughput_.writeseconds += seconds;
+    }
+    std::cout << "Debug: Irrigation step: " << working_.size() << " cells in " << rectangles << " rectangles" << std::endl;
+    working_.clear();
+    return rectangles;
+}
+
+// Funzione per avviare i passi periodici: ogni interval le richieste accumulate vengono applicate al campo
+void IrrigationController::startPeriodic(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    if (stepper_.joinable() || interval.count() <= 0) {
+        return;
+    }
+    stopping_ = false;
+    stepper_ = std::thread(&IrrigationController::stepperLoop, this, interval);
+}
+
+// Funzione per fermare i passi periodici: le richieste non ancora applicate vengono applicate subito
+void IrrigationController::stop() {
+    {
+        std::lock_guard<std::mutex> lock(requestmutex_);
+        stopping_ = true;
+    }
+    stopcv_.notify_one();
+    if (stepper_.joinable()) {
+        stepper_.join();
+    }
+    applyPending();
+}
+
+// Funzione che restituisce i contatori del controllore
+IrrigationController::Throughput IrrigationController::getThroughput() const {
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    Throughput throughput {throughput_};
+    throughput.elapsedseconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    return throughput;
+}
+
+// Funzione che fonde le richieste di un passo in rettangoli. Le richieste vengono riordinate: per ogni cella resta quella con l'obiettivo più alto,
+// poi le celle con lo stesso obiettivo vengono unite riga per riga in segmenti, e un segmento che ripete le colonne di quello della riga precedente
+// ne estende il rettangolo. Il risultato copre esattamente le celle richieste.
+void IrrigationController::coalesce(std::vector<Command>& commands, std::vector<Field::IrrigationUpdate>& rectangles) {
+    rectangles.clear();
+    std::sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        return std::tie(a.x, a.y, b.targetmoisture) < std::tie(b.x, b.y, a.targetmoisture);
+    });
+    commands.erase(std::unique(commands.begin(), commands.end(), [](const Command& a, const Command& b) { return a.x == b.x && a.y == b.y; }),
+                   commands.end());
+    std::sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        return std::tie(a.targetmoisture, a.x, a.y) < std::tie(b.targetmoisture, b.x, b.y);
+    });
+
+    std::vector<Field::IrrigationUpdate> open; // Rettangoli che arrivano alla riga precedente, ordinati per colonna
+    std::vector<Field::IrrigationUpdate> extended;
+    std::size_t index {0};
+    while (index < commands.size()) {
+        double target {commands[index].targetmoisture};
+        int x {commands[index].x};
+        // I rettangoli aperti che non arrivano alla riga precedente, o con un obiettivo diverso, non possono più crescere
+        if (!open.empty() && (open.front().soilmoisture != target || open.front().endlength != x - 1)) {
+            rectangles.insert(rectangles.end(), open.begin(), open.end());
+            open.clear();
+        }
+        std::size_t candidate {0};
+        while (index < commands.size() && commands[index].targetmoisture == target && commands[index].x == x) {
+            int first {commands[index].y};
+            int last {first};
+            ++index;
+            while (index < commands.size() && commands[index].targetmoisture == target && commands[index].x == x && commands[index].y == last + 1) {
+                ++last;
+                ++index;
+            }
+            while (candidate < open.size() && (open[candidate].startwidth < first || (open[candidate].startwidth == first && open[candidate].endwidth != last))) {
+                rectangles.push_back(open[candidate++]);
+            }
+            if (candidate < open.size() && open[candidate].startwidth == first && open[candidate].endwidth == last) {
+                extended.push_back(open[candidate++]);
+                extended.back().endlength = x;
+            } else {
+                extended.push_back({x, x, first, last, target});
+            }
+        }
+        rectangles.insert(rectangles.end(), open.begin() + candidate, open.end());
+        open.swap(extended);
+        extended.clear();
+    }
+    rectangles.insert(rectangles.end(), open.begin(), open.end());
+}
+
+// Funzione privata eseguita dal thread dei passi periodici
+void IrrigationController::stepperLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(requestmutex_);
+    while (!stopcv_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        applyPending();
+        lock.lock();
+    }
+}
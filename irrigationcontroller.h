@@ -0,0 +1,69 @@
+// La classe "IrrigationController" trasforma i verdetti "Critical: Too dry" del control center in comandi di irrigazione sul campo.
+// Il control center, analizzando una cella con suolo troppo asciutto, richiede di portarne l'umidità al centro dell'intervallo ottimale
+// per il suo tipo di suolo. Le richieste si accumulano in memoria e ad ogni passo (periodico o su chiamata) vengono:
+// 1) ordinate e private dei duplicati;
+// 2) fuse in rettangoli: celle contigue di una riga con lo stesso obiettivo formano un segmento, e segmenti uguali su righe consecutive un rettangolo;
+// 3) applicate al campo con una sola scrittura a blocchi (Field::applyIrrigation), invece di una scrittura per cella.
+// Le richieste del passo successivo vengono accumulate in un secondo vettore, così che il control center non attenda la scrittura sul campo.
+// I contatori misurano i comandi ricevuti e applicati, i rettangoli scritti e i comandi al secondo.
+// Con i passi periodici il campo viene scritto da un thread dedicato: finché è attivo, gli altri thread devono leggere il campo cella per cella
+// (getSoil, peekSoil, getSoilType) e non attraverso le viste.
+// La descrizione delle funzioni è presente nel file "irrigationcontroller.cpp".
+
+#ifndef IRRIGATIONCONTROLLER_H
+#define IRRIGATIONCONTROLLER_H
+#include "field.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+
+class IrrigationController {
+    public:
+        // Richiesta di irrigazione di una cella
+        struct Command {
+            int x;
+            int y;
+            double targetmoisture;
+        };
+        struct Throughput {
+            std::size_t commands = 0; // Richieste ricevute
+            std::size_t appliedcommands = 0; // Celle distinte irrigate, dopo l'eliminazione dei duplicati di ogni passo
+            std::size_t rectangles = 0; // Rettangoli scritti sul campo
+            std::size_t steps = 0; // Passi con almeno un comando
+            double elapsedseconds = 0.0; // Tempo dalla creazione del controllore
+            double writeseconds = 0.0; // Tempo speso a fondere e scrivere i comandi
+            double commandspersecond() const { return elapsedseconds > 0 ? commands / elapsedseconds : 0.0; }
+            double appliedpersecond() const { return writeseconds > 0 ? appliedcommands / writeseconds : 0.0; }
+        };
+        IrrigationController(Field& field);
+        ~IrrigationController();
+        IrrigationController(const IrrigationController&) = delete;
+        IrrigationController& operator=(const IrrigationController&) = delete;
+        void requestIrrigation(int x, int y, double targetmoisture);
+        std::size_t applyPending();
+        void startPeriodic(std::chrono::milliseconds interval);
+        void stop();
+        Throughput getThroughput() const;
+        static void coalesce(std::vector<Command>& commands, std::vector<Field::IrrigationUpdate>& rectangles);
+
+    private:
+        Field& field_;
+        std::chrono::steady_clock::time_point start_;
+        // Richieste in attesa del prossimo passo e vettori riusati dal passo in corso
+        mutable std::mutex requestmutex_;
+        std::vector<Command> pending_;
+        std::mutex applymutex_; // Un solo passo alla volta
+        std::vector<Command> working_;
+        std::vector<Field::IrrigationUpdate> rectangles_;
+        Throughput throughput_; // Protetto da requestmutex_
+        // Thread dei passi periodici
+        std::thread stepper_;
+        std::condition_variable stopcv_;
+        bool stopping_;
+        void stepperLoop(std::chrono::milliseconds interval);
+};
+
+#endif
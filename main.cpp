@@ -4,7 +4,7 @@
 // -Il sistema acquisisce tutte le posizioni delle piante presenti nel campo
 // -Il centro di controllo chiede al veicolo di spostarsi in tutte queste posizioni
 // - All'arrivo in ogni posizione, il veicolo legge i dati del suolo e li invia al centro di controllo
-// - Nel mentre, il centro di controllo periodicamente preleva i dati dal buffer e li analizza
+// - Nel mentre, il centro di controllo preleva i dati dal buffer non appena arrivano e li analizza
 // Il centro di controllo, al termine dell'operazione di movimento del veicolo e svuotato il buffer, stampa il vettore di risultati in un apposito file .txt
 
 #include "controlcenter.h"
@@ -12,42 +12,270 @@
 #include "field.h"
 #include "sensor.h"
 #include "soil.h"
+#include "tickengine.h"
+#include "territorypartitioner.h"
+#include "surveyplanner.h"
+#include "missioncheckpoint.h"
+#include "tracerecorder.h"
+#include "tracereplayer.h"
+#include "fielddynamics.h"
+#include "weatherstream.h"
+#include "irrigationcontroller.h"
+#include "fieldgenerator.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 
 
-void vehicleTask(Vehicle& vehicle, ControlCenter& controlCenter, const std::vector<std::pair<int, int>>& plantPositions) {
-    for (const auto& pos : plantPositions) {
+void vehicleTask(Vehicle& vehicle, ControlCenter& controlCenter, TerritoryPartitioner& partitioner, int territory) {
+    // Il veicolo legge le celle del proprio territorio; a territorio esaurito il partitioner gli assegna parte del lavoro dei veicoli in ritardo
+    std::pair<int, int> pos;
+    while (partitioner.nextCell(territory, vehicle.getX(), vehicle.getY(), pos)) {
         std::cout << "Debug: Plant position (" << pos.first << ", " << pos.second << ")" << std::endl;
         controlCenter.sendMovementCommandToVehicle(vehicle, pos.first, pos.second);
         controlCenter.commandDataRead(vehicle);
     }
+    // A fine percorso il veicolo invia le letture rimaste in attesa
+    controlCenter.commandDataFlush(vehicle);
     // Segnala che la raccolta dati è completata
     controlCenter.setDataCollectionComplete(true);
     controlCenter.notifyDataCollectionComplete();
 }
 
-void controlCenterTask(ControlCenter& controlCenter) {
-    while (true) {
-        {
-            if (controlCenter.isDataCollectionComplete() && controlCenter.isBufferEmpty() && !controlCenter.isAnalyzing()) {
-                std::cout << "Debug: Exiting analysis loop - all data processed" << std::endl;
-                break;
-            }
+// Monitoraggio in tempo reale della flotta: legge periodicamente la telemetria dei veicoli senza bloccarli
+void monitorTask(ControlCenter& controlCenter, const std::atomic<bool>& missionComplete) {
+    std::vector<TelemetrySample> samples;
+    while (!missionComplete.load()) {
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+        samples.clear();
+        controlCenter.collectTelemetry(samples);
+        for (const auto& sample : samples) {
+            std::cout << "Telemetry: vehicle " << sample.vehicleid << " " << TelemetrySample::stateToString(sample.state)
+                      << " at (" << sample.x << ", " << sample.y << "), battery " << sample.battery << "%" << std::endl;
         }
-        std::this_thread::sleep_for(std::chrono::seconds(1)); // Riduci il tempo di attesa
-        controlCenter.analyzeData();
     }
+}
+
+// Pattugliamento: il veicolo riceve una nuova cella ogni volta che termina la visita precedente, finché il budget di visite non è esaurito.
+// Quando tutte le celle sono assegnate all'altro veicolo, dispatchPatrolVisit attende invece di terminare il pattugliamento.
+void patrolTask(Vehicle& vehicle, ControlCenter& controlCenter) {
+    while (controlCenter.dispatchPatrolVisit(vehicle) != PatrolScheduler::Dispatch::Exhausted) {
+    }
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.notifyDataCollectionComplete();
+}
+
+void controlCenterTask(ControlCenter& controlCenter) {
+    // analyzeData resta in attesa dei dati e termina solo quando la raccolta è completata e il buffer è vuoto
+    controlCenter.analyzeData();
+    std::cout << "Debug: Exiting analysis loop - all data processed" << std::endl;
     controlCenter.setAnalysisComplete(true);
 }
 
 
-int main() {
+// Missione eseguita dal motore a tick: i veicoli avanzano tutti insieme un tick alla volta invece che ognuno sul proprio thread
+void lockstepMission(Field& field, ControlCenter& controlCenter, const std::vector<const Vehicle*>& vehicles,
+                     const std::vector<std::vector<std::pair<int, int>>>& routes) {
+    // Il motore è l'unico produttore di dati per il control center
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+    unsigned int cores {std::thread::hardware_concurrency()};
+    TickEngine engine(field, controlCenter, 0.5, cores > 0 ? static_cast<int>(cores) : 1);
+    for (std::size_t i = 0; i < vehicles.size(); ++i) {
+        int index {engine.addVehicle(vehicles[i]->getId(), vehicles[i]->getX(), vehicles[i]->getY(), vehicles[i]->getSpeed(), vehicles[i]->getBattery())};
+        engine.assignRoute(index, routes[i]);
+    }
+    std::size_t ticks {engine.run(1000000)};
+    std::cout << "Lockstep simulation: " << ticks << " ticks, " << engine.getSimulatedSeconds() << " simulated seconds, "
+              << engine.getReadingsSent() << " readings, " << engine.getCollisionWaits() << " collision waits" << std::endl;
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    controlCenterThread.join();
+}
+
+// Missione con rilevamento adattivo: prima una cella per blocco, poi solo i blocchi con suoli misti, esiti critici o forti gradienti vengono raffinati.
+// Ogni fase è una missione completa dei due veicoli, al termine della quale il planner legge le statistiche del control center.
+void adaptiveMission(Field& field, ControlCenter& controlCenter, Vehicle& vehicle, Vehicle& vehicle2) {
+    SurveyPlanner planner(field, 4);
+    std::vector<std::pair<int, int>> cells {planner.initialCells()};
+    while (!cells.empty()) {
+        TerritoryPartitioner partitioner;
+        partitioner.partition(cells, {{vehicle.getX(), vehicle.getY(), vehicle.getSpeed()},
+                                      {vehicle2.getX(), vehicle2.getY(), vehicle2.getSpeed()}});
+        controlCenter.setActiveVehicles(2);
+        std::thread vehicle1Thread(vehicleTask, std::ref(vehicle), std::ref(controlCenter), std::ref(partitioner), 0);
+        std::thread vehicle2Thread(vehicleTask, std::ref(vehicle2), std::ref(controlCenter), std::ref(partitioner), 1);
+        std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+        controlCenter.waitForMissionComplete();
+        vehicle1Thread.join();
+        vehicle2Thread.join();
+        controlCenterThread.join();
+        cells = planner.refine(controlCenter);
+    }
+    std::cout << "Adaptive survey: " << planner.getPhase() << " phases, " << planner.getVisitedCells() << " cells visited out of "
+              << planner.getPlantCells() << " plant cells, " << planner.getRefinedBlocks() << " blocks refined" << std::endl;
+}
+
+// Missione di pattugliamento: le visite vanno prima alle celle critiche e a quelle non visitate da più tempo, con un budget di due visite per pianta
+void patrolMission(ControlCenter& controlCenter, Vehicle& vehicle, Vehicle& vehicle2, const std::vector<std::pair<int, int>>& plantPositions) {
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(500)); // Gli esiti devono arrivare in fretta per aggiornare le priorità
+    controlCenter.startPatrol(plantPositions, 2 * plantPositions.size());
+    std::thread vehicle1Thread(patrolTask, std::ref(vehicle), std::ref(controlCenter));
+    std::thread vehicle2Thread(patrolTask, std::ref(vehicle2), std::ref(controlCenter));
+    std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+    controlCenter.waitForMissionComplete();
+    vehicle1Thread.join();
+    vehicle2Thread.join();
+    controlCenterThread.join();
+    controlCenter.stopPatrol();
+    std::cout << "Patrol: " << controlCenter.getPatrolVisits() << " visits for " << plantPositions.size() << " plant cells" << std::endl;
+}
+
+// Nuovo rilevamento dopo una modifica del campo: i veicoli visitano solo le celle con piante modificate dopo la generazione già rilevata
+void resurveyMission(ControlCenter& controlCenter, Vehicle& vehicle, Vehicle& vehicle2, std::uint64_t generation) {
+    std::vector<std::pair<int, int>> cells;
+    controlCenter.getChangedPlantCells(generation, cells);
+    std::cout << "Resurvey: " << cells.size() << " changed plant cells" << std::endl;
+    if (cells.empty()) {
+        return;
+    }
+    TerritoryPartitioner partitioner;
+    partitioner.partition(cells, {{vehicle.getX(), vehicle.getY(), vehicle.getSpeed()},
+                                  {vehicle2.getX(), vehicle2.getY(), vehicle2.getSpeed()}});
+    controlCenter.setActiveVehicles(2);
+    std::thread vehicle1Thread(vehicleTask, std::ref(vehicle), std::ref(controlCenter), std::ref(partitioner), 0);
+    std::thread vehicle2Thread(vehicleTask, std::ref(vehicle2), std::ref(controlCenter), std::ref(partitioner), 1);
+    std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+    controlCenter.waitForMissionComplete();
+    vehicle1Thread.join();
+    vehicle2Thread.join();
+    controlCenterThread.join();
+}
+
+
+// Riproduzione della traccia registrata con "--record": i batch arrivano al control center alla massima velocità, senza simulare i veicoli
+bool replayMission(ControlCenter& controlCenter) {
+    TraceReplayer replayer;
+    if (!replayer.open("sensor_trace.bin")) {
+        return false;
+    }
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+    TraceReplayer::ReplayReport report {replayer.replay(controlCenter, TraceReplayer::Pace::AsFastAsPossible)};
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    controlCenterThread.join();
+    std::cout << "Replay: " << report.batches << " batches, " << report.readings << " readings recorded in " << report.recordedseconds
+              << " s, replayed in " << report.elapsedseconds << " s (" << report.readingsPerSecond() << " readings/s)"
+              << (report.complete ? "" : ", truncated trace") << std::endl;
+    return true;
+}
+
+// Prova di carico con "--generate": viene generato un campo grande e misurato il tempo di generazione, di un passo di dinamica
+// e di un'irrigazione di tutte le celle con piante. La missione con i veicoli non viene eseguita.
+void generatedFieldBenchmark(int length, int width) {
+    int threads {static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    Field field("FattoriaGenerata", 1, 1);
+    FieldGenerator::Parameters parameters {FieldGenerator::defaultParameters(2024)};
+    FieldGenerator generator(parameters, threads);
+    generator.generate(field, length, width);
+    std::cout << "Generated field " << length << " x " << width << ": " << generator.getPlantCells() << " plant cells in "
+              << generator.getLastSeconds() << " s" << std::endl;
+    FieldDynamics fieldDynamics(field, threads);
+    auto start = std::chrono::steady_clock::now();
+    fieldDynamics.step(1.0);
+    std::cout << "Field dynamics, one hour: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+    IrrigationController irrigation(field);
+    for (int x = 0; x < length; x += parameters.rowspacing) {
+        for (int y = 0; y < width; ++y) {
+            irrigation.requestIrrigation(x, y, 40.0);
+        }
+    }
+    std::size_t rectangles {irrigation.applyPending()};
+    IrrigationController::Throughput throughput {irrigation.getThroughput()};
+    std::cout << "Irrigation of every crop row: " << throughput.appliedcommands << " cells in " << rectangles << " rectangles, "
+              << throughput.appliedpersecond() << " commands/s" << std::endl;
+    // Lettura completa del campo prima e dopo la compressione delle colonne. Le letture avvengono dopo le scritture della dinamica e dell'irrigazione,
+    // quindi la prima misura le colonne normali in memoria privata e la seconda le colonne compatte, senza scritture in mezzo che le espandano
+    auto scan = [&field, length, width] {
+        auto scanStart = std::chrono::steady_clock::now();
+        double total {0.0};
+        Soil soil;
+        for (int x = 0; x < length; ++x) {
+            for (int y = 0; y < width; ++y) {
+                field.peekSoil(x, y, soil);
+                total += soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor);
+            }
+        }
+        std::cout << "Full scan: mean moisture " << total / (static_cast<double>(length) * width) << " in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count() << " s, " << field.getColumnBytes() << " column bytes" << std::endl;
+        // La stessa lettura attraverso una vista sull'umidità, senza ricomporre le celle
+        scanStart = std::chrono::steady_clock::now();
+        total = 0.0;
+        field.viewSoilMoisture(0, length - 1, 0, width - 1).forEach([&total](int, int, double moisture) { total += moisture; });
+        std::cout << "View scan: mean moisture " << total / (static_cast<double>(length) * width) << " in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count() << " s" << std::endl;
+    };
+    scan();
+    field.compact();
+    scan();
+    // Panoramica del campo: la prima sintesi ricostruisce la piramide dei valori aggregati, le successive costano in proporzione alla griglia
+    std::vector<Field::Summary> summaries;
+    start = std::chrono::steady_clock::now();
+    field.summarize(0, length - 1, 0, width - 1, 40, 80, summaries);
+    std::cout << "Pyramid build and 40 x 80 overview: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s, "
+              << field.getPyramidBytes() << " pyramid bytes" << std::endl;
+    start = std::chrono::steady_clock::now();
+    field.summarize(0, length - 1, 0, width - 1, 40, 80, summaries);
+    std::cout << "40 x 80 overview: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+    field.printHeatmap(Field::HeatmapProperty::SoilMoisture, 0, length - 1, 0, width - 1, 20, 80);
+    // La prima scrittura espande il campo compatto e ne libera le colonne compatte
+    field.modifySoilProperty(0, 0, 0, 0, [](Soil& soil) { soil.setSoilMoisture(40.0); });
+    std::cout << "After a write on the compact field: " << field.getColumnBytes() << " column bytes" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Con l'opzione "--lockstep" la missione viene eseguita dal motore a tick invece che dai thread dei veicoli,
+    // con l'opzione "--adaptive" le celle vengono rilevate a risoluzione crescente solo dove serve,
+    // con l'opzione "--patrol" i veicoli pattugliano il campo visitando prima le celle critiche o non visitate da più tempo,
+    // con l'opzione "--resurvey" dopo la missione una parte del campo viene modificata e vengono rilevate di nuovo solo le celle cambiate,
+    // con l'opzione "--checkpoint" lo stato della missione viene salvato periodicamente nella cartella "mission_checkpoint",
+    // con l'opzione "--restore" la missione riprende dall'ultimo checkpoint salvato, rilevando solo le celle mancanti,
+    // con l'opzione "--record" tutti i batch ricevuti dal control center vengono registrati nella traccia "sensor_trace.bin",
+    // con l'opzione "--replay" la traccia registrata viene riprodotta nel control center senza simulare i veicoli,
+    // con l'opzione "--dynamics" prima della missione il campo evolve per tre giorni simulati (diffusione dell'umidità, evaporazione, temperatura del suolo),
+    // con l'opzione "--weather" prima della missione viene applicata la serie meteo "weather_series.csv" (o il file indicato dopo l'opzione),
+    // facendo evolvere il campo tra un passo e l'altro,
+    // con l'opzione "--irrigate" le celle con suolo troppo asciutto vengono irrigate durante la missione, con una scrittura sul campo al secondo,
+    // con l'opzione "--generate" viene eseguita solo una prova di carico su un campo generato (2000 x 2000, o lunghezza e larghezza indicate dopo l'opzione)
+    std::string mode {argc > 1 ? argv[1] : ""};
+    bool lockstep {mode == "--lockstep"};
+    bool adaptive {mode == "--adaptive"};
+    bool patrol {mode == "--patrol"};
+    bool resurvey {mode == "--resurvey"};
+    bool restoring {mode == "--restore"};
+    bool checkpointing {mode == "--checkpoint" || restoring};
+    bool recording {mode == "--record"};
+    bool replaying {mode == "--replay"};
+    bool dynamics {mode == "--dynamics"};
+    bool weather {mode == "--weather"};
+    bool irrigating {mode == "--irrigate"};
+    if (mode == "--generate") {
+        generatedFieldBenchmark(argc > 3 ? std::atoi(argv[2]) : 2000, argc > 3 ? std::atoi(argv[3]) : 2000);
+        return 0;
+    }
     // Creazione del campo con dimensioni 10x10 e nome "Fattoria"
     Field field("Fattoria", 5, 4);
 
@@ -65,6 +293,8 @@ int main() {
 
     // Creazione del centro di controllo, a cui viene passato il campo e impostato il numero di veicoli attivi
     ControlCenter controlCenter(field);
+    controlCenter.registerVehicle(vehicle);
+    controlCenter.registerVehicle(vehicle2);
     controlCenter.setActiveVehicles(2);
 
     // Aggiunta di piante in alcune aree del campo
@@ -86,36 +316,137 @@ int main() {
     // Stampa a video dei tipi di suolo presenti nel campo
     field.printPlantPresence();
 
+    // Evoluzione del campo prima della missione: 72 passi di un'ora
+    if (dynamics) {
+        FieldDynamics fieldDynamics(field, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+        auto start = std::chrono::steady_clock::now();
+        fieldDynamics.run(72, 1.0);
+        std::cout << "Field dynamics: " << fieldDynamics.getSimulatedHours() << " simulated hours, " << fieldDynamics.getSubsteps() << " substeps in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+    }
+
+    // Serie meteo: ogni passo è una sola scrittura sul campo, e tra due passi il campo evolve per le ore trascorse
+    if (weather) {
+        WeatherStream weatherStream;
+        if (!weatherStream.open(argc > 2 ? argv[2] : "weather_series.csv")) {
+            return EXIT_FAILURE;
+        }
+        FieldDynamics fieldDynamics(field, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+        double previousHour {0.0};
+        std::size_t applied {weatherStream.replay(field, [&fieldDynamics, &previousHour](const WeatherStream::WeatherStep& step) {
+            if (step.hour > previousHour) {
+                fieldDynamics.step(step.hour - previousHour);
+                previousHour = step.hour;
+            }
+        })};
+        std::cout << "Weather series: " << applied << " steps, " << weatherStream.getRegions() << " regions, "
+                  << weatherStream.getInvalidLines() << " invalid lines, " << fieldDynamics.getSimulatedHours() << " simulated hours" << std::endl;
+    }
 
 
+    // Checkpoint della missione: al ripristino campo, veicoli e control center riprendono lo stato salvato
+    std::unique_ptr<MissionCheckpoint> checkpoint;
+    std::vector<std::pair<int, int>> surveyedCells;
+    if (checkpointing) {
+        checkpoint.reset(new MissionCheckpoint(field, controlCenter, "mission_checkpoint"));
+    }
+    if (restoring) {
+        if (!checkpoint->restore(field)) {
+            return EXIT_FAILURE;
+        }
+        surveyedCells = checkpoint->getSurveyedCells();
+        controlCenter.setActiveVehicles(2);
+    }
 
-    // Acquisizione delle posizioni delle piante
+    // Acquisizione delle posizioni delle piante, escluse quelle già rilevate prima del ripristino
     std::vector<std::pair<int, int>> plantPositions;
-    for (int i = 0; i < 10; ++i) {
-        for (int j = 0; j < 10; ++j) {
-            if (field.getPlants(i, i, j, j)[0][0]) {
-                plantPositions.emplace_back(i, j);
-            }
+    field.viewPlants(0, field.getLength() - 1, 0, field.getWidth() - 1).forEach([&plantPositions, &surveyedCells](int i, int j, bool plants) {
+        if (plants && !std::binary_search(surveyedCells.begin(), surveyedCells.end(), std::make_pair(i, j))) {
+            plantPositions.emplace_back(i, j);
         }
+    });
+
+    // Irrigazione a ciclo chiuso: i verdetti "Too dry" diventano comandi, applicati al campo a blocchi ogni secondo.
+    // I passi partono dopo la lettura delle piante attraverso la vista: durante la missione il campo viene letto solo cella per cella.
+    std::unique_ptr<IrrigationController> irrigation;
+    if (irrigating) {
+        irrigation.reset(new IrrigationController(field));
+        controlCenter.setIrrigationController(irrigation.get());
+        irrigation->startPeriodic(std::chrono::seconds(1));
     }
 
-// Suddivisione delle posizioni delle piante tra i due veicoli
-std::vector<std::pair<int, int>> plantPositions1(plantPositions.begin(), plantPositions.begin() + plantPositions.size() / 2);
-std::vector<std::pair<int, int>> plantPositions2(plantPositions.begin() + plantPositions.size() / 2, plantPositions.end());
+    // Suddivisione delle posizioni delle piante in territori compatti, uno per veicolo
+    TerritoryPartitioner partitioner;
+    partitioner.partition(plantPositions, {{vehicle.getX(), vehicle.getY(), vehicle.getSpeed()},
+                                           {vehicle2.getX(), vehicle2.getY(), vehicle2.getSpeed()}});
+    std::cout << "Territory sizes: " << partitioner.getRemaining(0) << " and " << partitioner.getRemaining(1) << " plants" << std::endl;
+    std::uint64_t surveyedGeneration {field.getGeneration()}; // Generazione del campo rilevata dalla missione
 
 
-    // Creazione dei thread
-    std::thread vehicle1Thread(vehicleTask, std::ref(vehicle), std::ref(controlCenter), plantPositions1);
-    std::thread vehicle2Thread(vehicleTask, std::ref(vehicle2), std::ref(controlCenter), plantPositions2);
+    TraceRecorder recorder;
+    if (recording) {
+        if (!recorder.open("sensor_trace.bin")) {
+            return EXIT_FAILURE;
+        }
+        controlCenter.setTraceRecorder(&recorder);
+    }
 
-    std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+    if (replaying) {
+        if (!replayMission(controlCenter)) {
+            return EXIT_FAILURE;
+        }
+    } else if (patrol) {
+        patrolMission(controlCenter, vehicle, vehicle2, plantPositions);
+    } else if (adaptive) {
+        adaptiveMission(field, controlCenter, vehicle, vehicle2);
+    } else if (lockstep) {
+        lockstepMission(field, controlCenter, {&vehicle, &vehicle2}, {partitioner.getTerritory(0), partitioner.getTerritory(1)});
+    } else {
+        // Creazione dei thread
+        std::thread vehicle1Thread(vehicleTask, std::ref(vehicle), std::ref(controlCenter), std::ref(partitioner), 0);
+        std::thread vehicle2Thread(vehicleTask, std::ref(vehicle2), std::ref(controlCenter), std::ref(partitioner), 1);
 
-    // Attesa del completamento del thread del veicolo
-    vehicle1Thread.join();
-    vehicle2Thread.join();
+        std::thread controlCenterThread(controlCenterTask, std::ref(controlCenter));
+        std::atomic<bool> missionComplete{false};
+        std::thread monitorThread(monitorTask, std::ref(controlCenter), std::cref(missionComplete));
+        if (checkpoint) {
+            checkpoint->startPeriodic(std::chrono::seconds(2));
+        }
 
-    // Aspetta che il centro di controllo termini l'analisi
-    controlCenterThread.join(); 
+        // Attesa della fine della missione: ritorna appena è stato registrato l'ultimo risultato dell'analisi
+        controlCenter.waitForMissionComplete();
+        missionComplete.store(true);
+        if (checkpoint) {
+            checkpoint->stop();
+            checkpoint->writeCheckpoint(); // Checkpoint finale: la missione risulta completa
+            std::cout << "Checkpoints written: " << checkpoint->getCheckpoints() << ", field images: " << checkpoint->getFieldSnapshots() << std::endl;
+        }
+
+        vehicle1Thread.join();
+        vehicle2Thread.join();
+        controlCenterThread.join(); 
+        monitorThread.join();
+
+        if (recording) {
+            controlCenter.setTraceRecorder(nullptr);
+            recorder.close();
+            std::cout << "Recorded " << recorder.getRecordedBatches() << " batches, " << recorder.getRecordedReadings() << " readings" << std::endl;
+        }
+        if (resurvey) {
+            // L'area calda in alto a sinistra si raffredda: solo le sue celle con piante vanno rilevate di nuovo
+            field.modifySoilProperty(0, 1, 2, 3, [](Soil& soil) { soil.setAirTemperature(22.0); });
+            resurveyMission(controlCenter, vehicle, vehicle2, surveyedGeneration);
+        }
+    }
+
+    if (irrigation) {
+        controlCenter.setIrrigationController(nullptr);
+        irrigation->stop();
+        IrrigationController::Throughput throughput {irrigation->getThroughput()};
+        std::cout << "Irrigation: " << throughput.commands << " commands, " << throughput.appliedcommands << " cells in " << throughput.rectangles
+                  << " rectangles over " << throughput.steps << " steps, " << throughput.commandspersecond() << " commands/s, "
+                  << throughput.appliedpersecond() << " applied commands/s" << std::endl;
+    }
 
     // Stampa dei risultati dell'analisi in un file di testo consultabile dall'utente
     std::ofstream outFile("analysis_results.txt");
@@ -123,6 +454,13 @@ std::vector<std::pair<int, int>> plantPositions2(plantPositions.begin() + plantP
         outFile << result << std::endl;
     }
     outFile.close();
+    // Stampa a video della latenza delle due corsie di analisi
+    ControlCenter::LaneLatency priorityLatency = controlCenter.getLaneLatency(ControlCenter::Lane::Priority);
+    ControlCenter::LaneLatency normalLatency = controlCenter.getLaneLatency(ControlCenter::Lane::Normal);
+    std::cout << "Priority lane: " << priorityLatency.batches << " batches, mean latency " << priorityLatency.meanms() << " ms, max " << priorityLatency.maxms << " ms" << std::endl;
+    std::cout << "Normal lane: " << normalLatency.batches << " batches, mean latency " << normalLatency.meanms() << " ms, max " << normalLatency.maxms << " ms" << std::endl;
+    std::cout << "Unchanged cells not analyzed again: " << controlCenter.getUnchangedAnalyses() << std::endl;
+    std::cout << "Territory rebalances: " << partitioner.getRebalances() << std::endl;
     // Stampa a video il messaggio di completamento
     std::cout << "Exiting from Main Thread" << std::endl;
     return 0;
@@ -0,0 +1,433 @@
+#include "missioncheckpoint.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+// Formato di "state.bin" (versione 2), con i valori nell'ordine dei byte della macchina che ha scritto il checkpoint:
+// "AGCHKPT\0", versione, numero del checkpoint, generazione del campo salvato, numero dell'immagine del campo ("field-N.bin"),
+// numero di risultati validi, veicoli attivi,
+// i veicoli (id, x, y, batteria), i batch in attesa (corsia, numero di letture, letture) e le statistiche delle celle con almeno una lettura.
+namespace {
+    constexpr char StateMagic[8] = {'A', 'G', 'C', 'H', 'K', 'P', 'T', '\0'};
+    constexpr std::uint32_t StateVersion = 2;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
+
+// Costruttore: la cartella del checkpoint viene creata se non esiste
+MissionCheckpoint::MissionCheckpoint(const Field& field, ControlCenter& controlCenter, std::string directory)
+    : field_{field},
+    controlcenter_{controlCenter},
+    directory_{directory},
+    sequence_{0},
+    savedgeneration_{0},
+    fieldimage_{0},
+    nextimage_{1},
+    fieldsaved_{false},
+    writtenresults_{0},
+    fieldsnapshots_{0},
+    requested_{false},
+    stopping_{false},
+    interval_{0}
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        if (error) {
+            std::cerr << "Unable to create checkpoint directory " << directory_ << ": " << error.message() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // Le nuove immagini del campo non devono sovrascrivere quelle di un checkpoint già presente nella cartella
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+            std::uint64_t image {0};
+            if (parseFieldImage(entry.path().filename().string(), image)) {
+                nextimage_ = std::max(nextimage_, image + 1);
+            }
+        }
+    }
+
+// Distruttore: ferma il thread di scrittura
+MissionCheckpoint::~MissionCheckpoint() {
+    stop();
+}
+
+// Funzione che scrive subito un checkpoint sul thread chiamante. Restituisce false, con un messaggio di errore, se la scrittura fallisce:
+// in tal caso resta valido il checkpoint precedente.
+bool MissionCheckpoint::writeCheckpoint() {
+    std::lock_guard<std::mutex> lock(writemutex_);
+    // Copia dello stato: la generazione del campo viene letta per prima, così che una modifica concorrente venga salvata al checkpoint successivo
+    std::uint64_t generation {field_.getGeneration()};
+    ControlCenter::MissionState state;
+    controlcenter_.captureMissionState(state, writtenresults_);
+    std::vector<VehicleState> vehicles;
+    const FleetRegistry& fleet = controlcenter_.getFleet();
+    for (int index = 0; index < fleet.getSize(); ++index) {
+        std::pair<int, int> position {fleet.getPosition(index)};
+        vehicles.push_back({fleet.getVehicle(index)->getId(), position.first, position.second, fleet.getBattery(index)});
+    }
+
+    // Il campo viene scritto solo se è cambiato dall'ultima immagine salvata, in un file con un nuovo numero:
+    // l'immagine in uso resta intatta finché "state.bin" non indica quella nuova
+    std::uint64_t sequence {sequence_ + 1};
+    bool newimage {!fieldsaved_ || generation != savedgeneration_};
+    if (newimage && !field_.saveSnapshot(fieldPath(nextimage_))) {
+        return false;
+    }
+    if (!appendResults(state)) {
+        return false;
+    }
+    // Lo stato viene scritto per ultimo: solo da questo momento il nuovo checkpoint è quello valido
+    if (!writeState(state, vehicles, newimage ? generation : savedgeneration_, newimage ? nextimage_ : fieldimage_, sequence)) {
+        return false;
+    }
+    sequence_ = sequence;
+    if (newimage) {
+        std::error_code error;
+        if (fieldsaved_) {
+            std::filesystem::remove(fieldPath(fieldimage_), error); // L'immagine precedente non è più usata da alcun checkpoint
+        }
+        fieldimage_ = nextimage_++;
+        savedgeneration_ = generation;
+        fieldsaved_ = true;
+        ++fieldsnapshots_;
+    }
+    return true;
+}
+
+// Funzione privata che aggiunge a "results.txt" i risultati registrati dopo il checkpoint precedente; righe in più lasciate da un'aggiunta interrotta
+// vengono ignorate al ripristino. Al primo checkpoint, o dopo un ripristino, il file viene riscritto per intero in un file temporaneo poi rinominato,
+// così che un'interruzione non tolga righe al file del checkpoint precedente.
+bool MissionCheckpoint::appendResults(const ControlCenter::MissionState& state) {
+    bool rewrite {writtenresults_ == 0};
+    {
+        std::ofstream file(rewrite ? path("results.txt.tmp") : path("results.txt"), rewrite ? std::ios::trunc : std::ios::app);
+        if (!file) {
+            std::cerr << "Unable to write the checkpoint results." << std::endl;
+            return false;
+        }
+        for (const auto& result : state.results) {
+            file << result << '\n';
+        }
+        file.flush();
+        if (!file) {
+            std::cerr << "Error while writing the checkpoint results." << std::endl;
+            return false;
+        }
+    }
+    if (rewrite) {
+        std::error_code error;
+        std::filesystem::rename(path("results.txt.tmp"), path("results.txt"), error);
+        if (error) {
+            std::cerr << "Unable to replace the checkpoint results: " << error.message() << std::endl;
+            return false;
+        }
+    }
+    writtenresults_ = state.resultcount;
+    return true;
+}
+
+// Funzione privata che scrive "state.bin" in un file temporaneo e lo sostituisce a quello precedente
+bool MissionCheckpoint::writeState(const ControlCenter::MissionState& state, const std::vector<VehicleState>& vehicles, std::uint64_t generation,
+                                   std::uint64_t image, std::uint64_t sequence) const {
+    {
+        std::ofstream file(path("state.bin.tmp"), std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Unable to write the checkpoint state." << std::endl;
+            return false;
+        }
+        file.write(StateMagic, sizeof(StateMagic));
+        writeValue(file, StateVersion);
+        writeValue(file, sequence);
+        writeValue(file, generation);
+        writeValue(file, image);
+        writeValue(file, static_cast<std::uint64_t>(state.resultcount));
+        writeValue(file, static_cast<std::int32_t>(state.activevehicles));
+        writeValue(file, static_cast<std::uint32_t>(vehicles.size()));
+        for (const auto& vehicle : vehicles) {
+            writeValue(file, vehicle);
+        }
+        writeValue(file, static_cast<std::uint32_t>(state.batches.size()));
+        for (const auto& batch : state.batches) {
+            writeValue(file, static_cast<std::uint8_t>(batch.first));
+            writeValue(file, static_cast<std::uint32_t>(batch.second.size()));
+            for (const auto& reading : batch.second) {
+                writeValue(file, static_cast<std::int32_t>(reading.x));
+                writeValue(file, static_cast<std::int32_t>(reading.y));
+                writeValue(file, static_cast<std::uint8_t>(reading.type));
+                writeValue(file, reading.data);
+            }
+        }
+        writeValue(file, static_cast<std::uint32_t>(state.statistics.size()));
+        for (const auto& entry : state.statistics) {
+            writeValue(file, static_cast<std::int32_t>(entry.x));
+            writeValue(file, static_cast<std::int32_t>(entry.y));
+            writeValue(file, static_cast<std::uint8_t>(entry.type));
+            writeValue(file, static_cast<std::uint64_t>(entry.statistics.count));
+            writeValue(file, entry.statistics.mean);
+            writeValue(file, entry.statistics.m2);
+            writeValue(file, entry.statistics.min);
+            writeValue(file, entry.statistics.max);
+            writeValue(file, entry.statistics.last);
+        }
+        file.flush();
+        if (!file) {
+            std::cerr << "Error while writing the checkpoint state." << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(path("state.bin.tmp"), path("state.bin"), error);
+    if (error) {
+        std::cerr << "Unable to replace the checkpoint state: " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Funzione per chiedere un checkpoint al thread di scrittura: ritorna subito, senza attendere la scrittura
+void MissionCheckpoint::requestCheckpoint() {
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    requested_ = true;
+    if (!writer_.joinable()) {
+        stopping_ = false;
+        writer_ = std::thread(&MissionCheckpoint::writerLoop, this);
+    }
+    requestcv_.notify_one();
+}
+
+// Funzione per avviare i checkpoint periodici: il thread di scrittura salva lo stato ogni interval, oltre che ad ogni richiesta
+void MissionCheckpoint::startPeriodic(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    interval_ = interval;
+    if (!writer_.joinable()) {
+        stopping_ = false;
+        writer_ = std::thread(&MissionCheckpoint::writerLoop, this);
+    }
+    requestcv_.notify_one();
+}
+
+// Funzione per fermare il thread di scrittura: un checkpoint richiesto e non ancora scritto viene scritto prima di terminare
+void MissionCheckpoint::stop() {
+    {
+        std::lock_guard<std::mutex> lock(requestmutex_);
+        if (!writer_.joinable()) {
+            return;
+        }
+        stopping_ = true;
+        requestcv_.notify_one();
+    }
+    writer_.join();
+    std::lock_guard<std::mutex> lock(requestmutex_);
+    interval_ = std::chrono::milliseconds(0);
+    requested_ = false;
+}
+
+// Funzione privata eseguita dal thread di scrittura
+void MissionCheckpoint::writerLoop() {
+    std::unique_lock<std::mutex> lock(requestmutex_);
+    while (true) {
+        auto wakeup = [this] { return requested_ || stopping_; };
+        if (interval_.count() > 0) {
+            // Allo scadere dell'intervallo il checkpoint viene scritto anche senza richieste
+            if (!requestcv_.wait_for(lock, interval_, wakeup)) {
+                requested_ = true;
+            }
+        } else {
+            requestcv_.wait(lock, wakeup);
+        }
+        if (!requested_ && stopping_) {
+            return;
+        }
+        requested_ = false;
+        bool last {stopping_};
+        lock.unlock();
+        writeCheckpoint();
+        lock.lock();
+        if (last) {
+            return;
+        }
+    }
+}
+
+// Funzione che ripristina la missione dall'ultimo checkpoint valido della cartella: il campo viene sostituito dall'immagine salvata,
+// i veicoli registrati nel control center con lo stesso id tornano nella posizione salvata con la stessa batteria,
+// e il control center riprende batch in attesa, risultati e statistiche.
+// Va chiamata prima di avviare veicoli e analisi. Restituisce false, con un messaggio di errore, se non c'è un checkpoint valido.
+bool MissionCheckpoint::restore(Field& field) {
+    std::lock_guard<std::mutex> lock(writemutex_);
+    std::ifstream file(path("state.bin"), std::ios::binary);
+    if (!file) {
+        std::cerr << "No checkpoint found in " << directory_ << "." << std::endl;
+        return false;
+    }
+    char magic[8];
+    std::uint32_t version {0};
+    std::uint64_t sequence {0};
+    std::uint64_t generation {0};
+    std::uint64_t image {0};
+    std::uint64_t resultcount {0};
+    std::int32_t activevehicles {0};
+    std::uint32_t vehiclecount {0};
+    bool valid {file.read(magic, sizeof(magic)) && std::memcmp(magic, StateMagic, sizeof(magic)) == 0
+                && readValue(file, version) && version == StateVersion && readValue(file, sequence) && readValue(file, generation)
+                && readValue(file, image) && readValue(file, resultcount) && readValue(file, activevehicles) && readValue(file, vehiclecount)};
+    std::vector<VehicleState> vehicles(valid ? vehiclecount : 0);
+    for (auto& vehicle : vehicles) {
+        valid = valid && readValue(file, vehicle);
+    }
+    ControlCenter::MissionState state;
+    state.activevehicles = activevehicles;
+    std::uint32_t batchcount {0};
+    valid = valid && readValue(file, batchcount);
+    for (std::uint32_t batch = 0; valid && batch < batchcount; ++batch) {
+        std::uint8_t lane {0};
+        std::uint32_t readings {0};
+        valid = readValue(file, lane) && readValue(file, readings);
+        std::vector<SoilData> data;
+        for (std::uint32_t reading = 0; valid && reading < readings; ++reading) {
+            std::int32_t x {0};
+            std::int32_t y {0};
+            std::uint8_t type {0};
+            double value {0.0};
+            valid = readValue(file, x) && readValue(file, y) && readValue(file, type) && readValue(file, value) && type < Sensor::SensorTypeCount;
+            data.push_back({x, y, static_cast<Sensor::SensorType>(type), value});
+        }
+        state.batches.emplace_back(static_cast<ControlCenter::Lane>(lane), std::move(data));
+    }
+    std::uint32_t statisticscount {0};
+    valid = valid && readValue(file, statisticscount);
+    for (std::uint32_t entry = 0; valid && entry < statisticscount; ++entry) {
+        std::int32_t x {0};
+        std::int32_t y {0};
+        std::uint8_t type {0};
+        std::uint64_t count {0};
+        SensorStatistics statistics;
+        valid = readValue(file, x) && readValue(file, y) && readValue(file, type) && readValue(file, count)
+                && readValue(file, statistics.mean) && readValue(file, statistics.m2) && readValue(file, statistics.min)
+                && readValue(file, statistics.max) && readValue(file, statistics.last) && type < Sensor::SensorTypeCount;
+        statistics.count = count;
+        statistics.lastseen = std::chrono::steady_clock::now(); // Gli istanti non sono confrontabili tra processi diversi
+        state.statistics.push_back({x, y, static_cast<Sensor::SensorType>(type), statistics});
+    }
+    if (!valid) {
+        std::cerr << "Invalid checkpoint state in " << directory_ << "." << std::endl;
+        return false;
+    }
+
+    // Solo i primi resultcount risultati appartengono al checkpoint
+    std::ifstream results(path("results.txt"));
+    std::string line;
+    while (state.results.size() < resultcount && std::getline(results, line)) {
+        state.results.push_back(line);
+    }
+    if (state.results.size() < resultcount) {
+        std::cerr << "Missing checkpoint results in " << directory_ << "." << std::endl;
+        return false;
+    }
+    results.close();
+    if (!field.openSnapshot(fieldPath(image))) {
+        return false;
+    }
+
+    // I veicoli vengono riposizionati prima del control center, che aggiorna il proprio registro dai veicoli
+    const FleetRegistry& fleet = controlcenter_.getFleet();
+    for (int index = 0; index < fleet.getSize(); ++index) {
+        Vehicle* vehicle {fleet.getVehicle(index)};
+        auto saved = std::find_if(vehicles.begin(), vehicles.end(), [vehicle](const VehicleState& state) { return state.id == vehicle->getId(); });
+        if (saved != vehicles.end() && saved->x >= 0 && saved->x < field.getLength() && saved->y >= 0 && saved->y < field.getWidth()) {
+            vehicle->setPosition(saved->x, saved->y);
+            vehicle->setBattery(saved->battery);
+        }
+    }
+    state.resultcount = state.results.size();
+    controlcenter_.restoreMissionState(state);
+
+    // Celle già rilevate: quelle con letture nelle statistiche o in un batch in attesa
+    surveyedcells_.clear();
+    for (const auto& entry : state.statistics) {
+        surveyedcells_.emplace_back(entry.x, entry.y);
+    }
+    for (const auto& batch : state.batches) {
+        for (const auto& reading : batch.second) {
+            surveyedcells_.emplace_back(reading.x, reading.y);
+        }
+    }
+    std::sort(surveyedcells_.begin(), surveyedcells_.end());
+    surveyedcells_.erase(std::unique(surveyedcells_.begin(), surveyedcells_.end()), surveyedcells_.end());
+
+    // I checkpoint successivi proseguono quelli ripristinati: il file dei risultati viene riportato ai soli risultati validi
+    // e le immagini del campo lasciate da checkpoint interrotti vengono cancellate
+    sequence_ = sequence;
+    savedgeneration_ = field.getGeneration();
+    fieldimage_ = image;
+    fieldsaved_ = true;
+    removeOtherFieldImages();
+    writtenresults_ = 0;
+    ControlCenter::MissionState restored;
+    controlcenter_.captureMissionState(restored, 0);
+    if (!appendResults(restored)) {
+        return false;
+    }
+    std::cout << "Debug: Mission restored from checkpoint " << sequence_ << " (" << state.results.size() << " results, "
+              << state.batches.size() << " pending batches)" << std::endl;
+    return true;
+}
+
+// Funzione privata che cancella dalla cartella le immagini del campo diverse da quella in uso, ad esempio scritte da un checkpoint interrotto
+void MissionCheckpoint::removeOtherFieldImages() const {
+    std::vector<std::filesystem::path> unused;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        std::uint64_t image {0};
+        if (parseFieldImage(entry.path().filename().string(), image) && image != fieldimage_) {
+            unused.push_back(entry.path());
+        }
+    }
+    for (const auto& file : unused) {
+        std::filesystem::remove(file, error);
+    }
+}
+
+// Funzione privata che riconosce il nome di un'immagine del campo, "field-N.bin", e ne ricava il numero
+bool MissionCheckpoint::parseFieldImage(const std::string& name, std::uint64_t& image) {
+    const std::string prefix {"field-"};
+    const std::string suffix {".bin"};
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0
+        || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    std::string digits {name.substr(prefix.size(), name.size() - prefix.size() - suffix.size())};
+    if (!std::all_of(digits.begin(), digits.end(), [](char digit) { return digit >= '0' && digit <= '9'; }) || digits.size() > 19) {
+        return false;
+    }
+    image = std::stoull(digits);
+    return true;
+}
+
+// Funzione che restituisce le celle già rilevate secondo l'ultimo checkpoint ripristinato, in ordine crescente
+std::vector<std::pair<int, int>> MissionCheckpoint::getSurveyedCells() const {
+    return surveyedcells_;
+}
+
+// Funzione che restituisce il numero dell'ultimo checkpoint scritto o ripristinato
+std::size_t MissionCheckpoint::getCheckpoints() const {
+    std::lock_guard<std::mutex> lock(writemutex_);
+    return sequence_;
+}
+
+// Funzione che restituisce quante volte l'immagine del campo è stata effettivamente riscritta
+std::size_t MissionCheckpoint::getFieldSnapshots() const {
+    std::lock_guard<std::mutex> lock(writemutex_);
+    return fieldsnapshots_;
+}
@@ -0,0 +1,81 @@
+// La classe "MissionCheckpoint" salva periodicamente, o su richiesta, lo stato di una missione in una cartella, così che dopo un riavvio
+// del processo la missione possa riprendere da dove si era interrotta invece di essere ripetuta da capo.
+// Il checkpoint contiene il campo, la posizione e la batteria dei veicoli registrati nel control center, i batch in attesa di analisi,
+// i risultati registrati e le statistiche delle celle. La cartella contiene tre file:
+// - "field-N.bin": l'immagine binaria del campo, scritta solo se il campo è cambiato dall'ultima immagine, con un numero N mai usato nella cartella;
+// - "results.txt": i risultati dell'analisi, uno per riga, a cui vengono aggiunti solo quelli nuovi;
+// - "state.bin": tutto il resto, riscritto per intero ad ogni checkpoint (è piccolo) insieme al numero dell'immagine del campo e al numero di risultati validi.
+// Il checkpoint diventa valido solo quando "state.bin" viene sostituito, per ultimo: un'interruzione in qualsiasi momento lascia intatto il checkpoint precedente,
+// perché una nuova immagine del campo ha un nome diverso da quella in uso, "state.bin" e "results.txt" riscritto per intero passano da un file temporaneo
+// poi rinominato, e le righe aggiunte a "results.txt" oltre il numero di risultati validi vengono ignorate al ripristino.
+// L'immagine precedente viene cancellata solo dopo la sostituzione di "state.bin".
+// La copia dello stato tiene i lock del control center solo per pochi istanti e la scrittura avviene su un thread dedicato, senza fermare la missione.
+// La descrizione delle funzioni è presente nel file "missioncheckpoint.cpp".
+
+#ifndef MISSIONCHECKPOINT_H
+#define MISSIONCHECKPOINT_H
+#include "controlcenter.h"
+#include "field.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+class MissionCheckpoint {
+    public:
+        MissionCheckpoint(const Field& field, ControlCenter& controlCenter, std::string directory);
+        ~MissionCheckpoint();
+        MissionCheckpoint(const MissionCheckpoint&) = delete;
+        MissionCheckpoint& operator=(const MissionCheckpoint&) = delete;
+        bool writeCheckpoint();
+        void requestCheckpoint();
+        void startPeriodic(std::chrono::milliseconds interval);
+        void stop();
+        bool restore(Field& field);
+        std::vector<std::pair<int, int>> getSurveyedCells() const;
+        std::size_t getCheckpoints() const;
+        std::size_t getFieldSnapshots() const;
+
+    private:
+        // Posizione e batteria di un veicolo registrato, riconosciuto al ripristino dal suo id
+        struct VehicleState {
+            std::int32_t id;
+            std::int32_t x;
+            std::int32_t y;
+            float battery;
+        };
+        const Field& field_;
+        ControlCenter& controlcenter_;
+        std::string directory_;
+        mutable std::mutex writemutex_; // Un solo checkpoint alla volta; protegge anche i contatori
+        std::uint64_t sequence_; // Numero dell'ultimo checkpoint scritto
+        std::uint64_t savedgeneration_; // Generazione del campo nell'ultima immagine salvata
+        std::uint64_t fieldimage_; // Numero dell'immagine del campo in uso
+        std::uint64_t nextimage_; // Numero della prossima immagine del campo, maggiore di quelli presenti nella cartella
+        bool fieldsaved_;
+        std::size_t writtenresults_; // Risultati già presenti in "results.txt"
+        std::size_t fieldsnapshots_;
+        std::vector<std::pair<int, int>> surveyedcells_; // Celle già rilevate secondo l'ultimo checkpoint ripristinato
+        // Thread di scrittura dei checkpoint periodici e di quelli richiesti
+        std::thread writer_;
+        std::mutex requestmutex_;
+        std::condition_variable requestcv_;
+        bool requested_;
+        bool stopping_;
+        std::chrono::milliseconds interval_;
+        void writerLoop();
+        std::string path(const char* name) const { return directory_ + "/" + name; }
+        std::string fieldPath(std::uint64_t image) const { return directory_ + "/field-" + std::to_string(image) + ".bin"; }
+        bool writeState(const ControlCenter::MissionState& state, const std::vector<VehicleState>& vehicles, std::uint64_t generation,
+                        std::uint64_t image, std::uint64_t sequence) const;
+        void removeOtherFieldImages() const;
+        static bool parseFieldImage(const std::string& name, std::uint64_t& image);
+        bool appendResults(const ControlCenter::MissionState& state);
+};
+
+#endif
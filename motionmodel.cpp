@@ -0,0 +1,68 @@
+#include "motionmodel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// Costruttore di default: veicolo fermo nella cella (0, 0)
+MotionModel::MotionModel()
+    : MotionModel(0, 0)
+    {}
+
+// Costruttore di un veicolo fermo in una cella: partenza e arrivo coincidono
+MotionModel::MotionModel(int x, int y)
+    : startx_{x},
+    starty_{y},
+    targetx_{x},
+    targety_{y},
+    speed_{1.0},
+    batterypercell_{0.0f},
+    distance_{0},
+    start_{Clock::now()}
+    {}
+
+// Costruttore di uno spostamento: la velocità è in celle al secondo e deve essere positiva (controllo già effettuato dal veicolo)
+MotionModel::MotionModel(int startx, int starty, int targetx, int targety, double speed, float batterypercell, Clock::time_point start)
+    : startx_{startx},
+    starty_{starty},
+    targetx_{targetx},
+    targety_{targety},
+    speed_{speed},
+    batterypercell_{batterypercell},
+    distance_{distance(startx, starty, targetx, targety)},
+    start_{start}
+    {}
+
+// Distanza di Chebyshev: numero di passi necessari muovendosi anche in diagonale
+int MotionModel::distance(int x1, int y1, int x2, int y2) {
+    return std::max(std::abs(x2 - x1), std::abs(y2 - y1));
+}
+
+// Durata dello spostamento in secondi
+std::chrono::duration<double> MotionModel::getDuration() const {
+    return std::chrono::duration<double>(distance_ / speed_);
+}
+
+// Istante di arrivo alla cella target
+MotionModel::Clock::time_point MotionModel::getArrivalTime() const {
+    return start_ + std::chrono::duration_cast<Clock::duration>(getDuration());
+}
+
+// Posizione dopo un certo numero di passi: ogni coordinata avanza di una cella per passo finché non raggiunge quella del target
+std::pair<int, int> MotionModel::positionAfterSteps(int steps) const {
+    steps = std::max(0, std::min(steps, distance_));
+    int dx {targetx_ - startx_};
+    int dy {targety_ - starty_};
+    int x {startx_ + (dx > 0 ? 1 : -1) * std::min(steps, std::abs(dx))};
+    int y {starty_ + (dy > 0 ? 1 : -1) * std::min(steps, std::abs(dy))};
+    return {x, y};
+}
+
+// Posizione ad un istante qualsiasi: si contano i passi interi completati dall'inizio dello spostamento
+std::pair<int, int> MotionModel::positionAt(Clock::time_point time) const {
+    if (time <= start_) {
+        return {startx_, starty_};
+    }
+    double elapsed {std::chrono::duration<double>(time - start_).count()};
+    int steps {static_cast<int>(std::floor(elapsed * speed_))};
+    return positionAfterSteps(steps);
+}
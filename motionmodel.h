@@ -0,0 +1,41 @@
+// La classe "MotionModel" descrive in forma chiusa un singolo spostamento di un veicolo da una cella di partenza a una cella di arrivo.
+// I veicoli si muovono come nella simulazione passo-passo originale: ad ogni passo si avvicinano di una cella al target sia lungo x che lungo y,
+// quindi il numero di passi è la distanza di Chebyshev tra partenza e arrivo e la durata è tale distanza divisa per la velocità (celle al secondo).
+// Dal modello si ricavano direttamente istante di arrivo, consumo di batteria e posizione ad un qualsiasi istante intermedio, senza simulare ogni cella attraversata.
+// La descrizione delle funzioni è presente nel file "motionmodel.cpp".
+
+#ifndef MOTIONMODEL_H
+#define MOTIONMODEL_H
+#include <chrono>
+#include <utility>
+
+class MotionModel {
+    public:
+        using Clock = std::chrono::steady_clock;
+        MotionModel();
+        MotionModel(int x, int y);
+        MotionModel(int startx, int starty, int targetx, int targety, double speed, float batterypercell, Clock::time_point start);
+        static int distance(int x1, int y1, int x2, int y2);
+        int getDistance() const { return distance_; }
+        int getTargetX() const { return targetx_; }
+        int getTargetY() const { return targety_; }
+        std::chrono::duration<double> getDuration() const;
+        Clock::time_point getStartTime() const { return start_; }
+        Clock::time_point getArrivalTime() const;
+        float getBatteryUse() const { return distance_ * batterypercell_; }
+        std::pair<int, int> positionAfterSteps(int steps) const;
+        std::pair<int, int> positionAt(Clock::time_point time) const;
+        bool isArrived(Clock::time_point time) const { return time >= getArrivalTime(); }
+
+    private:
+        int startx_;
+        int starty_;
+        int targetx_;
+        int targety_;
+        double speed_;
+        float batterypercell_;
+        int distance_;
+        Clock::time_point start_;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "multifieldcontrolcenter.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Costruttore: gli shard vengono aggiunti con addField prima di avviare l'analisi
+MultiFieldControlCenter::MultiFieldControlCenter()
+    : started_{false},
+    pinnedshards_{0}
+    {}
+
+// Distruttore: attende i thread di analisi ancora attivi
+MultiFieldControlCenter::~MultiFieldControlCenter() {
+    for (auto& shard : shards_) {
+        if (shard->analyzer.joinable()) {
+            shard->controlcenter->setActiveVehicles(0); // Sblocca un'analisi ancora in attesa di dati
+            shard->analyzer.join();
+        }
+    }
+}
+
+// Funzione per aggiungere un campo: viene creato il suo shard e ne viene restituito l'indice
+int MultiFieldControlCenter::addField(const Field& field) {
+    if (started_) {
+        std::cerr << "Cannot add field " << field.getFieldname() << ": the shards are already running." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::unique_ptr<Shard> shard {new Shard{&field, std::unique_ptr<ControlCenter>(new ControlCenter(field)), std::thread()}};
+    shards_.push_back(std::move(shard));
+    return getShardCount() - 1;
+}
+
+// Funzione che restituisce il control center di uno shard, a cui registrare i veicoli del campo e inviare i dati
+ControlCenter& MultiFieldControlCenter::getControlCenter(int shard) {
+    if (!validShard(shard)) {
+        std::cerr << "Invalid shard index: " << shard << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return *shards_[shard]->controlcenter;
+}
+
+// Funzione che restituisce il campo gestito da uno shard
+const Field& MultiFieldControlCenter::getField(int shard) const {
+    if (!validShard(shard)) {
+        std::cerr << "Invalid shard index: " << shard << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return *shards_[shard]->field;
+}
+
+// Funzione che avvia un thread di analisi per ogni shard, fissato al core (indice dello shard modulo numero di core).
+// Il numero di veicoli attivi di ogni shard va impostato prima dell'avvio.
+void MultiFieldControlCenter::start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    unsigned int cores {std::max(1u, std::thread::hardware_concurrency())};
+    for (std::size_t index = 0; index < shards_.size(); ++index) {
+        ControlCenter* controlCenter {shards_[index]->controlcenter.get()};
+        shards_[index]->analyzer = std::thread([controlCenter] {
+            controlCenter->analyzeData();
+            controlCenter->setAnalysisComplete(true);
+        });
+        if (pinThread(shards_[index]->analyzer, static_cast<unsigned int>(index % cores))) {
+            ++pinnedshards_;
+        }
+    }
+}
+
+// Funzione che blocca il chiamante finché la missione di ogni shard non è terminata e ne attende i thread di analisi
+void MultiFieldControlCenter::waitForAllMissions() {
+    for (auto& shard : shards_) {
+        shard->controlcenter->waitForMissionComplete();
+        if (shard->analyzer.joinable()) {
+            shard->analyzer.join();
+        }
+    }
+}
+
+// Funzione che riunisce i risultati di tutti i campi: ogni risultato è preceduto dal nome del proprio campo
+std::vector<std::string> MultiFieldControlCenter::getMergedResults() const {
+    std::vector<std::string> merged;
+    for (const auto& shard : shards_) {
+        std::vector<std::string> results {shard->controlcenter->getAnalysisResults()};
+        merged.reserve(merged.size() + results.size());
+        for (auto& result : results) {
+            merged.push_back("[" + shard->field->getFieldname() + "] " + result);
+        }
+    }
+    return merged;
+}
+
+// Funzione che restituisce il riepilogo di uno shard
+MultiFieldControlCenter::ShardReport MultiFieldControlCenter::getShardReport(int shard) const {
+    ShardReport report;
+    if (!validShard(shard)) {
+        return report;
+    }
+    const ControlCenter& controlCenter = *shards_[shard]->controlcenter;
+    report.fieldname = shards_[shard]->field->getFieldname();
+    report.results = controlCenter.getAnalysisResults().size();
+    report.unchangedanalyses = controlCenter.getUnchangedAnalyses();
+    report.priority = controlCenter.getLaneLatency(ControlCenter::Lane::Priority);
+    report.normal = controlCenter.getLaneLatency(ControlCenter::Lane::Normal);
+    return report;
+}
+
+// Funzione che restituisce il riepilogo complessivo di tutti gli shard
+MultiFieldControlCenter::ShardReport MultiFieldControlCenter::getMergedReport() const {
+    ShardReport merged;
+    merged.fieldname = "All fields";
+    for (int shard = 0; shard < getShardCount(); ++shard) {
+        ShardReport report {getShardReport(shard)};
+        merged.results += report.results;
+        merged.unchangedanalyses += report.unchangedanalyses;
+        mergeLatency(merged.priority, report.priority);
+        mergeLatency(merged.normal, report.normal);
+    }
+    return merged;
+}
+
+// Funzione privata che fissa un thread a un core; dove l'affinità non è disponibile il thread resta libero e si restituisce false
+bool MultiFieldControlCenter::pinThread(std::thread& thread, unsigned int core) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+// Funzione privata che somma la latenza di una corsia di uno shard al totale
+void MultiFieldControlCenter::mergeLatency(ControlCenter::LaneLatency& total, const ControlCenter::LaneLatency& shard) {
+    total.batches += shard.batches;
+    total.totalms += shard.totalms;
+    total.maxms = std::max(total.maxms, shard.maxms);
+}
@@ -0,0 +1,58 @@
+// La classe "MultiFieldControlCenter" permette a un solo processo di gestire più campi agricoli.
+// Ogni campo ha il proprio shard, cioè un control center dedicato con la propria coda di ingresso dei dati, il proprio registro dei veicoli
+// (e quindi la propria griglia di occupazione), le proprie statistiche e i propri risultati: shard diversi non condividono alcun mutex.
+// Ogni shard ha un thread di analisi che, su Linux, viene fissato a un core diverso, così che la capacità di analisi cresca con il numero di campi
+// fino al numero di core della macchina.
+// I report dei singoli campi vengono infine riuniti in un report complessivo.
+// La descrizione delle funzioni è presente nel file "multifieldcontrolcenter.cpp".
+
+#ifndef MULTIFIELDCONTROLCENTER_H
+#define MULTIFIELDCONTROLCENTER_H
+#include "controlcenter.h"
+#include "field.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <cstddef>
+
+class MultiFieldControlCenter {
+    public:
+        // Riepilogo dell'attività di uno shard, o di tutti gli shard nel report complessivo
+        struct ShardReport {
+            std::string fieldname;
+            std::size_t results = 0;
+            std::size_t unchangedanalyses = 0;
+            ControlCenter::LaneLatency priority;
+            ControlCenter::LaneLatency normal;
+        };
+        MultiFieldControlCenter();
+        ~MultiFieldControlCenter();
+        MultiFieldControlCenter(const MultiFieldControlCenter&) = delete;
+        MultiFieldControlCenter& operator=(const MultiFieldControlCenter&) = delete;
+        int addField(const Field& field);
+        int getShardCount() const { return static_cast<int>(shards_.size()); }
+        ControlCenter& getControlCenter(int shard);
+        const Field& getField(int shard) const;
+        void start();
+        void waitForAllMissions();
+        std::vector<std::string> getMergedResults() const;
+        ShardReport getShardReport(int shard) const;
+        ShardReport getMergedReport() const;
+        int getPinnedShards() const { return pinnedshards_; }
+
+    private:
+        struct Shard {
+            const Field* field;
+            std::unique_ptr<ControlCenter> controlcenter;
+            std::thread analyzer;
+        };
+        std::vector<std::unique_ptr<Shard>> shards_;
+        bool started_;
+        int pinnedshards_;
+        bool validShard(int shard) const { return shard >= 0 && shard < getShardCount(); }
+        static bool pinThread(std::thread& thread, unsigned int core);
+        static void mergeLatency(ControlCenter::LaneLatency& total, const ControlCenter::LaneLatency& shard);
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "patrolscheduler.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+// Costruttore: il pattugliamento parte inattivo e viene avviato con start
+PatrolScheduler::PatrolScheduler()
+    : width_{0},
+    budget_{0},
+    visits_{0},
+    inflight_{0},
+    queued_{0},
+    active_{false}
+    {}
+
+// Funzione che avvia il pattugliamento delle celle indicate con un budget massimo di visite.
+// Le celle mai visitate partono con una gravità intermedia e come se fossero state visitate un orizzonte di gravità prima dell'avvio.
+void PatrolScheduler::start(int length, int width, const std::vector<std::pair<int, int>>& cells, std::size_t budget, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::size_t size {static_cast<std::size_t>(length) * width};
+    width_ = width;
+    budget_ = budget;
+    visits_ = 0;
+    inflight_ = 0;
+    queued_ = 0;
+    epoch_ = now;
+    queue_ = std::priority_queue<Entry>();
+    severity_.assign(size, UnknownSeverity);
+    lastvisit_.assign(size, -SeverityHorizon);
+    version_.assign(size, 0);
+    patrolled_.assign(size, false);
+    claimed_.assign(size, false);
+    for (const auto& cell : cells) {
+        if (cell.first < 0 || cell.first >= length || cell.second < 0 || cell.second >= width) {
+            std::cerr << "Patrol cell (" << cell.first << ", " << cell.second << ") is out of field and is ignored." << std::endl;
+            continue;
+        }
+        int index {cell.first * width + cell.second};
+        if (!patrolled_[index]) {
+            patrolled_[index] = true;
+            push(index);
+        }
+    }
+    active_ = true;
+}
+
+// Funzione che ferma il pattugliamento: le richieste successive dei veicoli, anche quelle in attesa, non ricevono più celle
+void PatrolScheduler::stop() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    active_ = false;
+    changed_.notify_all();
+}
+
+// Funzione che indica se il pattugliamento è attivo e il budget non è esaurito
+bool PatrolScheduler::isActive() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return active_ && visits_ < budget_;
+}
+
+// Funzione che sceglie la prossima cella per un veicolo libero in posizione (x, y) con la velocità indicata, senza attendere.
+// Restituisce Visit e la cella scelta, Wait se le celle libere sono finite o il budget potrebbe esaurirsi con le visite in corso,
+// Exhausted se il pattugliamento è fermo, il budget è esaurito o non restano celle da pattugliare.
+PatrolScheduler::Dispatch PatrolScheduler::dispatch(int x, int y, double speed, Clock::time_point now, std::pair<int, int>& cell) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return tryDispatch(x, y, speed, now, cell);
+}
+
+// Funzione che sceglie la prossima cella per un veicolo come dispatch, ma finché l'esito è Wait attende che una visita in corso termini
+PatrolScheduler::Dispatch PatrolScheduler::waitForDispatch(int x, int y, double speed, std::pair<int, int>& cell) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    Dispatch result {tryDispatch(x, y, speed, Clock::now(), cell)};
+    while (result == Dispatch::Wait) {
+        changed_.wait(lock);
+        result = tryDispatch(x, y, speed, Clock::now(), cell);
+    }
+    return result;
+}
+
+// Funzione privata che sceglie la prossima cella per un veicolo: va chiamata con il mutex acquisito
+PatrolScheduler::Dispatch PatrolScheduler::tryDispatch(int x, int y, double speed, Clock::time_point now, std::pair<int, int>& cell) {
+    if (!active_ || visits_ >= budget_) {
+        return Dispatch::Exhausted;
+    }
+    if (visits_ + inflight_ >= budget_) {
+        return Dispatch::Wait; // Se una visita in corso fallisce, il budget non è ancora esaurito
+    }
+    // Estrazione delle prime celle valide: le voci obsolete vengono scartate
+    std::vector<Entry> candidates;
+    while (!queue_.empty() && candidates.size() < Candidates) {
+        Entry entry {queue_.top()};
+        queue_.pop();
+        if (entry.version == version_[entry.cell] && !claimed_[entry.cell]) {
+            candidates.push_back(entry);
+        }
+    }
+    if (candidates.empty()) {
+        return inflight_ > 0 ? Dispatch::Wait : Dispatch::Exhausted;
+    }
+    double current {seconds(now)};
+    double travelspeed {speed > 0 ? speed : 1.0};
+    std::size_t best {0};
+    double bestValue {0.0};
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        int cx {candidates[i].cell / width_};
+        int cy {candidates[i].cell % width_};
+        double travel {std::max(std::abs(cx - x), std::abs(cy - y)) / travelspeed};
+        double value {candidates[i].key + current - travel};
+        if (i == 0 || value > bestValue) {
+            best = i;
+            bestValue = value;
+        }
+    }
+    // Le celle non scelte tornano in coda con la stessa chiave
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (i != best) {
+            queue_.push(candidates[i]);
+        }
+    }
+    int chosen {candidates[best].cell};
+    claimed_[chosen] = true;
+    --queued_;
+    ++inflight_;
+    cell = {chosen / width_, chosen % width_};
+    return Dispatch::Visit;
+}
+
+// Funzione chiamata all'analisi di una cella: aggiorna gravità e istante dell'ultima visita e rimette la cella in coda.
+// Se la cella era assegnata a un veicolo la visita è terminata e viene contata nel budget. Le celle non pattugliate vengono ignorate.
+void PatrolScheduler::recordVisit(int x, int y, int severity, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::size_t index {cellIndex(x, y)};
+    if (index >= patrolled_.size() || !patrolled_[index]) {
+        return;
+    }
+    severity_[index] = severity;
+    lastvisit_[index] = seconds(now);
+    if (claimed_[index]) {
+        claimed_[index] = false;
+        --inflight_;
+        ++visits_;
+    } else {
+        --queued_;
+    }
+    ++version_[index]; // La voce precedente diventa obsoleta
+    push(static_cast<int>(index));
+    changed_.notify_all();
+}
+
+// Funzione chiamata quando la visita di una cella non produce un'analisi: la cella non è raggiungibile, non può essere letta o non ha più piante.
+// La cella viene liberata ed esce dal pattugliamento, senza contare nel budget: rimetterla in coda la farebbe riassegnare all'infinito.
+void PatrolScheduler::releaseCell(int x, int y) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::size_t index {cellIndex(x, y)};
+    if (index >= patrolled_.size() || !patrolled_[index]) {
+        return;
+    }
+    patrolled_[index] = false;
+    if (claimed_[index]) {
+        claimed_[index] = false;
+        --inflight_;
+    } else {
+        --queued_;
+        ++version_[index]; // La voce in coda diventa obsoleta
+    }
+    changed_.notify_all();
+}
+
+// Funzione che restituisce il numero di visite analizzate dall'avvio del pattugliamento
+std::size_t PatrolScheduler::getVisits() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return visits_;
+}
+
+// Funzione che restituisce il numero di celle in coda, cioè non assegnate a un veicolo
+std::size_t PatrolScheduler::getQueuedCells() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return queued_;
+}
+
+// Funzione che restituisce la gravità dell'ultimo esito di una cella, -1 se la cella non è pattugliata
+int PatrolScheduler::getSeverity(int x, int y) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::size_t index {cellIndex(x, y)};
+    if (index >= patrolled_.size() || !patrolled_[index]) {
+        return -1;
+    }
+    return severity_[index];
+}
+
+// Funzione privata che restituisce l'indice denso di una cella, o un indice non valido se la cella è fuori dal campo pattugliato
+std::size_t PatrolScheduler::cellIndex(int x, int y) const {
+    if (width_ <= 0 || x < 0 || y < 0 || y >= width_) {
+        return patrolled_.size();
+    }
+    return static_cast<std::size_t>(x) * width_ + y;
+}
+
+// Funzione privata che converte un istante in secondi dall'avvio del pattugliamento
+double PatrolScheduler::seconds(Clock::time_point time) const {
+    return std::chrono::duration<double>(time - epoch_).count();
+}
+
+// Funzione privata che inserisce in coda la voce aggiornata di una cella
+void PatrolScheduler::push(int cell) {
+    queue_.push({severity_[cell] * SeverityHorizon - lastvisit_[cell], cell, version_[cell]});
+    ++queued_;
+}
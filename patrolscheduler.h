@@ -0,0 +1,73 @@
+// La classe "PatrolScheduler" gestisce il pattugliamento continuo del campo: decide quale cella visitare ogni volta che un veicolo si libera.
+// Il valore di una visita è espresso in secondi e cresce con la gravità dell'ultimo esito della cella e con il tempo trascorso dall'ultima visita,
+// mentre diminuisce con il tempo di viaggio del veicolo fino alla cella:
+//     valore = gravità * SeverityHorizon + (adesso - ultima visita) - distanza / velocità del veicolo
+// La parte che non dipende dal veicolo, gravità * SeverityHorizon - ultima visita, non cambia con il passare del tempo,
+// quindi le celle sono tenute in una coda di priorità ordinata su di essa senza doverla mai riordinare.
+// Alla richiesta di un veicolo vengono estratte le prime celle della coda e tra queste viene scelta quella di valore massimo tenendo conto della distanza.
+// Una cella assegnata a un veicolo esce dalla coda finché la sua lettura non viene analizzata, così che due veicoli non la visitino insieme.
+// Se la visita non produce un'analisi (la cella non è raggiungibile, non può essere letta o non ha più piante) la cella viene liberata ed esce dal pattugliamento.
+// Il pattugliamento ha un budget di visite, contate quando la visita viene analizzata: esaurito il budget, non vengono più assegnate celle.
+// Quando tutte le celle sono assegnate, o le visite in corso basterebbero a esaurire il budget, un veicolo attende che una visita termini.
+// La classe è protetta da un mutex perché viene usata sia dai thread dei veicoli sia dal thread di analisi.
+// La descrizione delle funzioni è presente nel file "patrolscheduler.cpp".
+
+#ifndef PATROLSCHEDULER_H
+#define PATROLSCHEDULER_H
+#include <vector>
+#include <queue>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+
+class PatrolScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Esito di una richiesta di un veicolo: una cella da visitare, attendere la fine di una visita in corso, pattugliamento terminato
+        enum class Dispatch {Visit, Wait, Exhausted};
+        PatrolScheduler();
+        void start(int length, int width, const std::vector<std::pair<int, int>>& cells, std::size_t budget, Clock::time_point now);
+        void stop();
+        bool isActive() const;
+        Dispatch dispatch(int x, int y, double speed, Clock::time_point now, std::pair<int, int>& cell);
+        Dispatch waitForDispatch(int x, int y, double speed, std::pair<int, int>& cell);
+        void recordVisit(int x, int y, int severity, Clock::time_point now);
+        void releaseCell(int x, int y);
+        std::size_t getVisits() const;
+        std::size_t getQueuedCells() const;
+        int getSeverity(int x, int y) const;
+
+    private:
+        static constexpr double SeverityHorizon = 60.0; // Secondi di attesa equivalenti a un livello di gravità
+        static constexpr int UnknownSeverity = 2; // Gravità attribuita alle celle mai visitate
+        static constexpr std::size_t Candidates = 8; // Celle estratte dalla coda per valutare la distanza
+        struct Entry {
+            double key;
+            int cell;
+            unsigned int version;
+            bool operator<(const Entry& other) const { return key < other.key; }
+        };
+        std::priority_queue<Entry> queue_;
+        std::vector<int> severity_; // Gravità dell'ultimo esito, per indice denso
+        std::vector<double> lastvisit_; // Istante dell'ultima visita in secondi dall'inizio del pattugliamento
+        std::vector<unsigned int> version_; // Versione della voce valida in coda: le voci con versione diversa sono obsolete
+        std::vector<bool> patrolled_; // Celle soggette a pattugliamento
+        std::vector<bool> claimed_; // Celle assegnate a un veicolo e non ancora analizzate
+        int width_;
+        std::size_t budget_;
+        std::size_t visits_; // Visite analizzate, contate nel budget
+        std::size_t inflight_; // Celle assegnate e non ancora analizzate
+        std::size_t queued_;
+        bool active_;
+        Clock::time_point epoch_;
+        mutable std::mutex mtx_;
+        std::condition_variable changed_; // Segnala la fine di una visita o l'arresto del pattugliamento ai veicoli in attesa
+        Dispatch tryDispatch(int x, int y, double speed, Clock::time_point now, std::pair<int, int>& cell);
+        std::size_t cellIndex(int x, int y) const;
+        double seconds(Clock::time_point time) const;
+        void push(int cell);
+};
+
+#endif
@@ -7,6 +7,7 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 #include <string>
+#include <cstddef>
 
 class Soil;
 
@@ -14,6 +15,7 @@ class Soil;
 class Sensor {
     public:
         enum class SensorType {MoistureSensor, SoilTemperatureSensor, HumiditySensor, AirTemperatureSensor};
+        static constexpr std::size_t SensorTypeCount = 4; // Numero di tipi di sensore: consente di indicizzare array per tipo di sensore
         Sensor();
         Sensor(SensorType type);
         float readTemperature(const Soil& soil) const;
@@ -36,17 +36,23 @@ Soil::Soil(SoilType soilType, bool plants, double soilMoisture, float airTempera
     // Funzione che calcola la temperatura del suolo in base al tipo di suolo e alle condizioni atmosferiche e di umidità
     float Soil::calculateSoilTemperature()
     {
-        switch(soiltype_)
+        return soilTemperature(soiltype_, soilmoisture_, airtemperature_, airhumidity_);
+    }
+
+    // Formula della temperatura del suolo, usabile anche da chi lavora direttamente sulle colonne del campo
+    float Soil::soilTemperature(SoilType soilType, double soilMoisture, float airTemperature, double airHumidity)
+    {
+        switch(soilType)
         {
             // Valori in gradi celsius. I pesi tengono conto di come ogni tipo di terreno sia più o meno isolante e quanto sia più o meno raffreddato se bagnato.
             case SoilType::clay: 
-                return 0.6 * airtemperature_ - 0.005 * soilmoisture_ + 0.001 * airhumidity_ + 2.0; 
+                return 0.6 * airTemperature - 0.005 * soilMoisture + 0.001 * airHumidity + 2.0; 
             case SoilType::sand:
-                return 0.8 * airtemperature_ - 0.002 * soilmoisture_ + 0.0005 * airhumidity_ + 3.0;
+                return 0.8 * airTemperature - 0.002 * soilMoisture + 0.0005 * airHumidity + 3.0;
             case SoilType::loam:
-                return 0.7 * airtemperature_ - 0.003 * soilmoisture_ + 0.0015 * airhumidity_ + 2.5;
+                return 0.7 * airTemperature - 0.003 * soilMoisture + 0.0015 * airHumidity + 2.5;
             case SoilType::silt:
-                return 0.65 * airtemperature_ - 0.0025 * soilmoisture_ + 0.0015 * airhumidity_ + 2.0;
+                return 0.65 * airTemperature - 0.0025 * soilMoisture + 0.0015 * airHumidity + 2.0;
             default:
                 cerr << "Invalid soil type." << endl;
                 exit(EXIT_FAILURE);
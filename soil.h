@@ -31,12 +31,14 @@ class Soil {
         SoilType getSoilType() const {return soiltype_;}
         bool getPlants() const {return plants_;}
         static std::string soilTypeToString(SoilType soilType);
+        static float soilTemperature(SoilType soilType, double soilMoisture, float airTemperature, double airHumidity);
         float PassTemperatureToSensor(SensorType sensorType) const;
         double PassSoilMoistureToSensor(SensorType sensorType) const;
         double PassAirHumidityToSensor(SensorType sensorType) const;
     
 
     private:
+        friend class Field; // Il campo memorizza le celle per colonne e le ricompone senza ricalcolare la temperatura del suolo
         SoilType soiltype_;
         bool plants_;
         double soilmoisture_;
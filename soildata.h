@@ -0,0 +1,16 @@
+// La struttura "SoilData" rappresenta la singola lettura effettuata da un sensore di un veicolo su una cella del campo.
+// È stata separata dal file "controlcenter.h" perché viene usata sia dai veicoli, che accumulano le letture in attesa dell'invio, sia dal control center che le analizza.
+// Un "batch" di dati è un vettore di SoilData che può contenere le letture di più celle: le letture di una stessa cella sono sempre contigue.
+
+#ifndef SOILDATA_H
+#define SOILDATA_H
+#include "sensor.h"
+
+struct SoilData {
+    int x;
+    int y;
+    Sensor::SensorType type;
+    double data; 
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "surveyplanner.h"
+#include "controlcenter.h"
+#include "sensor.h"
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+// Costruttore: la presenza di piante viene letta una sola volta per tutto il campo
+SurveyPlanner::SurveyPlanner(const Field& field, int coarsestride)
+    : field_{field},
+    coarsestride_{coarsestride},
+    length_{field.getLength()},
+    width_{field.getWidth()},
+    phase_{0},
+    visitedcells_{0},
+    plantcells_{0},
+    refinedblocks_{0},
+    plants_(static_cast<std::size_t>(field.getLength()) * field.getWidth(), false),
+    visited_(static_cast<std::size_t>(field.getLength()) * field.getWidth(), false),
+    representative_(static_cast<std::size_t>(field.getLength()) * field.getWidth(), -1)
+    {
+        if (coarsestride <= 0) {
+            std::cerr << "Invalid survey stride: it must be greater than 0." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        field.viewPlants(0, length_ - 1, 0, width_ - 1).forEach([this](int x, int y, bool plants) {
+            if (plants) {
+                plants_[cellIndex(x, y)] = true;
+                ++plantcells_;
+            }
+        });
+    }
+
+// Funzione che restituisce le celle da visitare nella prima fase: una cella rappresentativa per ogni blocco iniziale che contiene piante
+std::vector<std::pair<int, int>> SurveyPlanner::initialCells() {
+    phase_ = 1;
+    blocks_.clear();
+    std::fill(visited_.begin(), visited_.end(), false);
+    std::fill(representative_.begin(), representative_.end(), -1);
+    visitedcells_ = 0;
+    refinedblocks_ = 0;
+    for (int x = 0; x < length_; x += coarsestride_) {
+        for (int y = 0; y < width_; y += coarsestride_) {
+            Block block;
+            if (makeBlock(x, y, std::min(x + coarsestride_, length_), std::min(y + coarsestride_, width_), -1, block)) {
+                blocks_.push_back(block);
+            }
+        }
+    }
+    return collectVisits(blocks_);
+}
+
+// Funzione che, in base alle letture analizzate dal control center, divide i blocchi da raffinare e restituisce le celle da visitare nella fase successiva.
+// Restituisce un vettore vuoto quando nessun blocco deve essere raffinato: il rilevamento è terminato.
+std::vector<std::pair<int, int>> SurveyPlanner::refine(const ControlCenter& controlCenter) {
+    std::vector<Block> next;
+    for (const Block& block : blocks_) {
+        if ((block.endx - block.x <= 1 && block.endy - block.y <= 1) || !needsRefinement(block, controlCenter)) {
+            continue;
+        }
+        ++refinedblocks_;
+        // Il blocco viene diviso a metà su entrambi i lati; il sotto-blocco che contiene la cella già visitata la mantiene come rappresentativa
+        int midx {block.x + (block.endx - block.x + 1) / 2};
+        int midy {block.y + (block.endy - block.y + 1) / 2};
+        const int xs[3] = {block.x, midx, block.endx};
+        const int ys[3] = {block.y, midy, block.endy};
+        for (int i = 0; i < 2; ++i) {
+            for (int j = 0; j < 2; ++j) {
+                Block sub;
+                if (xs[i] < xs[i + 1] && ys[j] < ys[j + 1] && makeBlock(xs[i], ys[j], xs[i + 1], ys[j + 1], block.representative, sub)) {
+                    next.push_back(sub);
+                }
+            }
+        }
+    }
+    blocks_ = std::move(next);
+    if (blocks_.empty()) {
+        return {};
+    }
+    ++phase_;
+    return collectVisits(blocks_);
+}
+
+// Funzione che restituisce la cella visitata che rappresenta una cella con piante, (-1, -1) se la cella non è ancora rappresentata
+std::pair<int, int> SurveyPlanner::getRepresentative(int x, int y) const {
+    if (x < 0 || x >= length_ || y < 0 || y >= width_ || representative_[cellIndex(x, y)] < 0) {
+        return {-1, -1};
+    }
+    int cell {representative_[cellIndex(x, y)]};
+    return {cell / width_, cell % width_};
+}
+
+// Funzione privata che costruisce un blocco: restituisce false se il blocco non contiene piante.
+// La cella rappresentativa è quella preferita, se appartiene al blocco, altrimenti la cella con piante più vicina al centro del blocco.
+bool SurveyPlanner::makeBlock(int x, int y, int endx, int endy, int preferred, Block& block) const {
+    block = {x, y, endx, endy, -1};
+    double centerx {(x + endx - 1) / 2.0};
+    double centery {(y + endy - 1) / 2.0};
+    double bestDistance {0.0};
+    for (int i = x; i < endx; ++i) {
+        for (int j = y; j < endy; ++j) {
+            int cell {cellIndex(i, j)};
+            if (!plants_[cell]) {
+                continue;
+            }
+            if (cell == preferred) {
+                block.representative = cell;
+                return true;
+            }
+            double distance {std::max(std::abs(i - centerx), std::abs(j - centery))};
+            if (block.representative < 0 || distance < bestDistance) {
+                block.representative = cell;
+                bestDistance = distance;
+            }
+        }
+    }
+    return block.representative >= 0;
+}
+
+// Funzione privata che assegna la cella rappresentativa del blocco a tutte le sue celle con piante
+void SurveyPlanner::assignBlock(const Block& block) {
+    for (int i = block.x; i < block.endx; ++i) {
+        for (int j = block.y; j < block.endy; ++j) {
+            if (plants_[cellIndex(i, j)]) {
+                representative_[cellIndex(i, j)] = block.representative;
+            }
+        }
+    }
+}
+
+// Funzione privata che decide se un blocco deve essere raffinato, secondo i criteri descritti in "surveyplanner.h"
+bool SurveyPlanner::needsRefinement(const Block& block, const ControlCenter& controlCenter) const {
+    if (hasMixedSoil(block)) {
+        return true;
+    }
+    int rx {block.representative / width_};
+    int ry {block.representative % width_};
+    Soil::SoilType soilType;
+    if (!field_.getSoilType(rx, ry, soilType)) {
+        return true;
+    }
+    // Medie delle letture di una cella per ogni tipo di sensore; false se la cella non ha letture per qualche sensore
+    auto readMeans = [&controlCenter](int x, int y, std::array<double, Sensor::SensorTypeCount>& means) {
+        for (std::size_t type = 0; type < Sensor::SensorTypeCount; ++type) {
+            SensorStatistics stats = controlCenter.getCellStatistics(x, y, static_cast<Sensor::SensorType>(type));
+            if (stats.count == 0) {
+                return false;
+            }
+            means[type] = stats.mean;
+        }
+        return true;
+    };
+    std::array<double, Sensor::SensorTypeCount> means;
+    if (!readMeans(rx, ry, means)) {
+        return true;
+    }
+    for (std::size_t type = 0; type < Sensor::SensorTypeCount; ++type) {
+        ControlCenter::Verdict verdict {ControlCenter::classifyValue(soilType, static_cast<Sensor::SensorType>(type), means[type])};
+        if (verdict == ControlCenter::Verdict::CriticalLow || verdict == ControlCenter::Verdict::CriticalHigh) {
+            return true;
+        }
+    }
+
+    // Gradiente: confronto con le celle rappresentative dei blocchi adiacenti, trovate sull'anello di celle che circonda il blocco
+    std::vector<int> compared;
+    for (int i = std::max(block.x - 1, 0); i <= std::min(block.endx, length_ - 1); ++i) {
+        for (int j = std::max(block.y - 1, 0); j <= std::min(block.endy, width_ - 1); ++j) {
+            bool inside {i >= block.x && i < block.endx && j >= block.y && j < block.endy};
+            int neighbour {inside ? -1 : representative_[cellIndex(i, j)]};
+            if (neighbour < 0 || neighbour == block.representative || std::find(compared.begin(), compared.end(), neighbour) != compared.end()) {
+                continue;
+            }
+            compared.push_back(neighbour);
+            std::array<double, Sensor::SensorTypeCount> neighbourMeans;
+            if (!readMeans(neighbour / width_, neighbour % width_, neighbourMeans)) {
+                continue;
+            }
+            for (std::size_t type = 0; type < Sensor::SensorTypeCount; ++type) {
+                const ControlCenter::Thresholds& thresholds = ControlCenter::getThresholds(soilType, static_cast<Sensor::SensorType>(type));
+                if (std::abs(means[type] - neighbourMeans[type]) > (thresholds.optimalmax - thresholds.optimalmin) / 2.0) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Funzione privata che verifica se le piante di un blocco crescono su tipi di suolo diversi, usando la struttura per regioni del campo
+bool SurveyPlanner::hasMixedSoil(const Block& block) const {
+    Field::SoilTypeView soilTypes {field_.viewSoilTypes(block.x, block.endx - 1, block.y, block.endy - 1)};
+    bool found {false};
+    Soil::SoilType first {Soil::SoilType::clay};
+    for (int i = block.x; i < block.endx; ++i) {
+        for (int j = block.y; j < block.endy; ++j) {
+            if (!plants_[cellIndex(i, j)]) {
+                continue;
+            }
+            Soil::SoilType soilType {soilTypes(i - block.x, j - block.y)};
+            if (!found) {
+                first = soilType;
+                found = true;
+            } else if (soilType != first) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Funzione privata che aggiorna le celle rappresentative e restituisce le celle dei blocchi non ancora visitate
+std::vector<std::pair<int, int>> SurveyPlanner::collectVisits(const std::vector<Block>& blocks) {
+    std::vector<std::pair<int, int>> cells;
+    for (const Block& block : blocks) {
+        assignBlock(block);
+        if (!visited_[block.representative]) {
+            visited_[block.representative] = true;
+            ++visitedcells_;
+            cells.emplace_back(block.representative / width_, block.representative % width_);
+        }
+    }
+    std::cout << "Debug: Survey phase " << phase_ << " - " << blocks.size() << " blocks, " << cells.size() << " new cells to visit" << std::endl;
+    return cells;
+}
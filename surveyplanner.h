@@ -0,0 +1,61 @@
+// La classe "SurveyPlanner" pianifica un rilevamento adattivo del campo a più risoluzioni.
+// Invece di visitare ogni cella con piante, il campo viene diviso in blocchi quadrati e in ogni blocco viene visitata una sola cella rappresentativa.
+// Dopo ogni fase il planner decide, blocco per blocco, se la cella rappresentativa basta a descrivere il blocco oppure se il blocco va diviso in quattro
+// sotto-blocchi da rilevare nella fase successiva. Un blocco viene raffinato se:
+// - contiene piante su tipi di suolo diversi (le soglie di valutazione dipendono dal tipo di suolo, quindi una sola lettura non basta);
+// - la sua cella rappresentativa ha dato un esito critico per almeno un sensore;
+// - la differenza tra le sue medie e quelle di un blocco adiacente supera metà dell'intervallo ottimale (forte gradiente);
+// - non ci sono ancora letture per la sua cella rappresentativa.
+// Su campi uniformi le visite si riducono di circa un fattore pari all'area dei blocchi iniziali, mentre le zone critiche vengono rilevate fino alla singola cella.
+// La descrizione delle funzioni è presente nel file "surveyplanner.cpp".
+
+#ifndef SURVEYPLANNER_H
+#define SURVEYPLANNER_H
+#include "field.h"
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+class ControlCenter;
+
+class SurveyPlanner {
+    public:
+        SurveyPlanner(const Field& field, int coarsestride);
+        std::vector<std::pair<int, int>> initialCells();
+        std::vector<std::pair<int, int>> refine(const ControlCenter& controlCenter);
+        std::pair<int, int> getRepresentative(int x, int y) const;
+        int getPhase() const { return phase_; }
+        std::size_t getVisitedCells() const { return visitedcells_; }
+        std::size_t getPlantCells() const { return plantcells_; }
+        std::size_t getRefinedBlocks() const { return refinedblocks_; }
+
+    private:
+        // Blocco rettangolare [x, endx) x [y, endy) e la sua cella rappresentativa (indice denso)
+        struct Block {
+            int x;
+            int y;
+            int endx;
+            int endy;
+            int representative;
+        };
+        const Field& field_;
+        int coarsestride_;
+        int length_;
+        int width_;
+        int phase_;
+        std::size_t visitedcells_;
+        std::size_t plantcells_;
+        std::size_t refinedblocks_;
+        std::vector<bool> plants_; // Presenza di piante, per indice denso
+        std::vector<bool> visited_; // Celle già visitate in una fase precedente
+        std::vector<int> representative_; // Cella visitata che rappresenta ogni cella con piante, -1 se non ancora assegnata
+        std::vector<Block> blocks_; // Blocchi rilevati nell'ultima fase
+        int cellIndex(int x, int y) const { return x * width_ + y; }
+        bool makeBlock(int x, int y, int endx, int endy, int preferred, Block& block) const;
+        void assignBlock(const Block& block);
+        bool needsRefinement(const Block& block, const ControlCenter& controlCenter) const;
+        bool hasMixedSoil(const Block& block) const;
+        std::vector<std::pair<int, int>> collectVisits(const std::vector<Block>& blocks);
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "telemetry.h"
+
+static_assert((TelemetryRing::Capacity & (TelemetryRing::Capacity - 1)) == 0, "TelemetryRing capacity must be a power of two");
+
+// Funzione per convertire lo stato di un veicolo in una stringa ai fini di stampa a video
+const char* TelemetrySample::stateToString(State state) {
+    switch (state) {
+        case State::Idle: return "Idle";
+        case State::Moving: return "Moving";
+        case State::Returning: return "Returning";
+        case State::Recharging: return "Recharging";
+        case State::Reading: return "Reading";
+        default: return "Unknown";
+    }
+}
+
+// Costruttore: buffer vuoto
+TelemetryRing::TelemetryRing()
+    : samples_{},
+    head_{0},
+    tail_{0},
+    dropped_{0}
+    {}
+
+// Funzione usata dal veicolo per pubblicare un campione: non si blocca mai. Se il buffer è pieno il campione viene scartato e si restituisce false.
+bool TelemetryRing::publish(const TelemetrySample& sample) {
+    std::size_t head {head_.load(std::memory_order_relaxed)};
+    std::size_t tail {tail_.load(std::memory_order_acquire)};
+    if (head - tail >= Capacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    samples_[head & (Capacity - 1)] = sample;
+    head_.store(head + 1, std::memory_order_release); // Il campione diventa visibile al consumatore solo dopo essere stato scritto
+    return true;
+}
+
+// Funzione usata dal thread di monitoraggio per leggere il campione più vecchio: restituisce false se non ci sono campioni.
+bool TelemetryRing::consume(TelemetrySample& sample) {
+    std::size_t tail {tail_.load(std::memory_order_relaxed)};
+    std::size_t head {head_.load(std::memory_order_acquire)};
+    if (tail == head) {
+        return false;
+    }
+    sample = samples_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release); // La posizione letta torna disponibile al produttore
+    return true;
+}
+
+// Funzione che legge tutti i campioni disponibili e li accoda al vettore passato: restituisce il numero di campioni letti.
+std::size_t TelemetryRing::drain(std::vector<TelemetrySample>& samples) {
+    std::size_t tail {tail_.load(std::memory_order_relaxed)};
+    std::size_t head {head_.load(std::memory_order_acquire)};
+    for (std::size_t index = tail; index != head; ++index) {
+        samples.push_back(samples_[index & (Capacity - 1)]);
+    }
+    tail_.store(head, std::memory_order_release);
+    return head - tail;
+}
@@ -0,0 +1,42 @@
+// Il file definisce la telemetria dei veicoli: ogni veicolo pubblica dei campioni (istante, posizione, batteria, stato) in un buffer circolare proprio.
+// Il buffer "TelemetryRing" è lock-free a singolo produttore e singolo consumatore: il veicolo scrive senza mai bloccarsi
+// (se il buffer è pieno il campione viene scartato e contato), mentre un solo thread di monitoraggio alla volta legge i campioni.
+// In questo modo un cruscotto in tempo reale può seguire la flotta senza rallentare i veicoli.
+// La descrizione delle funzioni è presente nel file "telemetry.cpp".
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstddef>
+
+struct TelemetrySample {
+    enum class State {Idle, Moving, Returning, Recharging, Reading};
+    std::chrono::steady_clock::time_point timestamp;
+    int vehicleid;
+    int x;
+    int y;
+    float battery;
+    State state;
+    static const char* stateToString(State state);
+};
+
+class TelemetryRing {
+    public:
+        static constexpr std::size_t Capacity = 256; // Deve essere una potenza di 2 per calcolare gli indici con una maschera
+        TelemetryRing();
+        bool publish(const TelemetrySample& sample);
+        bool consume(TelemetrySample& sample);
+        std::size_t drain(std::vector<TelemetrySample>& samples);
+        std::size_t getDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        std::array<TelemetrySample, Capacity> samples_;
+        alignas(64) std::atomic<std::size_t> head_; // Prossima posizione da scrivere: modificata solo dal produttore
+        alignas(64) std::atomic<std::size_t> tail_; // Prossima posizione da leggere: modificata solo dal consumatore
+        std::atomic<std::size_t> dropped_;
+};
+
+#endif
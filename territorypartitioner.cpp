@@ -0,0 +1,251 @@
+#include "territorypartitioner.h"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <limits>
+
+// Costruttore di default: l'unica stazione di ricarica è la base in (0, 0), come per i veicoli
+TerritoryPartitioner::TerritoryPartitioner()
+    : TerritoryPartitioner(std::vector<std::pair<int, int>>{{0, 0}})
+    {}
+
+// Costruttore con un elenco di stazioni di ricarica
+TerritoryPartitioner::TerritoryPartitioner(const std::vector<std::pair<int, int>>& stations)
+    : stations_{stations},
+    rebalances_{0}
+    {
+        if (stations_.empty()) {
+            std::cerr << "Invalid stations: at least one charging station is required." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+// Funzione per suddividere le celle tra i veicoli: sostituisce gli eventuali territori calcolati in precedenza
+void TerritoryPartitioner::partition(const std::vector<std::pair<int, int>>& cells, const std::vector<VehicleProfile>& vehicles) {
+    if (vehicles.empty()) {
+        std::cerr << "Invalid fleet: at least one vehicle is required to partition the field." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (const auto& vehicle : vehicles) {
+        if (vehicle.speed <= 0) {
+            std::cerr << "Invalid speed: speed must be greater than 0." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    vehicles_ = vehicles;
+    territories_.assign(vehicles.size(), std::deque<std::pair<int, int>>());
+    rebalances_ = 0;
+    std::vector<std::pair<int, int>> sorted(cells);
+    std::vector<int> order(vehicles.size());
+    std::iota(order.begin(), order.end(), 0);
+    bisect(sorted, 0, sorted.size(), order, 0, order.size());
+    for (int vehicle = 0; vehicle < static_cast<int>(vehicles_.size()); ++vehicle) {
+        orderTerritory(vehicle);
+    }
+}
+
+// Funzione per ottenere la prossima cella da leggere per un veicolo, che comunica la propria posizione attuale.
+// Se il territorio del veicolo è esaurito, il veicolo prende parte del lavoro rimasto al veicolo più in ritardo.
+// Restituisce false quando non c'è più alcuna cella da leggere.
+bool TerritoryPartitioner::nextCell(int vehicle, int x, int y, std::pair<int, int>& cell) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (vehicle < 0 || vehicle >= static_cast<int>(territories_.size())) {
+        std::cerr << "Invalid vehicle index: " << vehicle << std::endl;
+        return false;
+    }
+    if (territories_[vehicle].empty() && !stealWork(vehicle, x, y)) {
+        return false;
+    }
+    cell = territories_[vehicle].front();
+    territories_[vehicle].pop_front();
+    return true;
+}
+
+// Funzione per ottenere le celle ancora da leggere nel territorio di un veicolo, nell'ordine di visita
+std::vector<std::pair<int, int>> TerritoryPartitioner::getTerritory(int vehicle) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (vehicle < 0 || vehicle >= static_cast<int>(territories_.size())) {
+        return {};
+    }
+    return std::vector<std::pair<int, int>>(territories_[vehicle].begin(), territories_[vehicle].end());
+}
+
+// Funzione per ottenere il numero di celle ancora da leggere nel territorio di un veicolo
+std::size_t TerritoryPartitioner::getRemaining(int vehicle) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (vehicle < 0 || vehicle >= static_cast<int>(territories_.size())) {
+        return 0;
+    }
+    return territories_[vehicle].size();
+}
+
+// Funzione per ottenere il numero di ribilanciamenti eseguiti durante la missione
+std::size_t TerritoryPartitioner::getRebalances() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return rebalances_;
+}
+
+// Funzione per ottenere il numero di veicoli tra cui è stato suddiviso il campo
+int TerritoryPartitioner::getVehicleCount() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return static_cast<int>(vehicles_.size());
+}
+
+// Funzione che restituisce il carico di lavoro di una cella: una unità per la lettura più la quota dei viaggi di ricarica,
+// proporzionale alla distanza dalla stazione più vicina rispetto all'autonomia di una batteria piena
+double TerritoryPartitioner::getCellWeight(int x, int y) const {
+    return 1.0 + stationDistance(x, y) / RangeCells;
+}
+
+// Funzione che calcola la lunghezza in celle di un percorso a partire da una posizione, con la stessa distanza usata dai veicoli
+int TerritoryPartitioner::routeLength(int startx, int starty, const std::vector<std::pair<int, int>>& route) {
+    int length {0};
+    int x {startx};
+    int y {starty};
+    for (const auto& cell : route) {
+        length += std::max(std::abs(cell.first - x), std::abs(cell.second - y));
+        x = cell.first;
+        y = cell.second;
+    }
+    return length;
+}
+
+// Funzione privata che restituisce la distanza di una cella dalla stazione di ricarica più vicina
+int TerritoryPartitioner::stationDistance(int x, int y) const {
+    int best {std::numeric_limits<int>::max()};
+    for (const auto& station : stations_) {
+        best = std::min(best, std::max(std::abs(station.first - x), std::abs(station.second - y)));
+    }
+    return best;
+}
+
+// Funzione privata di bisezione ricorsiva: le celle [begin, end) vengono divise tra i veicoli [vbegin, vend) di "vehicles".
+// Celle e veicoli vengono ordinati lungo lo stesso asse, così che la metà inferiore delle celle vada ai veicoli che partono più vicino ad essa.
+void TerritoryPartitioner::bisect(std::vector<std::pair<int, int>>& cells, std::size_t begin, std::size_t end, std::vector<int>& vehicles, std::size_t vbegin, std::size_t vend) {
+    if (vend - vbegin == 1) {
+        territories_[vehicles[vbegin]].assign(cells.begin() + begin, cells.begin() + end);
+        return;
+    }
+    if (begin == end) {
+        return;
+    }
+    // Asse di taglio: il lato più lungo del rettangolo che contiene le celle
+    int minx {cells[begin].first}, maxx {cells[begin].first};
+    int miny {cells[begin].second}, maxy {cells[begin].second};
+    for (std::size_t i = begin; i < end; ++i) {
+        minx = std::min(minx, cells[i].first);
+        maxx = std::max(maxx, cells[i].first);
+        miny = std::min(miny, cells[i].second);
+        maxy = std::max(maxy, cells[i].second);
+    }
+    bool alongx {maxx - minx >= maxy - miny};
+    auto key = [alongx](int x, int y) { return alongx ? std::make_pair(x, y) : std::make_pair(y, x); };
+    std::sort(cells.begin() + begin, cells.begin() + end, [&key](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return key(a.first, a.second) < key(b.first, b.second);
+    });
+    std::sort(vehicles.begin() + vbegin, vehicles.begin() + vend, [this, &key](int a, int b) {
+        return key(vehicles_[a].x, vehicles_[a].y) < key(vehicles_[b].x, vehicles_[b].y);
+    });
+
+    // Il carico della prima metà deve essere proporzionale alla velocità complessiva dei veicoli a cui sarà assegnata
+    std::size_t vmiddle {vbegin + (vend - vbegin) / 2};
+    double lowerSpeed {0.0};
+    double totalSpeed {0.0};
+    for (std::size_t v = vbegin; v < vend; ++v) {
+        totalSpeed += vehicles_[vehicles[v]].speed;
+        if (v < vmiddle) {
+            lowerSpeed += vehicles_[vehicles[v]].speed;
+        }
+    }
+    double totalWeight {0.0};
+    for (std::size_t i = begin; i < end; ++i) {
+        totalWeight += getCellWeight(cells[i].first, cells[i].second);
+    }
+    double target {totalWeight * lowerSpeed / totalSpeed};
+    std::size_t middle {begin};
+    double cumulative {0.0};
+    while (middle < end) {
+        double weight {getCellWeight(cells[middle].first, cells[middle].second)};
+        // Il taglio cade prima della cella che porterebbe il carico più lontano dall'obiettivo
+        if (cumulative + weight - target > target - cumulative) {
+            break;
+        }
+        cumulative += weight;
+        ++middle;
+    }
+    bisect(cells, begin, middle, vehicles, vbegin, vmiddle);
+    bisect(cells, middle, end, vehicles, vmiddle, vend);
+}
+
+// Funzione privata che ordina a serpentina le celle di un territorio: le righe vengono percorse alternando la direzione,
+// e il percorso parte dall'estremo più vicino alla posizione di partenza del veicolo
+void TerritoryPartitioner::orderTerritory(int vehicle) {
+    std::deque<std::pair<int, int>>& territory = territories_[vehicle];
+    if (territory.empty()) {
+        return;
+    }
+    std::sort(territory.begin(), territory.end());
+    std::size_t rowbegin {0};
+    bool reversed {false};
+    while (rowbegin < territory.size()) {
+        std::size_t rowend {rowbegin};
+        while (rowend < territory.size() && territory[rowend].first == territory[rowbegin].first) {
+            ++rowend;
+        }
+        if (reversed) {
+            std::reverse(territory.begin() + rowbegin, territory.begin() + rowend);
+        }
+        reversed = !reversed;
+        rowbegin = rowend;
+    }
+    const VehicleProfile& profile = vehicles_[vehicle];
+    int toFront {std::max(std::abs(territory.front().first - profile.x), std::abs(territory.front().second - profile.y))};
+    int toBack {std::max(std::abs(territory.back().first - profile.x), std::abs(territory.back().second - profile.y))};
+    if (toBack < toFront) {
+        std::reverse(territory.begin(), territory.end());
+    }
+}
+
+// Funzione privata che stima il lavoro rimasto a un veicolo: carico delle celle ancora da leggere diviso per la sua velocità
+double TerritoryPartitioner::remainingWork(int vehicle) const {
+    double work {0.0};
+    for (const auto& cell : territories_[vehicle]) {
+        work += getCellWeight(cell.first, cell.second);
+    }
+    return work / vehicles_[vehicle].speed;
+}
+
+// Funzione privata di ribilanciamento: il veicolo rimasto senza celle prende la metà finale del percorso del veicolo con più lavoro rimasto.
+// La parte finale di una serpentina è un blocco compatto, quindi i due territori restano separati.
+bool TerritoryPartitioner::stealWork(int vehicle, int x, int y) {
+    int victim {-1};
+    double mostWork {0.0};
+    for (int other = 0; other < static_cast<int>(territories_.size()); ++other) {
+        if (other == vehicle || territories_[other].size() < 2) {
+            continue;
+        }
+        double work {remainingWork(other)};
+        if (work > mostWork) {
+            mostWork = work;
+            victim = other;
+        }
+    }
+    if (victim < 0) {
+        return false;
+    }
+    std::deque<std::pair<int, int>>& source = territories_[victim];
+    std::size_t taken {source.size() / 2};
+    std::deque<std::pair<int, int>>& territory = territories_[vehicle];
+    territory.assign(source.end() - taken, source.end());
+    source.erase(source.end() - taken, source.end());
+    int toFront {std::max(std::abs(territory.front().first - x), std::abs(territory.front().second - y))};
+    int toBack {std::max(std::abs(territory.back().first - x), std::abs(territory.back().second - y))};
+    if (toBack < toFront) {
+        std::reverse(territory.begin(), territory.end());
+    }
+    ++rebalances_;
+    std::cout << "Debug: Vehicle " << vehicle << " takes " << taken << " cells from vehicle " << victim << std::endl;
+    return true;
+}
@@ -0,0 +1,51 @@
+// La classe "TerritoryPartitioner" divide le celle con piante tra i veicoli della flotta, assegnando a ciascuno un territorio compatto.
+// Le celle vengono suddivise per bisezione ricorsiva: ad ogni passo l'insieme di celle viene tagliato lungo il lato più lungo del suo rettangolo di ingombro,
+// e il taglio è posizionato in modo che ogni metà abbia un carico di lavoro proporzionale alla velocità dei veicoli a cui verrà assegnata.
+// Il carico di una cella comprende la lettura e una quota dei viaggi di ricarica, che cresce con la distanza dalla stazione di ricarica più vicina.
+// All'interno di ogni territorio le celle sono ordinate a serpentina, partendo dal lato più vicino al veicolo.
+// Durante la missione i veicoli prelevano le celle dal proprio territorio; un veicolo che ha terminato prende la parte finale del percorso
+// del veicolo più in ritardo, così che la flotta resti bilanciata anche se un veicolo rallenta (ad esempio per le ricariche).
+// La descrizione delle funzioni è presente nel file "territorypartitioner.cpp".
+
+#ifndef TERRITORYPARTITIONER_H
+#define TERRITORYPARTITIONER_H
+#include <vector>
+#include <deque>
+#include <utility>
+#include <mutex>
+#include <cstddef>
+
+class TerritoryPartitioner {
+    public:
+        // Dati di un veicolo necessari alla suddivisione: posizione di partenza e velocità in celle al secondo
+        struct VehicleProfile {
+            int x;
+            int y;
+            double speed;
+        };
+        TerritoryPartitioner();
+        TerritoryPartitioner(const std::vector<std::pair<int, int>>& stations);
+        void partition(const std::vector<std::pair<int, int>>& cells, const std::vector<VehicleProfile>& vehicles);
+        bool nextCell(int vehicle, int x, int y, std::pair<int, int>& cell);
+        std::vector<std::pair<int, int>> getTerritory(int vehicle) const;
+        std::size_t getRemaining(int vehicle) const;
+        std::size_t getRebalances() const;
+        int getVehicleCount() const;
+        double getCellWeight(int x, int y) const;
+        static int routeLength(int startx, int starty, const std::vector<std::pair<int, int>>& route);
+
+    private:
+        static constexpr double RangeCells = 18.0; // Celle percorribili con una batteria piena prima di dover tornare a una stazione
+        std::vector<std::pair<int, int>> stations_;
+        std::vector<VehicleProfile> vehicles_;
+        std::vector<std::deque<std::pair<int, int>>> territories_;
+        std::size_t rebalances_;
+        mutable std::mutex mtx_;
+        int stationDistance(int x, int y) const;
+        void bisect(std::vector<std::pair<int, int>>& cells, std::size_t begin, std::size_t end, std::vector<int>& vehicles, std::size_t vbegin, std::size_t vend);
+        void orderTerritory(int vehicle);
+        double remainingWork(int vehicle) const;
+        bool stealWork(int vehicle, int x, int y);
+};
+
+#endif
@@ -0,0 +1,56 @@
+// Test for the incremental per-cell statistics used by the control center.
+// Readings are added to a few cells and the aggregated values are printed next to the expected ones.
+// The test also checks that the statistics survive a change of the field dimensions and that the list of visited cells follows it.
+
+#include "cellstatistics.h"
+#include "sensor.h"
+#include <iostream>
+#include <chrono>
+
+void printStatistics(const CellStatistics& statistics, int x, int y, Sensor::SensorType type) {
+    const SensorStatistics& stats = statistics.getStatistics(x, y, type);
+    std::cout << "Cell (" << x << ", " << y << ") " << Sensor::sensorTypeToString(type)
+              << ": count = " << stats.count << ", mean = " << stats.mean << ", variance = " << stats.variance()
+              << ", min = " << stats.min << ", max = " << stats.max << ", last = " << stats.last
+              << ", trend = " << stats.trend() << std::endl;
+}
+
+void testCellStatistics() {
+    CellStatistics statistics(5, 4);
+    auto now = std::chrono::steady_clock::now();
+    // Four visits of the same cell: mean 30, sample variance 216.67, min 15, max 45
+    for (double value : {20.0, 40.0, 45.0, 15.0}) {
+        statistics.addReading(2, 3, Sensor::SensorType::MoistureSensor, value, now);
+    }
+    statistics.addReading(4, 0, Sensor::SensorType::AirTemperatureSensor, 12.5, now);
+    std::cout << "Expected: count = 4, mean = 30, variance = 216.667, min = 15, max = 45, last = 15, trend = -15" << std::endl;
+    printStatistics(statistics, 2, 3, Sensor::SensorType::MoistureSensor);
+    std::cout << "Expected: count = 0" << std::endl;
+    printStatistics(statistics, 2, 3, Sensor::SensorType::HumiditySensor);
+
+    // The field grows: old cells keep their history, new cells start empty
+    statistics.resize(10, 10);
+    std::cout << "Expected after resize: count = 4, mean = 30" << std::endl;
+    printStatistics(statistics, 2, 3, Sensor::SensorType::MoistureSensor);
+    std::cout << "Expected after resize: count = 1, mean = 12.5" << std::endl;
+    printStatistics(statistics, 4, 0, Sensor::SensorType::AirTemperatureSensor);
+    printStatistics(statistics, 9, 9, Sensor::SensorType::AirTemperatureSensor);
+
+    // Only cells with readings are listed, once each, and cells left outside the field after a shrink leave the list
+    statistics.addReading(7, 8, Sensor::SensorType::HumiditySensor, 60.0, now);
+    statistics.resize(6, 6);
+    std::cout << "Expected visited cells: (2, 3) (4, 0)" << std::endl << "Visited cells:";
+    for (const auto& cell : statistics.getVisitedCells()) {
+        std::cout << " (" << cell.first << ", " << cell.second << ")";
+    }
+    std::cout << std::endl;
+
+    statistics.resetCell(2, 3);
+    std::cout << "Expected after reset: count = 0" << std::endl;
+    printStatistics(statistics, 2, 3, Sensor::SensorType::MoistureSensor);
+}
+
+int main() {
+    testCellStatistics();
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include "field.h"
 #include "sensor.h"
 #include "soil.h"
+#include "fleetregistry.h"
+#include <thread>
 
 void testControlCenter() {
     // Creazione di un campo di 10x10 celle.
@@ -18,10 +20,13 @@ void testControlCenter() {
     Vehicle vehicle("Ford", 10000, Vehicle::VehicleType::FieldVehicle, 0, 0, 1.0, 100.0, sensors, field);
     // Creazione di un control center.
     ControlCenter controlCenter(field);
+    // Nessun veicolo invia dati in modo autonomo: ogni chiamata ad analyzeData analizza il buffer e termina
+    controlCenter.setActiveVehicles(0);
     // Invio di un comando di movimento al veicolo.
     controlCenter.sendMovementCommandToVehicle(vehicle, 5, 5);
     // invio di comando di lettura dei dati al veicolo.
     controlCenter.commandDataRead(vehicle);
+    controlCenter.commandDataFlush(vehicle);
     // Analisi dei dati.
     controlCenter.analyzeData();
     std::cout << vehicle.getX();
@@ -39,17 +44,111 @@ std::cout << "After modification: hasPlants = " << (soil2.getPlants() ? "Yes" :
     // manda il veicolo a leggere i dati in quella zona del campo con le piante
     controlCenter.sendMovementCommandToVehicle(vehicle, 2, 2);
     controlCenter.commandDataRead(vehicle);
+    controlCenter.commandDataFlush(vehicle);
     controlCenter.analyzeData();
 
     // Modifico dati in una cella attigua
+    std::uint64_t surveyedGeneration {field.getGeneration()};
     field.modifySoilProperty(3, 4, 3, 4, [](Soil& soil) { soil.setSoilMoisture(95); });
+    // Solo le quattro celle con piante modificate vanno rilevate di nuovo
+    std::vector<std::pair<int, int>> changedCells;
+    controlCenter.getChangedPlantCells(surveyedGeneration, changedCells);
+    std::cout << "Expected changed plant cells: (3, 3) (3, 4) (4, 3) (4, 4)" << std::endl << "Changed plant cells:";
+    for (const auto& cell : changedCells) {
+        std::cout << " (" << cell.first << ", " << cell.second << ")";
+    }
+    std::cout << std::endl;
     // Mando il veicolo a leggere i dati in quella zona
     controlCenter.sendMovementCommandToVehicle(vehicle, 3, 3);
     controlCenter.commandDataRead(vehicle);
+    controlCenter.commandDataFlush(vehicle);
     controlCenter.analyzeData();
+
+    // Rileggo la cella (2, 2), che non è cambiata: il risultato registrato segnala che la cella è invariata
+    controlCenter.sendMovementCommandToVehicle(vehicle, 2, 2);
+    controlCenter.commandDataRead(vehicle);
+    controlCenter.commandDataFlush(vehicle);
+    controlCenter.analyzeData();
+    std::vector<std::string> results {controlCenter.getAnalysisResults()};
+    std::cout << "Expected last result: Unchanged at position (2, 2), actual: " << (results.empty() ? "none" : results.back()) << std::endl;
+    std::cout << "Expected unchanged analyses: 1, actual: " << controlCenter.getUnchangedAnalyses() << std::endl;
+}
+
+// Uno stesso veicolo registrato in due registri ha un indice in ciascuno, e registrarlo di nuovo, anche da più thread, non occupa altri posti
+void testFleetRegistry() {
+    Field field("fattoriaRegistro", 10, 10);
+    std::vector<Sensor> sensors = {Sensor(Sensor::SensorType::MoistureSensor)};
+    Vehicle first("Primo", 20001, Vehicle::VehicleType::FieldVehicle, 0, 0, 1.0, 100.0, sensors, field);
+    Vehicle second("Secondo", 20002, Vehicle::VehicleType::FieldVehicle, 1, 1, 1.0, 100.0, sensors, field);
+    FleetRegistry registryA(2);
+    FleetRegistry registryB(2);
+    registryA.registerVehicle(first);
+    registryA.registerVehicle(second);
+    registryB.registerVehicle(second);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&registryA, &registryB, &first, &second] {
+            for (int repeat = 0; repeat < 100; ++repeat) {
+                registryA.registerVehicle(first);
+                registryA.registerVehicle(second);
+                registryB.registerVehicle(second);
+                registryB.registerVehicle(first);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::cout << "Expected registry A: 2 vehicles, first at 0, second at 1, actual: " << registryA.getSize() << " vehicles, first at "
+              << registryA.findVehicle(first) << ", second at " << registryA.findVehicle(second) << std::endl;
+    std::cout << "Expected registry B: 2 vehicles, second at 0, first at 1, actual: " << registryB.getSize() << " vehicles, second at "
+              << registryB.findVehicle(second) << ", first at " << registryB.findVehicle(first) << std::endl;
+}
+
+// Il verdetto di una visita si basa sulle sue letture e non sulla media di tutte le visite: nove visite al 45% di umidità e una al 5%
+// danno una media di 41, ottimale per un suolo di medio impasto, ma l'ultima visita deve risultare troppo asciutta
+void testCurrentVisitVerdict() {
+    Field field("fattoriaVisite", 5, 5);
+    field.modifySoilProperty(1, 1, 1, 1, [](Soil& soil) {
+        soil.setSoilType(Soil::SoilType::loam);
+        soil.setPlants(true);
+    });
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(0);
+    for (int visit = 0; visit < 10; ++visit) {
+        controlCenter.appendData({{1, 1, Sensor::SensorType::MoistureSensor, visit < 9 ? 45.0 : 5.0}}, 0);
+        controlCenter.analyzeData();
+    }
+    std::vector<std::string> results {controlCenter.getAnalysisResults()};
+    std::cout << "Expected mean moisture: 41, actual: " << controlCenter.getCellStatistics(1, 1, Sensor::SensorType::MoistureSensor).mean << std::endl;
+    std::cout << "Expected last result: Critical: Too dry at position (1, 1), actual: " << (results.empty() ? "none" : results.back()) << std::endl;
+}
+
+// La cache delle analisi confronta le letture della visita corrente: un calo di 30 punti dopo venti visite sposta la media solo di 1.5,
+// meno di un passo di quantizzazione, ma la cella non deve risultare invariata
+void testCacheOnCurrentVisit() {
+    Field field("fattoriaCache", 5, 5);
+    field.modifySoilProperty(2, 2, 2, 2, [](Soil& soil) {
+        soil.setSoilType(Soil::SoilType::loam);
+        soil.setPlants(true);
+    });
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(0);
+    for (int visit = 0; visit < 20; ++visit) {
+        controlCenter.appendData({{2, 2, Sensor::SensorType::MoistureSensor, visit % 2 == 0 ? 44.9 : 43.1}}, 0);
+        controlCenter.analyzeData();
+    }
+    std::cout << "Expected unchanged analyses: 19, actual: " << controlCenter.getUnchangedAnalyses() << std::endl;
+    controlCenter.appendData({{2, 2, Sensor::SensorType::MoistureSensor, 14.0}}, 0);
+    controlCenter.analyzeData();
+    std::vector<std::string> results {controlCenter.getAnalysisResults()};
+    std::cout << "Expected last result: Critical: Too dry at position (2, 2), actual: " << (results.empty() ? "none" : results.back()) << std::endl;
 }
 
 int main() {
+    testFleetRegistry();
+    testCurrentVisitVerdict();
+    testCacheOnCurrentVisit();
     testControlCenter();
     // stampa i risultati del test
     return 0;
@@ -4,6 +4,13 @@
 #include "field.h"
 #include "sensor.h"
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
 using std::cout;
 using std::endl;
 
@@ -46,8 +53,193 @@ void testFieldCreation()
 
     }
 
+// Test of the generation counter and change log: only the areas written after a generation are returned
+void testFieldChangeLog()
+    {
+        Field field("FattoriaBlu", 10, 10);
+        cout << "Expected generation: 0, actual: " << field.getGeneration() << endl;
+        field.modifySoilProperty(0, 3, 1, 4, [](Soil& soil) {soil.setPlants(true);});
+        std::uint64_t surveyed {field.getGeneration()};
+        field.modifySoilProperty(5, 5, 5, 5, [](Soil& soil) {soil.setSoilMoisture(12);});
+        field.modifySoilProperty(5, 6, 5, 6, [](Soil& soil) {soil.setSoilMoisture(10);}); // Covers the previous area: it replaces its record
+        field.setSoil(Soil(), 8, 9, 0, 2);
+        std::vector<Field::ChangeRecord> changes;
+        bool complete {field.getChangesSince(surveyed, changes)};
+        cout << "Expected: complete = 1, 2 changes: (8-9, 0-2) and (5-6, 5-6)" << endl;
+        cout << "complete = " << complete << ", " << changes.size() << " changes:";
+        for (const auto& change : changes) {
+            cout << " (" << change.startlength << "-" << change.endlength << ", " << change.startwidth << "-" << change.endwidth << ")";
+        }
+        cout << endl;
+        field.getChangesSince(field.getGeneration(), changes);
+        cout << "Expected changes since the current generation: 0, actual: " << changes.size() << endl;
+        // After more than 1024 writes to different areas the oldest generations are no longer covered
+        for (int i = 0; i < 1100; ++i) {
+            field.modifySoilProperty(i % 10, i % 10, (i / 10) % 10, (i / 10) % 10, [](Soil& soil) {soil.setAirHumidity(50);});
+        }
+        cout << "Expected: complete = 0, actual: complete = " << field.getChangesSince(surveyed, changes) << endl;
+    }
+
+// Test of the binary snapshot: a saved field reopened by mapping the file must have the same cells, and a write must not touch the file
+void testFieldSnapshot()
+    {
+        Field field("FattoriaViola", 70, 9); // 630 cells: the plant bitmap ends with a partial word
+        field.setSoil(Soil(Soil::SoilType::clay, true, 35, 18.5, 65), 10, 40, 2, 6);
+        field.modifySoilProperty(65, 69, 0, 8, [](Soil& soil) {soil.setSoilType(Soil::SoilType::silt); soil.setPlants(true);});
+        cout << "Expected save: 1, actual: " << field.saveSnapshot("field_snapshot_test.bin") << endl;
+        Field opened;
+        cout << "Expected open: 1, mapped: 1, actual: " << opened.openSnapshot("field_snapshot_test.bin") << ", mapped: " << opened.isMapped() << endl;
+        cout << opened << endl;
+        int differences {0};
+        for (int x = 0; x < field.getLength(); ++x) {
+            for (int y = 0; y < field.getWidth(); ++y) {
+                Soil expected, actual;
+                field.peekSoil(x, y, expected);
+                opened.peekSoil(x, y, actual);
+                if (expected.getSoilType() != actual.getSoilType() || expected.getPlants() != actual.getPlants()
+                    || expected.PassSoilMoistureToSensor(SensorType::MoistureSensor) != actual.PassSoilMoistureToSensor(SensorType::MoistureSensor)
+                    || expected.PassTemperatureToSensor(SensorType::SoilTemperatureSensor) != actual.PassTemperatureToSensor(SensorType::SoilTemperatureSensor)
+                    || expected.PassTemperatureToSensor(SensorType::AirTemperatureSensor) != actual.PassTemperatureToSensor(SensorType::AirTemperatureSensor)
+                    || expected.PassAirHumidityToSensor(SensorType::HumiditySensor) != actual.PassAirHumidityToSensor(SensorType::HumiditySensor)) {
+                    ++differences;
+                }
+            }
+        }
+        cout << "Expected differing cells: 0, actual: " << differences << endl;
+        // The first write copies the columns into private memory
+        opened.modifySoilProperty(0, 0, 0, 0, [](Soil& soil) {soil.setPlants(true);});
+        Field reopened;
+        reopened.openSnapshot("field_snapshot_test.bin");
+        std::vector<std::vector<bool>> plants {opened.getPlants(0, 0, 0, 0)};
+        std::vector<std::vector<bool>> filePlants {reopened.getPlants(0, 0, 0, 0)};
+        cout << "Expected after write: mapped = 0, plants = 1, file plants = 0, actual: mapped = " << opened.isMapped()
+             << ", plants = " << plants[0][0] << ", file plants = " << filePlants[0][0] << endl;
+        opened.changeDimensions(-60, 1);
+        opened.printPlantPresence();
+        cout << "Expected open of a missing file: 0, actual: " << opened.openSnapshot("missing_snapshot.bin") << endl;
+
+        // Corrupted headers and cells are rejected on open: a soil type outside the enumeration and dimensions whose blocks overflow
+        std::ifstream original("field_snapshot_test.bin", std::ios::binary);
+        std::vector<char> image((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+        original.close();
+        std::uint64_t soilTypesOffset;
+        std::memcpy(&soilTypesOffset, image.data() + 32, sizeof(soilTypesOffset));
+        std::vector<char> badSoil {image};
+        badSoil[soilTypesOffset + 100] = 7;
+        std::ofstream("field_snapshot_bad_soil.bin", std::ios::binary).write(badSoil.data(), badSoil.size());
+        std::vector<char> badSize {image};
+        std::uint32_t huge {0x7FFFFFFF};
+        std::memcpy(badSize.data() + 16, &huge, sizeof(huge));
+        std::memcpy(badSize.data() + 20, &huge, sizeof(huge));
+        std::ofstream("field_snapshot_bad_size.bin", std::ios::binary).write(badSize.data(), badSize.size());
+        cout << "Expected open with an invalid soil type: 0, actual: " << opened.openSnapshot("field_snapshot_bad_soil.bin") << endl;
+        cout << "Expected open with overflowing dimensions: 0, actual: " << opened.openSnapshot("field_snapshot_bad_size.bin") << endl;
+        std::remove("field_snapshot_bad_soil.bin");
+        std::remove("field_snapshot_bad_size.bin");
+        std::remove("field_snapshot_test.bin");
+    }
+
+void testFieldCompact()
+    {
+        Field field("FattoriaArancione", 100, 80);
+        field.setSoil(Soil(Soil::SoilType::sand, true, 33.3333, 27.123f, 61.0017), 10, 59, 5, 44);
+        field.modifySoilProperty(70, 99, 0, 79, [](Soil& soil) {soil.setAirTemperature(-12.345f); soil.setSoilMoisture(99.9999);});
+        std::uint64_t generation {field.getGeneration()};
+        std::size_t wideBytes {field.getColumnBytes()};
+        Field reference("Riferimento", 100, 80);
+        reference.setSoil(Soil(Soil::SoilType::sand, true, 33.3333, 27.123f, 61.0017), 10, 59, 5, 44);
+        reference.modifySoilProperty(70, 99, 0, 79, [](Soil& soil) {soil.setAirTemperature(-12.345f); soil.setSoilMoisture(99.9999);});
+        field.compact();
+        cout << "Expected compact: 1, same generation: 1, actual: " << field.isCompact() << ", " << (field.getGeneration() == generation) << endl;
+        cout << "Column bytes: " << wideBytes << " -> " << field.getColumnBytes() << " (" << 100.0 * field.getColumnBytes() / wideBytes << "%)" << endl;
+        int exactDifferences {0};
+        double percentageError {0.0};
+        double temperatureError {0.0};
+        for (int x = 0; x < field.getLength(); ++x) {
+            for (int y = 0; y < field.getWidth(); ++y) {
+                Soil expected, actual;
+                reference.peekSoil(x, y, expected);
+                field.peekSoil(x, y, actual);
+                exactDifferences += expected.getSoilType() != actual.getSoilType() || expected.getPlants() != actual.getPlants();
+                percentageError = std::max({percentageError,
+                    std::fabs(expected.PassSoilMoistureToSensor(SensorType::MoistureSensor) - actual.PassSoilMoistureToSensor(SensorType::MoistureSensor)),
+                    std::fabs(expected.PassAirHumidityToSensor(SensorType::HumiditySensor) - actual.PassAirHumidityToSensor(SensorType::HumiditySensor))});
+                temperatureError = std::max({temperatureError,
+                    static_cast<double>(std::fabs(expected.PassTemperatureToSensor(SensorType::AirTemperatureSensor) - actual.PassTemperatureToSensor(SensorType::AirTemperatureSensor))),
+                    static_cast<double>(std::fabs(expected.PassTemperatureToSensor(SensorType::SoilTemperatureSensor) - actual.PassTemperatureToSensor(SensorType::SoilTemperatureSensor)))});
+            }
+        }
+        cout << "Expected exact soil types and plants: 0 differences, actual: " << exactDifferences << endl;
+        cout << "Expected errors within precision: 1 1, actual: " << (percentageError <= Field::PercentagePrecision) << " "
+             << (temperatureError <= Field::TemperaturePrecision) << " (" << percentageError << ", " << temperatureError << ")" << endl;
+        cout << "Expected soil types and plants of a region: sand 1, actual: " << Soil::soilTypeToString(field.getSoilTypes(20, 20, 20, 20)[0][0])
+             << " " << field.getPlants(20, 20, 20, 20)[0][0] << endl;
+
+        // A compact field is saved in the normal format
+        field.saveSnapshot("field_compact_test.bin");
+        Field opened;
+        opened.openSnapshot("field_compact_test.bin");
+        Soil saved, compacted;
+        opened.peekSoil(15, 15, saved);
+        field.peekSoil(15, 15, compacted);
+        cout << "Expected same moisture from the snapshot: 1, actual: "
+             << (saved.PassSoilMoistureToSensor(SensorType::MoistureSensor) == compacted.PassSoilMoistureToSensor(SensorType::MoistureSensor)) << endl;
+        std::remove("field_compact_test.bin");
+
+        // The first write expands the field
+        field.modifySoilProperty(0, 0, 0, 0, [](Soil& soil) {soil.setSoilMoisture(12.0);});
+        Soil written;
+        field.peekSoil(0, 0, written);
+        cout << "Expected after write: compact = 0, moisture = 12, actual: compact = " << field.isCompact() << ", moisture = "
+             << written.PassSoilMoistureToSensor(SensorType::MoistureSensor) << endl;
+        // The compact columns are released: the expanded field takes the same memory as before the compaction
+        cout << "Expected column bytes after the write: " << wideBytes << ", actual: " << field.getColumnBytes() << endl;
+    }
+
+void testFieldViews()
+    {
+        Field field("FattoriaViola", 30, 40);
+        field.setSoil(Soil(Soil::SoilType::silt, true, 42.5, 21.5f, 55.0), 5, 14, 10, 29);
+        field.modifySoilProperty(0, 29, 0, 39, [](Soil& soil) {soil.setAirHumidity(60.0);});
+        auto compare = [&field]() {
+            Field::SoilTypeView soilTypes {field.viewSoilTypes(4, 15, 9, 30)};
+            Field::PlantView plants {field.viewPlants(4, 15, 9, 30)};
+            Field::PercentageView moisture {field.viewSoilMoisture(4, 15, 9, 30)};
+            Field::TemperatureView soilTemperature {field.viewSoilTemperature(4, 15, 9, 30)};
+            int differences {0};
+            soilTypes.forEach([&](int row, int column, Soil::SoilType soilType) {
+                Soil soil;
+                field.peekSoil(4 + row, 9 + column, soil);
+                differences += soilType != soil.getSoilType() || plants(row, column) != soil.getPlants()
+                    || std::fabs(moisture(row, column) - soil.PassSoilMoistureToSensor(SensorType::MoistureSensor)) > 1e-9
+                    || std::fabs(soilTemperature(row, column) - soil.PassTemperatureToSensor(SensorType::SoilTemperatureSensor)) > 1e-6f;
+            });
+            return differences;
+        };
+        Field::PlantView plants {field.viewPlants(4, 15, 9, 30)};
+        cout << "Expected view of 12 x 22 cells with 200 plant cells: actual " << plants.rows() << " x " << plants.columns() << " with "
+             << plants.count(true) << " plant cells" << endl;
+        cout << "Expected differences between views and cells: 0, actual: " << compare() << endl;
+        Field::PlantView inner {plants.subview(1, 1, 10, 20)};
+        Field::PlantView sample {plants.strided(2, 4)};
+        cout << "Expected sub-view with plants only: 200, actual: " << inner.count(true) << endl;
+        cout << "Expected sample of 6 x 6 cells with 25 plant cells: actual " << sample.rows() << " x " << sample.columns() << " with "
+             << sample.count(true) << " plant cells" << endl;
+        std::vector<std::vector<Soil::SoilType>> copied {field.getSoilTypes(5, 6, 9, 10)};
+        cout << "Expected copied soil types: loam silt, actual: " << Soil::soilTypeToString(copied[0][0]) << " " << Soil::soilTypeToString(copied[1][1]) << endl;
+
+        // The same views on the compact encoding, which has no bitmap and no wide columns
+        field.compact();
+        cout << "Expected differences between compact views and cells: 0, actual: " << compare() << endl;
+        cout << "Expected humidity from the compact view: 60, actual: " << field.viewAirHumidity(0, 29, 0, 39)(29, 39) << endl;
+    }
+
 int main()
     {
+        testFieldViews();
+        testFieldChangeLog();
+        testFieldSnapshot();
+        testFieldCompact();
         testFieldCreation();
         return 0;
     }
@@ -0,0 +1,147 @@
+// Test for the field dynamics engine.
+// Moisture spreads from a wet spot without being lost when evaporation is off, evaporates faster with hot and dry air,
+// soil temperature moves towards its equilibrium value, and the result does not depend on the number of threads.
+
+#include "fielddynamics.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+double moistureAt(const Field& field, int x, int y) {
+    Soil soil;
+    field.peekSoil(x, y, soil);
+    return soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor);
+}
+
+float soilTemperatureAt(const Field& field, int x, int y) {
+    Soil soil;
+    field.peekSoil(x, y, soil);
+    return soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor);
+}
+
+double totalMoisture(const Field& field) {
+    double total {0.0};
+    for (int x = 0; x < field.getLength(); ++x) {
+        for (int y = 0; y < field.getWidth(); ++y) {
+            total += moistureAt(field, x, y);
+        }
+    }
+    return total;
+}
+
+// A 40 x 300 field: several tiles in both directions, with partial tiles at the borders
+void buildField(Field& field) {
+    field.modifySoilProperty(0, 39, 0, 299, [](Soil& soil) { soil.setSoilMoisture(20.0); soil.setAirHumidity(100.0); });
+    field.modifySoilProperty(18, 21, 148, 151, [](Soil& soil) { soil.setSoilMoisture(90.0); });
+    field.modifySoilProperty(0, 39, 200, 299, [](Soil& soil) { soil.setSoilType(Soil::SoilType::sand); });
+}
+
+void testDiffusion() {
+    Field field("FattoriaBianca", 40, 300);
+    buildField(field);
+    FieldDynamics dynamics(field, 4);
+    FieldDynamics::Parameters parameters {FieldDynamics::defaultParameters()};
+    parameters.evaporationrate = 0.0;
+    dynamics.setParameters(parameters);
+    double before {totalMoisture(field)};
+    std::uint64_t generation {field.getGeneration()};
+    dynamics.run(24, 1.0);
+    double after {totalMoisture(field)};
+    std::cout << "Expected conserved moisture: 1, actual: " << (std::fabs(after - before) < 1e-6 * before) << std::endl;
+    std::cout << "Expected wet spot drying and neighbour wetting: 1 1, actual: " << (moistureAt(field, 19, 149) < 90.0) << " "
+              << (moistureAt(field, 17, 149) > 20.0) << std::endl;
+    std::cout << "Expected far cell unchanged: 20, actual: " << moistureAt(field, 0, 0) << std::endl;
+    std::cout << "Expected 24 steps and 24 new generations, actual: " << dynamics.getSteps() << " steps, " << field.getGeneration() - generation
+              << " generations, " << dynamics.getSubsteps() << " substeps" << std::endl;
+}
+
+void testEvaporation() {
+    Field field("FattoriaGrigia", 4, 4);
+    field.modifySoilProperty(0, 1, 0, 3, [](Soil& soil) { soil.setAirTemperature(35.0); soil.setAirHumidity(20.0); });
+    field.modifySoilProperty(2, 3, 0, 3, [](Soil& soil) { soil.setAirTemperature(10.0); soil.setAirHumidity(80.0); });
+    FieldDynamics dynamics(field, 1);
+    dynamics.run(48, 1.0);
+    std::cout << "Expected hot and dry cell drier than cool and humid cell, both below 50: actual " << moistureAt(field, 0, 0) << " < "
+              << moistureAt(field, 3, 3) << " < 50" << std::endl;
+}
+
+void testSoilTemperature() {
+    Field field("FattoriaNera", 2, 2);
+    field.modifySoilProperty(0, 1, 0, 1, [](Soil& soil) { soil.setSoilMoisture(80.0); soil.setAirTemperature(35.0); soil.setAirHumidity(10.0); });
+    float start {soilTemperatureAt(field, 0, 0)};
+    FieldDynamics dynamics(field, 1);
+    // The soil dries in one hour: its temperature moves towards the new equilibrium without reaching it
+    dynamics.step(1.0);
+    float equilibrium {Soil::soilTemperature(Soil::SoilType::loam, moistureAt(field, 0, 0), 35.0f, 10.0)};
+    float after {soilTemperatureAt(field, 0, 0)};
+    std::cout << "Expected soil temperature between start and equilibrium: 1, actual: "
+              << ((after - start) * (equilibrium - after) > 0) << std::endl;
+    // Without evaporation the moisture stays constant, and after two days the temperature has reached the equilibrium
+    FieldDynamics::Parameters parameters {FieldDynamics::defaultParameters()};
+    parameters.evaporationrate = 0.0;
+    dynamics.setParameters(parameters);
+    dynamics.run(48, 1.0);
+    std::cout << "Expected soil temperature at equilibrium: 1, actual: " << (std::fabs(soilTemperatureAt(field, 0, 0) - equilibrium) < 0.01f) << std::endl;
+}
+
+void testThreadIndependence() {
+    Field single("FattoriaUno", 40, 300);
+    Field parallel("FattoriaQuattro", 40, 300);
+    buildField(single);
+    buildField(parallel);
+    FieldDynamics singleDynamics(single, 1);
+    FieldDynamics parallelDynamics(parallel, 4);
+    singleDynamics.run(12, 2.0);
+    parallelDynamics.run(12, 2.0);
+    int differences {0};
+    for (int x = 0; x < 40; ++x) {
+        for (int y = 0; y < 300; ++y) {
+            if (moistureAt(single, x, y) != moistureAt(parallel, x, y) || soilTemperatureAt(single, x, y) != soilTemperatureAt(parallel, x, y)) {
+                ++differences;
+            }
+        }
+    }
+    std::cout << "Expected differences between 1 and 4 threads: 0, actual: " << differences << std::endl;
+}
+
+// A field opened from a snapshot is copied to private memory before the first step; the snapshot file is not modified
+void testMappedField() {
+    Field original("FattoriaRossa", 40, 300);
+    buildField(original);
+    original.saveSnapshot("field_dynamics_test.bin");
+    Field mapped("Vuoto", 1, 1);
+    mapped.openSnapshot("field_dynamics_test.bin");
+    FieldDynamics dynamics(mapped, 2);
+    dynamics.run(6, 1.0);
+    Field reopened("Vuoto", 1, 1);
+    reopened.openSnapshot("field_dynamics_test.bin");
+    std::cout << "Expected moisture of the stepped field below 90 and of the snapshot at 90: actual " << moistureAt(mapped, 19, 149) << ", "
+              << moistureAt(reopened, 19, 149) << std::endl;
+    std::remove("field_dynamics_test.bin");
+}
+
+// One simulated week of a 1000 x 1000 field, hour by hour
+void testLargeField() {
+    Field field("FattoriaGrande", 1000, 1000);
+    field.modifySoilProperty(0, 499, 0, 999, [](Soil& soil) { soil.setSoilType(Soil::SoilType::sand); soil.setSoilMoisture(80.0); });
+    FieldDynamics dynamics(field, 4);
+    auto start = std::chrono::steady_clock::now();
+    dynamics.run(7 * 24, 1.0);
+    double seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    std::cout << "One week of a 1000 x 1000 field: " << seconds << " s, " << dynamics.getSubsteps() / seconds << " million cell updates per second" << std::endl;
+}
+
+int main() {
+    testDiffusion();
+    testEvaporation();
+    testSoilTemperature();
+    testThreadIndependence();
+    testMappedField();
+    testLargeField();
+    return 0;
+}
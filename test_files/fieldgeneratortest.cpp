@@ -0,0 +1,102 @@
+// Test for the procedural field generator.
+// The same seed gives the same field for any number of threads, a different seed gives a different field,
+// soil types form patches, plants grow only on the rows of the crop and the moisture decreases along the field.
+
+#include "fieldgenerator.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <array>
+
+double moistureAt(const Field& field, int x, int y) {
+    Soil soil;
+    field.peekSoil(x, y, soil);
+    return soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor);
+}
+
+// Number of cells that differ between two fields of the same size
+int differences(const Field& first, const Field& second) {
+    int count {0};
+    for (int x = 0; x < first.getLength(); ++x) {
+        for (int y = 0; y < first.getWidth(); ++y) {
+            Soil a;
+            Soil b;
+            first.peekSoil(x, y, a);
+            second.peekSoil(x, y, b);
+            if (a.getSoilType() != b.getSoilType() || a.getPlants() != b.getPlants()
+                || a.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor) != b.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)
+                || a.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor) != b.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+void testDeterminism() {
+    Field single("FattoriaUno", 1, 1);
+    Field parallel("FattoriaQuattro", 1, 1);
+    Field other("FattoriaAltra", 1, 1);
+    FieldGenerator(FieldGenerator::defaultParameters(42), 1).generate(single, 157, 203);
+    FieldGenerator(FieldGenerator::defaultParameters(42), 4).generate(parallel, 157, 203);
+    FieldGenerator(FieldGenerator::defaultParameters(43), 4).generate(other, 157, 203);
+    std::cout << "Expected dimensions: 157 x 203, actual: " << parallel.getLength() << " x " << parallel.getWidth() << std::endl;
+    std::cout << "Expected differences between 1 and 4 threads: 0, actual: " << differences(single, parallel) << std::endl;
+    std::cout << "Expected many differences with another seed: 1, actual: " << (differences(single, other) > 157 * 203 / 4) << std::endl;
+}
+
+void testContent() {
+    Field field("FattoriaProcedurale", 10, 10);
+    std::uint64_t generation {field.getGeneration()};
+    FieldGenerator generator(FieldGenerator::defaultParameters(7), 4);
+    generator.generate(field, 400, 300);
+    std::cout << "Expected one new generation: 1, actual: " << field.getGeneration() - generation << std::endl;
+
+    std::array<int, 4> types{};
+    int sameAsRight {0};
+    int plantsOutsideRows {0};
+    std::size_t plants {0};
+    for (int x = 0; x < field.getLength(); ++x) {
+        for (int y = 0; y < field.getWidth(); ++y) {
+            Soil::SoilType type;
+            field.getSoilType(x, y, type);
+            ++types[static_cast<std::size_t>(type)];
+            Soil::SoilType right;
+            if (y + 1 < field.getWidth() && field.getSoilType(x, y + 1, right) && right == type) {
+                ++sameAsRight;
+            }
+            Soil soil;
+            field.peekSoil(x, y, soil);
+            plants += soil.getPlants();
+            plantsOutsideRows += soil.getPlants() && x % 3 != 0;
+        }
+    }
+    std::cout << "Expected all four soil types: 1, actual: " << (types[0] > 0 && types[1] > 0 && types[2] > 0 && types[3] > 0) << std::endl;
+    std::cout << "Expected patches (over 90% of neighbours with the same type): 1, actual: " << (sameAsRight > 0.9 * 400 * 299) << std::endl;
+    std::cout << "Expected plants outside the rows: 0, actual: " << plantsOutsideRows << std::endl;
+    std::cout << "Expected plant count reported by the generator: " << plants << ", actual: " << generator.getPlantCells() << std::endl;
+    double first {0.0};
+    double last {0.0};
+    for (int y = 0; y < field.getWidth(); ++y) {
+        first += moistureAt(field, 0, y) / field.getWidth();
+        last += moistureAt(field, field.getLength() - 1, y) / field.getWidth();
+    }
+    std::cout << "Expected drier last row: 1, actual: " << (last < first) << " (" << first << " -> " << last << ")" << std::endl;
+}
+
+// A 2000 x 2000 field: four million cells
+void testLargeField() {
+    Field field("FattoriaEnorme", 1, 1);
+    FieldGenerator generator(FieldGenerator::defaultParameters(2024), 4);
+    generator.generate(field, 2000, 2000);
+    std::cout << "Generated 2000 x 2000 field in " << generator.getLastSeconds() << " s, " << 4.0 / generator.getLastSeconds()
+              << " million cells per second, " << generator.getPlantCells() << " plant cells" << std::endl;
+}
+
+int main() {
+    testDeterminism();
+    testContent();
+    testLargeField();
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Test for the multi-resolution pyramid of the field.
+// Summaries match the values computed cell by cell (exactly on whole tiles and on single cells), follow every kind of write,
+// and the cost of a summary depends on the size of the grid, not on the size of the field.
+
+#include "field.h"
+#include "fieldgenerator.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+// Summary of a region computed directly from the cells
+Field::Summary bruteForce(const Field& field, int startlength, int endlength, int startwidth, int endwidth) {
+    Field::Summary summary {};
+    std::array<int, 4> types{};
+    for (int x = startlength; x <= endlength; ++x) {
+        for (int y = startwidth; y <= endwidth; ++y) {
+            Soil soil;
+            field.peekSoil(x, y, soil);
+            ++types[static_cast<std::size_t>(soil.getSoilType())];
+            summary.plantdensity += soil.getPlants();
+            summary.soilmoisture += soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor);
+            summary.airtemperature += soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor);
+            summary.airhumidity += soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor);
+            summary.soiltemperature += soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor);
+            ++summary.cells;
+        }
+    }
+    double cells {static_cast<double>(summary.cells)};
+    summary.soiltype = static_cast<Soil::SoilType>(std::max_element(types.begin(), types.end()) - types.begin());
+    summary.plantdensity /= cells;
+    summary.soilmoisture /= cells;
+    summary.airtemperature /= cells;
+    summary.airhumidity /= cells;
+    summary.soiltemperature /= cells;
+    return summary;
+}
+
+// Largest difference between two summaries over all the values, or a large number if the cell count or the soil type differ
+double difference(const Field::Summary& a, const Field::Summary& b) {
+    if (a.cells != b.cells || a.soiltype != b.soiltype) {
+        return 1e9;
+    }
+    return std::max({std::fabs(a.plantdensity - b.plantdensity), std::fabs(a.soilmoisture - b.soilmoisture), std::fabs(a.airtemperature - b.airtemperature),
+                     std::fabs(a.airhumidity - b.airhumidity), std::fabs(a.soiltemperature - b.soiltemperature)});
+}
+
+// Largest difference between a summary grid aligned with the field and the values computed cell by cell
+double gridDifference(const Field& field, int rows, int columns) {
+    std::vector<Field::Summary> summaries;
+    field.summarize(0, field.getLength() - 1, 0, field.getWidth() - 1, rows, columns, summaries);
+    int height {field.getLength() / rows};
+    int width {field.getWidth() / columns};
+    double largest {0.0};
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            Field::Summary expected {bruteForce(field, row * height, (row + 1) * height - 1, column * width, (column + 1) * width - 1)};
+            largest = std::max(largest, difference(expected, summaries[row * columns + column]));
+        }
+    }
+    return largest;
+}
+
+void prepare(Field& field) {
+    field.setSoil(Soil(Soil::SoilType::sand, true, 20.0, 30.0f, 40.0), 10, 70, 5, 50);
+    field.setSoil(Soil(Soil::SoilType::clay, false, 80.0, 15.0f, 70.0), 90, 127, 60, 127);
+    field.modifySoilProperty(0, 127, 100, 110, [](Soil& soil) { soil.setPlants(true); });
+}
+
+void testExactSummaries() {
+    Field field("FattoriaPiramide", 128, 128);
+    prepare(field);
+    std::vector<Field::Summary> whole;
+    field.summarize(0, 127, 0, 127, 1, 1, whole);
+    std::cout << "Expected whole field like the cells: 1, actual: " << (difference(whole[0], bruteForce(field, 0, 127, 0, 127)) < 1e-9) << std::endl;
+    std::cout << "Expected 4 x 4 grid of whole tiles like the cells: 1, actual: " << (gridDifference(field, 4, 4) < 1e-9) << std::endl;
+    std::cout << "Expected 16 x 8 grid of whole tiles like the cells: 1, actual: " << (gridDifference(field, 16, 8) < 1e-9) << std::endl;
+    std::cout << "Expected one element per cell like the cells: 1, actual: " << (gridDifference(field, 128, 128) < 1e-9) << std::endl;
+
+    // A zoom on a region that is not aligned with the tiles is computed from its cells
+    std::vector<Field::Summary> zoom;
+    field.summarize(65, 74, 45, 54, 2, 2, zoom);
+    std::cout << "Expected zoomed element like the cells: 1, actual: " << (difference(zoom[3], bruteForce(field, 70, 74, 50, 54)) < 1e-9) << std::endl;
+}
+
+void testIncrementalUpdates() {
+    Field field("FattoriaIncrementale", 128, 128);
+    prepare(field);
+    std::vector<Field::Summary> summaries;
+    field.summarize(0, 127, 0, 127, 4, 4, summaries); // Builds the pyramid
+
+    field.modifySoilProperty(3, 3, 3, 3, [](Soil& soil) { soil.setSoilMoisture(100.0); });
+    field.setSoil(Soil(Soil::SoilType::silt, true, 35.0, 25.0f, 50.0), 33, 60, 33, 95);
+    field.applyRegionUpdates({{0, 20, 0, 127, 5.0f, 90.0}});
+    field.applyIrrigation({{100, 127, 0, 40, 65.0}});
+    std::cout << "Expected grid after partial writes like the cells: 1, actual: " << (gridDifference(field, 4, 4) < 1e-9) << std::endl;
+    field.summarize(0, 127, 0, 127, 1, 1, summaries);
+    std::cout << "Expected whole field after partial writes like the cells: 1, actual: "
+              << (difference(summaries[0], bruteForce(field, 0, 127, 0, 127)) < 1e-9) << std::endl;
+
+    // Writes on the whole field and changes of dimensions rebuild the pyramid at the next summary
+    field.modifySoilProperty(0, 127, 0, 127, [](Soil& soil) { soil.setAirHumidity(45.0); });
+    std::cout << "Expected grid after a write on the whole field like the cells: 1, actual: " << (gridDifference(field, 8, 8) < 1e-9) << std::endl;
+    field.changeDimensions(-64, 64);
+    std::cout << "Expected grid after a resize like the cells: 1, actual: " << (gridDifference(field, 2, 6) < 1e-9) << std::endl;
+    field.compact();
+    std::cout << "Expected grid of a compact field within precision: 1, actual: " << (gridDifference(field, 2, 6) <= Field::TemperaturePrecision) << std::endl;
+}
+
+// Time of a 40 x 80 summary of the whole field after the pyramid has been built
+double summaryTime(const Field& field) {
+    std::vector<Field::Summary> summaries;
+    field.summarize(0, field.getLength() - 1, 0, field.getWidth() - 1, 40, 80, summaries);
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 10; ++repeat) {
+        field.summarize(0, field.getLength() - 1, 0, field.getWidth() - 1, 40, 80, summaries);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 10;
+}
+
+void testCost() {
+    Field small("FattoriaPiccola", 1, 1);
+    Field large("FattoriaGrande", 1, 1);
+    FieldGenerator(FieldGenerator::defaultParameters(5), 4).generate(small, 250, 250);
+    FieldGenerator(FieldGenerator::defaultParameters(5), 4).generate(large, 2000, 2000);
+    double smallTime {summaryTime(small)};
+    double largeTime {summaryTime(large)};
+    std::cout << "40 x 80 summary: " << smallTime << " s on 250 x 250, " << largeTime << " s on 2000 x 2000 (64 times the cells)" << std::endl;
+    std::cout << "Expected similar cost (less than 8 times): 1, actual: " << (largeTime < 8 * smallTime + 1e-3) << std::endl;
+    std::cout << "Pyramid of the large field: " << large.getPyramidBytes() << " bytes" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int cell = 0; cell < 1000; ++cell) {
+        large.modifySoilProperty(cell, cell, cell, cell, [](Soil& soil) { soil.setSoilMoisture(90.0); });
+    }
+    std::cout << "1000 single-cell writes with pyramid updates: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+              << " s" << std::endl;
+    large.printPlantPresence();
+    large.printHeatmap(Field::HeatmapProperty::SoilMoisture, 0, 1999, 0, 1999, 20, 60);
+    large.printHeatmap(Field::HeatmapProperty::SoilMoisture, 0, 39, 0, 119, 10, 60);
+}
+
+int main() {
+    testExactSummaries();
+    testIncrementalUpdates();
+    testCost();
+    return 0;
+}
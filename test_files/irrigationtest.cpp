@@ -0,0 +1,167 @@
+// Test for the closed-loop irrigation.
+// Requests are coalesced into rectangles that cover exactly the requested cells, each step is one field write,
+// and "Too dry" verdicts of the control center become irrigation of the dry cells.
+
+#include "irrigationcontroller.h"
+#include "controlcenter.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <vector>
+#include <set>
+#include <utility>
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+double moistureAt(const Field& field, int x, int y) {
+    Soil soil;
+    field.peekSoil(x, y, soil);
+    return soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor);
+}
+
+// Checks that the rectangles cover each requested cell exactly once, with its target, and nothing else
+bool coversExactly(const std::vector<Field::IrrigationUpdate>& rectangles, const std::set<std::pair<int, int>>& cells) {
+    std::set<std::pair<int, int>> covered;
+    for (const Field::IrrigationUpdate& rectangle : rectangles) {
+        for (int x = rectangle.startlength; x <= rectangle.endlength; ++x) {
+            for (int y = rectangle.startwidth; y <= rectangle.endwidth; ++y) {
+                if (!covered.insert({x, y}).second) {
+                    return false;
+                }
+            }
+        }
+    }
+    return covered == cells;
+}
+
+void testCoalesce() {
+    std::vector<IrrigationController::Command> commands;
+    std::set<std::pair<int, int>> cells;
+    // A 3 x 4 block, requested twice and in reverse order
+    for (int repeat = 0; repeat < 2; ++repeat) {
+        for (int x = 4; x >= 2; --x) {
+            for (int y = 8; y >= 5; --y) {
+                commands.push_back({x, y, 40.0});
+                cells.insert({x, y});
+            }
+        }
+    }
+    // An L shape: a row of three cells and two cells below the first one
+    for (auto cell : std::vector<std::pair<int, int>>{{10, 0}, {10, 1}, {10, 2}, {11, 0}, {12, 0}}) {
+        commands.push_back({cell.first, cell.second, 40.0});
+        cells.insert(cell);
+    }
+    // A cell with a different target next to the block
+    commands.push_back({2, 9, 20.0});
+    cells.insert({2, 9});
+    std::vector<Field::IrrigationUpdate> rectangles;
+    IrrigationController::coalesce(commands, rectangles);
+    std::cout << "Expected distinct commands: 18, rectangles: 4, actual: " << commands.size() << ", " << rectangles.size() << std::endl;
+    std::cout << "Expected exact cover: 1, actual: " << coversExactly(rectangles, cells) << std::endl;
+
+    // The same cell with two targets keeps the higher one
+    commands = {{0, 0, 20.0}, {0, 0, 45.0}};
+    IrrigationController::coalesce(commands, rectangles);
+    std::cout << "Expected one rectangle with target 45, actual: " << rectangles.size() << " with target " << rectangles[0].soilmoisture << std::endl;
+}
+
+void testApply() {
+    Field field("FattoriaAzzurra", 20, 20);
+    field.modifySoilProperty(0, 19, 0, 19, [](Soil& soil) { soil.setSoilMoisture(10.0); });
+    field.modifySoilProperty(5, 5, 5, 5, [](Soil& soil) { soil.setSoilMoisture(80.0); });
+    IrrigationController irrigation(field);
+    std::uint64_t generation {field.getGeneration()};
+    for (int x = 0; x < 10; ++x) {
+        for (int y = 0; y < 10; ++y) {
+            irrigation.requestIrrigation(x, y, 37.5);
+        }
+    }
+    std::size_t rectangles {irrigation.applyPending()};
+    std::cout << "Expected rectangles: 1, new generations: 1, actual: " << rectangles << ", " << field.getGeneration() - generation << std::endl;
+    std::cout << "Expected moisture 37.5 inside, 80 on the wet cell, 10 outside: actual " << moistureAt(field, 9, 9) << ", " << moistureAt(field, 5, 5)
+              << ", " << moistureAt(field, 10, 10) << std::endl;
+    std::cout << "Expected empty step: 0 rectangles, 0 new generations, actual: " << irrigation.applyPending() << ", " << field.getGeneration() - generation - 1 << std::endl;
+    IrrigationController::Throughput throughput {irrigation.getThroughput()};
+    std::cout << "Expected commands: 100, applied: 100, steps: 1, actual: " << throughput.commands << ", " << throughput.appliedcommands << ", "
+              << throughput.steps << std::endl;
+}
+
+// The control center analyzes a batch with a dry cell and a wet cell: only the dry one is irrigated
+void testControlCenterLoop() {
+    Field field("FattoriaArida", 4, 4);
+    field.modifySoilProperty(0, 3, 0, 3, [](Soil& soil) { soil.setPlants(true); });
+    field.modifySoilProperty(0, 0, 0, 0, [](Soil& soil) { soil.setSoilMoisture(5.0); });
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    IrrigationController irrigation(field);
+    controlCenter.setIrrigationController(&irrigation);
+    irrigation.startPeriodic(std::chrono::milliseconds(50));
+    std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+    std::vector<SoilData> batch {controlCenter.acquireBatch()};
+    batch.push_back({0, 0, Sensor::SensorType::MoistureSensor, moistureAt(field, 0, 0)});
+    batch.push_back({1, 1, Sensor::SensorType::MoistureSensor, moistureAt(field, 1, 1)});
+    controlCenter.appendData(std::move(batch));
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    analyzer.join();
+    controlCenter.setIrrigationController(nullptr);
+    irrigation.stop();
+    std::cout << "Expected irrigated dry cell: 37.5, untouched wet cell: 50, actual: " << moistureAt(field, 0, 0) << ", " << moistureAt(field, 1, 1) << std::endl;
+}
+
+// Throughput: a step of 250000 requests, one for every cell of a 500 x 500 field, with stripes of two targets
+void testThroughput() {
+    Field field("FattoriaGrande", 500, 500);
+    IrrigationController irrigation(field);
+    for (int x = 0; x < 500; ++x) {
+        for (int y = 0; y < 500; ++y) {
+            irrigation.requestIrrigation(x, y, (y / 50) % 2 == 0 ? 60.0 : 70.0);
+        }
+    }
+    std::size_t rectangles {irrigation.applyPending()};
+    IrrigationController::Throughput throughput {irrigation.getThroughput()};
+    std::cout << "Expected rectangles: 10, actual: " << rectangles << std::endl;
+    std::cout << "Applied " << throughput.appliedcommands << " commands in " << throughput.writeseconds << " s: " << throughput.appliedpersecond()
+              << " commands/s" << std::endl;
+}
+
+// Periodic steps on a compact field while another thread reads cells: the first step expands the columns, and every read
+// still sees either the old or the irrigated moisture
+void testReadersDuringSteps() {
+    Field field("FattoriaCompatta", 200, 200);
+    field.modifySoilProperty(0, 199, 0, 199, [](Soil& soil) { soil.setSoilMoisture(10.0); });
+    field.compact();
+    IrrigationController irrigation(field);
+    irrigation.startPeriodic(std::chrono::milliseconds(5));
+    int unexpected {0};
+    std::thread reader([&field, &unexpected] {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        for (int read = 0; std::chrono::steady_clock::now() < end; ++read) {
+            double moisture {moistureAt(field, read % 200, (read / 200) % 200)};
+            if (std::abs(moisture - 10.0) > Field::PercentagePrecision && std::abs(moisture - 40.0) > Field::PercentagePrecision) {
+                ++unexpected;
+            }
+        }
+    });
+    for (int x = 0; x < 200; ++x) {
+        for (int y = 0; y < 200; ++y) {
+            irrigation.requestIrrigation(x, y, 40.0);
+        }
+    }
+    reader.join();
+    irrigation.stop();
+    std::cout << "Expected unexpected reads: 0, compact: 0, irrigated: 40, actual: " << unexpected << ", " << field.isCompact() << ", "
+              << moistureAt(field, 199, 199) << std::endl;
+}
+
+int main() {
+    testCoalesce();
+    testApply();
+    testControlCenterLoop();
+    testReadersDuringSteps();
+    testThroughput();
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Test for the mission checkpoints.
+// A mission is interrupted with batches still waiting for analysis: a second control center, as after a restart of the process,
+// restores the checkpoint and must produce exactly the same results as the original mission.
+
+#include "missioncheckpoint.h"
+#include "controlcenter.h"
+#include "vehicle.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+// Sends the four readings of the plant cells of the given rows, one batch per row
+void produceReadings(const Field& field, ControlCenter& controlCenter, int firstrow, int lastrow) {
+    for (int x = firstrow; x <= lastrow; ++x) {
+        std::vector<SoilData> batch {controlCenter.acquireBatch()};
+        for (int y = 0; y < field.getWidth(); ++y) {
+            Soil soil;
+            field.peekSoil(x, y, soil);
+            if (!soil.getPlants()) {
+                continue;
+            }
+            batch.push_back({x, y, Sensor::SensorType::SoilTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::AirTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::MoistureSensor, soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::HumiditySensor, soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor)});
+        }
+        controlCenter.appendData(std::move(batch));
+    }
+}
+
+void buildField(Field& field) {
+    field.modifySoilProperty(0, 5, 0, 5, [](Soil& soil) { soil.setPlants(true); });
+    field.modifySoilProperty(0, 2, 0, 5, [](Soil& soil) { soil.setSoilMoisture(8.0); });
+    field.modifySoilProperty(3, 5, 3, 5, [](Soil& soil) { soil.setSoilType(Soil::SoilType::sand); soil.setAirTemperature(36.0); });
+}
+
+int main() {
+    const std::string directory {"mission_checkpoint_test"};
+    std::filesystem::remove_all(directory);
+    std::vector<Sensor> sensors = {Sensor(Sensor::SensorType::SoilTemperatureSensor), Sensor(Sensor::SensorType::AirTemperatureSensor),
+                                   Sensor(Sensor::SensorType::MoistureSensor), Sensor(Sensor::SensorType::HumiditySensor)};
+
+    // Original mission: the first three rows are analyzed, the last three are still waiting when the checkpoint is written
+    std::vector<std::string> expected;
+    {
+        Field field("FattoriaArancio", 6, 6);
+        buildField(field);
+        Vehicle vehicle("Veicolo1", 20000, Vehicle::VehicleType::FieldVehicle, 0, 0, 20.0, 100.0, sensors, field);
+        ControlCenter controlCenter(field);
+        controlCenter.registerVehicle(vehicle);
+        controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+        controlCenter.sendMovementCommandToVehicle(vehicle, 4, 3);
+        controlCenter.setActiveVehicles(0);
+        produceReadings(field, controlCenter, 0, 2);
+        controlCenter.analyzeData();
+        produceReadings(field, controlCenter, 3, 5);
+        MissionCheckpoint checkpoint(field, controlCenter, directory);
+        std::cout << "Expected first checkpoint: 1, actual: " << checkpoint.writeCheckpoint() << std::endl;
+        std::cout << "Expected results at the checkpoint: 18 cells * 4 = 72, actual: " << controlCenter.getAnalysisResults().size() << std::endl;
+        // Without changes to the field the image is not written again
+        checkpoint.writeCheckpoint();
+        std::cout << "Expected field images: 1, actual: " << checkpoint.getFieldSnapshots() << std::endl;
+        // Periodic checkpoints are written by the background thread
+        checkpoint.startPeriodic(std::chrono::milliseconds(20));
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        checkpoint.stop();
+        std::cout << "Expected more than 2 checkpoints, actual: " << checkpoint.getCheckpoints() << std::endl;
+        // The mission goes on after the checkpoint
+        controlCenter.analyzeData();
+        expected = controlCenter.getAnalysisResults();
+    }
+
+    // A checkpoint interrupted before replacing the state leaves a new field image and extra results that the valid checkpoint ignores
+    std::ofstream(directory + "/field-99.bin") << "partial image";
+    std::ofstream(directory + "/results.txt", std::ios::app) << "Partial result\n";
+
+    // Restarted mission: a new field and control center resume from the checkpoint
+    Field field;
+    Vehicle vehicle("Veicolo1", 20000, Vehicle::VehicleType::FieldVehicle, 0, 0, 20.0, 100.0, sensors, field);
+    ControlCenter controlCenter(field);
+    controlCenter.registerVehicle(vehicle);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    MissionCheckpoint checkpoint(field, controlCenter, directory);
+    std::cout << "Expected restore: 1, actual: " << checkpoint.restore(field) << std::endl;
+    std::cout << "Expected field: FattoriaArancio 6x6 mapped, actual: " << field.getFieldname() << " " << field.getLength() << "x" << field.getWidth()
+              << (field.isMapped() ? " mapped" : " not mapped") << std::endl;
+    std::cout << "Expected vehicle at (4, 3), actual: (" << vehicle.getX() << ", " << vehicle.getY() << ")" << std::endl;
+    std::cout << "Expected surveyed cells: 36, actual: " << checkpoint.getSurveyedCells().size() << std::endl;
+    int images {0};
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        images += entry.path().filename().string().rfind("field-", 0) == 0;
+    }
+    int lines {0};
+    std::ifstream results(directory + "/results.txt");
+    for (std::string line; std::getline(results, line);) {
+        ++lines;
+    }
+    std::cout << "Expected after restore: 1 field image, 72 result lines, actual: " << images << " field image, " << lines << " result lines" << std::endl;
+    controlCenter.setActiveVehicles(0);
+    controlCenter.analyzeData();
+    std::vector<std::string> restored {controlCenter.getAnalysisResults()};
+    std::cout << "Expected results: " << expected.size() << ", actual: " << restored.size() << std::endl;
+    std::cout << "Expected identical results: 1, actual: " << (restored == expected) << std::endl;
+
+    Field empty;
+    ControlCenter emptyControlCenter(empty);
+    MissionCheckpoint missing(empty, emptyControlCenter, directory + "/missing");
+    std::cout << "Expected restore without checkpoint: 0, actual: " << missing.restore(empty) << std::endl;
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Test for the multi-field control center.
+// Four fields are managed by the same process: each one gets its own shard, fed by its own producer thread.
+// The merged report must contain the results of every field, each tagged with the name of its field.
+
+#include "multifieldcontrolcenter.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+
+// Sends the four readings of every plant cell of a field, 16 cells per batch
+void produceReadings(const Field& field, ControlCenter& controlCenter) {
+    std::vector<SoilData> batch;
+    for (int x = 0; x < field.getLength(); ++x) {
+        for (int y = 0; y < field.getWidth(); ++y) {
+            Soil soil;
+            field.peekSoil(x, y, soil);
+            if (!soil.getPlants()) {
+                continue;
+            }
+            batch.push_back({x, y, Sensor::SensorType::SoilTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::AirTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::MoistureSensor, soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::HumiditySensor, soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor)});
+            if (batch.size() == 64) {
+                controlCenter.appendData(std::move(batch));
+                batch = controlCenter.acquireBatch();
+            }
+        }
+    }
+    controlCenter.appendData(std::move(batch));
+    controlCenter.setDataCollectionComplete(true);
+}
+
+int main() {
+    const int fields {4};
+    std::vector<std::unique_ptr<Field>> farm;
+    MultiFieldControlCenter multiField;
+    for (int i = 0; i < fields; ++i) {
+        farm.emplace_back(new Field("Field" + std::to_string(i), 16, 16));
+        farm.back()->modifySoilProperty(0, 15, 0, 15, [i](Soil& soil) { soil.setPlants(true); soil.setSoilMoisture(10.0 + 20.0 * i); });
+        int shard {multiField.addField(*farm.back())};
+        multiField.getControlCenter(shard).setActiveVehicles(1);
+        multiField.getControlCenter(shard).setAnalysisDelay(std::chrono::milliseconds(0));
+    }
+    multiField.start();
+    std::vector<std::thread> producers;
+    for (int shard = 0; shard < multiField.getShardCount(); ++shard) {
+        producers.emplace_back(produceReadings, std::cref(multiField.getField(shard)), std::ref(multiField.getControlCenter(shard)));
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    multiField.waitForAllMissions();
+
+    std::cout << "Expected: 4 shards, 1024 results per field, 4096 results in total" << std::endl;
+    for (int shard = 0; shard < multiField.getShardCount(); ++shard) {
+        MultiFieldControlCenter::ShardReport report {multiField.getShardReport(shard)};
+        std::cout << report.fieldname << ": " << report.results << " results, " << report.priority.batches + report.normal.batches << " batches" << std::endl;
+    }
+    MultiFieldControlCenter::ShardReport merged {multiField.getMergedReport()};
+    std::cout << merged.fieldname << ": " << merged.results << " results, " << merged.priority.batches + merged.normal.batches << " batches" << std::endl;
+    std::vector<std::string> results {multiField.getMergedResults()};
+    std::cout << "Expected: merged results = 4096, first result tagged [Field0], last result tagged [Field3]" << std::endl;
+    std::cout << "Merged results = " << results.size() << ", first: " << results.front().substr(0, 8) << ", last: " << results.back().substr(0, 8) << std::endl;
+    std::cout << "Analyzer threads pinned to a core: " << multiField.getPinnedShards() << " of " << multiField.getShardCount() << std::endl;
+    return 0;
+}
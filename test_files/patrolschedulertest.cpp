@@ -0,0 +1,119 @@
+// Test for the patrol scheduler.
+// Time is simulated by passing explicit time points, so the expected order of the visits is exact.
+
+#include "patrolscheduler.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+void printDispatch(PatrolScheduler& scheduler, int x, int y, PatrolScheduler::Clock::time_point now) {
+    std::pair<int, int> cell;
+    switch (scheduler.dispatch(x, y, 1.0, now, cell)) {
+        case PatrolScheduler::Dispatch::Visit:
+            std::cout << "Vehicle at (" << x << ", " << y << ") sent to (" << cell.first << ", " << cell.second << ")" << std::endl;
+            break;
+        case PatrolScheduler::Dispatch::Wait:
+            std::cout << "Vehicle at (" << x << ", " << y << ") waits" << std::endl;
+            break;
+        case PatrolScheduler::Dispatch::Exhausted:
+            std::cout << "Vehicle at (" << x << ", " << y << ") ends the patrol" << std::endl;
+            break;
+    }
+}
+
+void testPriorities() {
+    using namespace std::chrono_literals;
+    PatrolScheduler::Clock::time_point start {PatrolScheduler::Clock::now()};
+    PatrolScheduler scheduler;
+    scheduler.start(10, 10, {{0, 1}, {5, 5}, {9, 9}, {2, 8}}, 7, start);
+
+    // All cells are visited once: (5, 5) is critical, (9, 9) discrete, the other two optimal.
+    // These visits were not dispatched by the patrol, so they do not count against the budget.
+    scheduler.recordVisit(0, 1, 0, start);
+    scheduler.recordVisit(5, 5, 3, start);
+    scheduler.recordVisit(9, 9, 1, start);
+    scheduler.recordVisit(2, 8, 0, start);
+
+    std::cout << "Expected: (5, 5), then (9, 9)" << std::endl;
+    printDispatch(scheduler, 0, 0, start + 1s);
+    printDispatch(scheduler, 0, 0, start + 1s);
+
+    // Both remaining cells are optimal and equally stale: the nearer one wins
+    std::cout << "Expected: (2, 8) for a vehicle in (3, 9)" << std::endl;
+    printDispatch(scheduler, 3, 9, start + 1s);
+
+    // The critical cell is analyzed again and is now optimal; (0, 1) has been waiting longest and goes first,
+    // then the vehicle standing on (5, 5) reads it again before the farther (2, 8)
+    scheduler.recordVisit(5, 5, 0, start + 100s);
+    scheduler.recordVisit(2, 8, 0, start + 100s);
+    std::cout << "Expected: (0, 1), then (5, 5), then (2, 8)" << std::endl;
+    printDispatch(scheduler, 5, 5, start + 200s);
+    printDispatch(scheduler, 5, 5, start + 200s);
+    printDispatch(scheduler, 5, 5, start + 200s);
+
+    // Every cell is assigned and not yet analyzed: the vehicle has to wait, the patrol is not over
+    std::cout << "Expected: wait" << std::endl;
+    printDispatch(scheduler, 0, 0, start + 205s);
+
+    // (9, 9) was assigned earlier and turns out critical: it returns to the queue.
+    // 3 visits are analyzed and 3 are running: the 7th can be dispatched, then the running visits could exhaust the budget
+    scheduler.recordVisit(9, 9, 3, start + 210s);
+    std::cout << "Expected: (9, 9), then wait (7 visits analyzed or running)" << std::endl;
+    printDispatch(scheduler, 0, 0, start + 220s);
+    printDispatch(scheduler, 0, 0, start + 220s);
+
+    // A visit that produces no analysis releases its cell without using the budget, and the cell leaves the patrol
+    scheduler.releaseCell(2, 8);
+    std::cout << "Expected after a failed visit: (2, 8) no longer patrolled = -1, then wait" << std::endl;
+    std::cout << "Severity of (2, 8) = " << scheduler.getSeverity(2, 8) << std::endl;
+    printDispatch(scheduler, 0, 0, start + 230s);
+    scheduler.recordVisit(0, 1, 0, start + 240s);
+    scheduler.recordVisit(5, 5, 0, start + 240s);
+    scheduler.recordVisit(9, 9, 3, start + 240s);
+    std::cout << "Expected: 6 visits analyzed, then (9, 9), then wait" << std::endl;
+    std::cout << "Visits = " << scheduler.getVisits() << std::endl;
+    printDispatch(scheduler, 0, 0, start + 250s);
+    printDispatch(scheduler, 0, 0, start + 250s);
+    scheduler.recordVisit(9, 9, 3, start + 260s);
+    std::cout << "Expected: end of the patrol (budget of 7 visits exhausted), visits = 7, severity of (9, 9) = 3" << std::endl;
+    printDispatch(scheduler, 0, 0, start + 270s);
+    std::cout << "Visits = " << scheduler.getVisits() << ", severity of (9, 9) = " << scheduler.getSeverity(9, 9) << std::endl;
+}
+
+// A vehicle that finds every cell claimed waits until the running visit ends; when the only cell is released the patrol ends
+void testWaiting() {
+    PatrolScheduler scheduler;
+    scheduler.start(4, 4, {{1, 1}}, 10, PatrolScheduler::Clock::now());
+    std::pair<int, int> cell;
+    scheduler.waitForDispatch(0, 0, 1.0, cell);
+    std::atomic<bool> dispatched {false};
+    PatrolScheduler::Dispatch second {PatrolScheduler::Dispatch::Wait};
+    std::thread vehicle([&scheduler, &dispatched, &second] {
+        std::pair<int, int> next;
+        second = scheduler.waitForDispatch(3, 3, 1.0, next);
+        dispatched = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    std::cout << "Expected second vehicle waiting while the cell is claimed: 1, actual: " << !dispatched << std::endl;
+    scheduler.recordVisit(1, 1, 1, PatrolScheduler::Clock::now());
+    vehicle.join();
+    std::cout << "Expected second vehicle sent to the cell after the analysis: 1, actual: " << (second == PatrolScheduler::Dispatch::Visit) << std::endl;
+
+    std::thread third([&scheduler, &second] {
+        std::pair<int, int> next;
+        second = scheduler.waitForDispatch(0, 0, 1.0, next);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    scheduler.releaseCell(1, 1);
+    third.join();
+    std::cout << "Expected end of the patrol after the only cell is released: 1, actual: " << (second == PatrolScheduler::Dispatch::Exhausted) << std::endl;
+    std::cout << "Expected analyzed visits: 1, actual: " << scheduler.getVisits() << std::endl;
+}
+
+int main() {
+    testPriorities();
+    testWaiting();
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Test for the sensor trace recording and replay.
+// The batches received by a control center are recorded; replaying the trace into a new control center must give the same results,
+// both as fast as possible and at the recorded pace.
+
+#include "tracerecorder.h"
+#include "tracereplayer.h"
+#include "controlcenter.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <iterator>
+
+// Sends the four readings of every plant cell, one batch per row, with a pause between batches
+void produceReadings(const Field& field, ControlCenter& controlCenter) {
+    for (int x = 0; x < field.getLength(); ++x) {
+        std::vector<SoilData> batch {controlCenter.acquireBatch()};
+        for (int y = 0; y < field.getWidth(); ++y) {
+            Soil soil;
+            field.peekSoil(x, y, soil);
+            batch.push_back({x, y, Sensor::SensorType::SoilTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::AirTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::MoistureSensor, soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)});
+            batch.push_back({x, y, Sensor::SensorType::HumiditySensor, soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor)});
+        }
+        controlCenter.appendData(std::move(batch), 7);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    controlCenter.setDataCollectionComplete(true);
+}
+
+// Replays a trace into a new control center and returns its results
+std::vector<std::string> replayInto(const Field& field, const std::string& path, TraceReplayer::Pace pace, TraceReplayer::ReplayReport& report) {
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+    TraceReplayer replayer;
+    replayer.open(path);
+    report = replayer.replay(controlCenter, pace);
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    analyzer.join();
+    return controlCenter.getAnalysisResults();
+}
+
+int main() {
+    Field field("FattoriaCeleste", 8, 8);
+    field.modifySoilProperty(0, 7, 0, 7, [](Soil& soil) { soil.setPlants(true); });
+    field.modifySoilProperty(0, 3, 0, 7, [](Soil& soil) { soil.setSoilMoisture(7.0); }); // Critical: these rows go to the priority lane
+    field.modifySoilProperty(4, 7, 4, 7, [](Soil& soil) { soil.setSoilType(Soil::SoilType::clay); });
+
+    // Recording of a mission
+    std::vector<std::string> expected;
+    TraceRecorder recorder;
+    recorder.open("sensor_trace_test.bin");
+    {
+        ControlCenter controlCenter(field);
+        controlCenter.setTraceRecorder(&recorder);
+        controlCenter.setActiveVehicles(1);
+        controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+        std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+        produceReadings(field, controlCenter);
+        controlCenter.waitForMissionComplete();
+        analyzer.join();
+        expected = controlCenter.getAnalysisResults();
+    }
+    recorder.close();
+    std::cout << "Expected recorded batches: 8, readings: 256, actual: " << recorder.getRecordedBatches() << ", " << recorder.getRecordedReadings() << std::endl;
+
+    // The first record keeps the vehicle id and the readings of the batch
+    TraceReplayer reader;
+    std::vector<SoilData> batch;
+    int vehicleid {-1};
+    std::uint64_t timestamp {0};
+    bool read {reader.open("sensor_trace_test.bin") && reader.nextBatch(batch, vehicleid, timestamp)};
+    std::cout << "Expected first record: 1, vehicle 7, 32 readings, actual: " << read << ", vehicle " << vehicleid << ", " << batch.size() << " readings" << std::endl;
+
+    // Replay as fast as possible
+    TraceReplayer::ReplayReport fast;
+    std::vector<std::string> fastResults {replayInto(field, "sensor_trace_test.bin", TraceReplayer::Pace::AsFastAsPossible, fast)};
+    // All the batches arrive together, so the priority lane may be analyzed earlier than during the recording: the order of the results can change
+    std::vector<std::string> sortedExpected {expected};
+    std::sort(sortedExpected.begin(), sortedExpected.end());
+    std::sort(fastResults.begin(), fastResults.end());
+    std::cout << "Expected fast replay: 8 batches, same results, faster than recorded: actual " << fast.batches << " batches, "
+              << (fastResults == sortedExpected ? "same" : "different") << " results, "
+              << (fast.elapsedseconds < fast.recordedseconds ? "faster" : "slower") << " than recorded" << std::endl;
+
+    // Replay at the recorded pace
+    TraceReplayer::ReplayReport paced;
+    std::vector<std::string> pacedResults {replayInto(field, "sensor_trace_test.bin", TraceReplayer::Pace::Recorded, paced)};
+    std::cout << "Expected paced replay: identical results, at least the recorded duration: actual "
+              << (pacedResults == expected ? "identical" : "different") << " results, "
+              << (paced.elapsedseconds >= paced.recordedseconds ? "at least" : "less than") << " the recorded duration" << std::endl;
+
+    // A trace cut in the middle of a record is replayed up to the last complete record
+    {
+        std::ifstream source("sensor_trace_test.bin", std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+        std::ofstream truncated("sensor_trace_truncated.bin", std::ios::binary);
+        truncated.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 5));
+    }
+    TraceReplayer::ReplayReport cut;
+    replayInto(field, "sensor_trace_truncated.bin", TraceReplayer::Pace::AsFastAsPossible, cut);
+    std::cout << "Expected truncated replay: 7 batches, complete = 0, actual: " << cut.batches << " batches, complete = " << cut.complete << std::endl;
+
+    // A record that declares more readings than the bytes left in the file is rejected as truncated, without allocating them
+    {
+        std::fstream corrupt("sensor_trace_truncated.bin", std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint32_t readings {0xFFFFFFFFu};
+        corrupt.seekp(static_cast<std::streamoff>(TraceRecorder::HeaderSize + 12));
+        corrupt.write(reinterpret_cast<const char*>(&readings), sizeof(readings));
+    }
+    TraceReplayer corrupt;
+    bool corruptRead {corrupt.open("sensor_trace_truncated.bin") && corrupt.nextBatch(batch, vehicleid, timestamp)};
+    std::cout << "Expected oversized record: read 0, truncated 1, actual: read " << corruptRead << ", truncated " << corrupt.isTruncated() << std::endl;
+
+    {
+        std::ofstream notATrace("sensor_trace_invalid.bin");
+        notATrace << "This file is not a sensor trace";
+    }
+    TraceReplayer invalid;
+    std::cout << "Expected open of a file that is not a trace: 0, actual: " << invalid.open("sensor_trace_invalid.bin") << std::endl;
+    std::remove("sensor_trace_invalid.bin");
+    std::remove("sensor_trace_test.bin");
+    std::remove("sensor_trace_truncated.bin");
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Test for the adaptive survey planner.
+// A uniform 32x32 field with plants everywhere contains a small dry hotspot. The survey starts from 8x8 blocks,
+// the readings of each phase are sent straight to the control center, and the planner refines only where needed.
+// Expected: far fewer visits than plant cells, and every hotspot cell visited in person.
+
+#include "surveyplanner.h"
+#include "controlcenter.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+void surveyCells(const Field& field, ControlCenter& controlCenter, const std::vector<std::pair<int, int>>& cells) {
+    controlCenter.setActiveVehicles(1);
+    std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+    std::vector<SoilData> batch;
+    for (const auto& cell : cells) {
+        Soil soil;
+        field.peekSoil(cell.first, cell.second, soil);
+        batch.push_back({cell.first, cell.second, Sensor::SensorType::SoilTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)});
+        batch.push_back({cell.first, cell.second, Sensor::SensorType::AirTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor)});
+        batch.push_back({cell.first, cell.second, Sensor::SensorType::MoistureSensor, soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)});
+        batch.push_back({cell.first, cell.second, Sensor::SensorType::HumiditySensor, soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor)});
+    }
+    controlCenter.appendData(std::move(batch));
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    analyzer.join();
+}
+
+int main() {
+    Field field("Test", 32, 32);
+    field.modifySoilProperty(0, 31, 0, 31, [](Soil& soil) {
+        soil.setSoilType(Soil::SoilType::loam);
+        soil.setPlants(true);
+        soil.setSoilMoisture(25);
+        soil.setAirTemperature(22.0);
+        soil.setAirHumidity(60.0);
+    });
+    // Dry hotspot
+    field.modifySoilProperty(17, 19, 9, 11, [](Soil& soil) { soil.setSoilMoisture(2); });
+
+    ControlCenter controlCenter(field);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    controlCenter.setBufferWatermark(1 << 16);
+    SurveyPlanner planner(field, 8);
+    std::vector<std::pair<int, int>> cells {planner.initialCells()};
+    while (!cells.empty()) {
+        surveyCells(field, controlCenter, cells);
+        cells = planner.refine(controlCenter);
+    }
+
+    std::cout << "Expected: visited cells well below 1024 (about one tenth or less)" << std::endl;
+    std::cout << "Phases: " << planner.getPhase() << ", visited cells: " << planner.getVisitedCells() << " out of " << planner.getPlantCells()
+              << ", refined blocks: " << planner.getRefinedBlocks() << std::endl;
+    int hotspotVisited {0};
+    for (int x = 17; x <= 19; ++x) {
+        for (int y = 9; y <= 11; ++y) {
+            if (planner.getRepresentative(x, y) == std::make_pair(x, y)) {
+                ++hotspotVisited;
+            }
+        }
+    }
+    std::cout << "Expected: hotspot cells visited = 9" << std::endl;
+    std::cout << "Hotspot cells visited = " << hotspotVisited << std::endl;
+    std::pair<int, int> far {planner.getRepresentative(2, 30)};
+    std::cout << "Expected: cell (2, 30) represented by another cell of its block" << std::endl;
+    std::cout << "Cell (2, 30) represented by (" << far.first << ", " << far.second << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Test for the single-producer single-consumer telemetry ring.
+// Samples are read in the order they were published, also after the indices wrap around the buffer;
+// when the buffer is full new samples are dropped and counted, never overwriting the ones not yet read.
+// A producer and a consumer on two threads check that no sample is lost, duplicated or reordered.
+
+#include "telemetry.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+TelemetrySample makeSample(int sequence) {
+    return {std::chrono::steady_clock::now(), 1, sequence, 0, 100.0f, TelemetrySample::State::Moving};
+}
+
+void testWrapAroundAndDrops() {
+    TelemetryRing ring;
+    const int capacity {static_cast<int>(TelemetryRing::Capacity)};
+    int published {0};
+    for (int sequence = 0; sequence < capacity; ++sequence) {
+        published += ring.publish(makeSample(sequence));
+    }
+    std::cout << "Expected accepted samples: " << capacity << ", actual: " << published << std::endl;
+    bool accepted {ring.publish(makeSample(capacity))};
+    std::cout << "Expected sample on a full ring dropped: 0 and 1 dropped, actual: " << accepted << " and " << ring.getDropped() << " dropped" << std::endl;
+
+    // Half of the samples are read, then the producer writes past the end of the buffer
+    TelemetrySample sample;
+    bool ordered {true};
+    for (int sequence = 0; sequence < capacity / 2; ++sequence) {
+        ordered = ring.consume(sample) && sample.x == sequence && ordered;
+    }
+    for (int sequence = capacity; sequence < capacity + capacity / 2; ++sequence) {
+        ordered = ring.publish(makeSample(sequence)) && ordered;
+    }
+    std::cout << "Expected ring full again, next sample dropped: 0, actual: " << ring.publish(makeSample(-1)) << std::endl;
+
+    // The oldest samples are the ones not yet read: the dropped ones never replace them
+    std::vector<TelemetrySample> samples;
+    std::size_t drained {ring.drain(samples)};
+    for (std::size_t index = 0; index < samples.size(); ++index) {
+        ordered = samples[index].x == capacity / 2 + static_cast<int>(index) && ordered;
+    }
+    std::cout << "Expected drained samples: " << capacity << ", actual: " << drained << std::endl;
+    std::cout << "Expected samples in publication order across the wrap-around: 1, actual: " << ordered << std::endl;
+    std::cout << "Expected empty ring after drain: 0, actual: " << ring.consume(sample) << std::endl;
+    std::cout << "Expected dropped samples: 2, actual: " << ring.getDropped() << std::endl;
+}
+
+// The producer publishes count samples without waiting; if retry is true a dropped sample is published again until it is accepted
+void producerConsumer(int count, bool retry) {
+    TelemetryRing ring;
+    std::atomic<bool> done {false};
+    std::thread producer([&ring, &done, count, retry] {
+        for (int sequence = 0; sequence < count; ++sequence) {
+            while (!ring.publish(makeSample(sequence)) && retry) {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+    int received {0};
+    int last {-1};
+    bool ordered {true};
+    TelemetrySample sample;
+    while (true) {
+        bool finished {done.load()};
+        std::vector<TelemetrySample> samples;
+        if (ring.consume(sample)) {
+            samples.push_back(sample);
+        }
+        ring.drain(samples);
+        for (const TelemetrySample& read : samples) {
+            ordered = read.x > last && ordered;
+            last = read.x;
+            ++received;
+        }
+        if (finished && samples.empty()) {
+            break;
+        }
+    }
+    producer.join();
+    std::size_t dropped {ring.getDropped()};
+    if (retry) {
+        std::cout << "Expected with retries: " << count << " samples, all in order, actual: " << received << " samples, "
+                  << (ordered && last == count - 1 ? "all in order" : "lost or reordered") << std::endl;
+    } else {
+        std::cout << "Expected without retries: received + dropped = " << count << ", increasing order, actual: " << received + dropped << ", "
+                  << (ordered ? "increasing order" : "reordered") << " (" << dropped << " dropped)" << std::endl;
+    }
+}
+
+int main() {
+    testWrapAroundAndDrops();
+    producerConsumer(200000, true);
+    producerConsumer(200000, false);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Test for the territory partitioner.
+// The plants of a 20x20 field are divided among four vehicles, once with the old static split of the plant list
+// and once with the partitioner, and the total travel distance of the two plans is printed.
+// The test then lets one vehicle finish its territory and checks that it takes work from the slowest vehicle.
+
+#include "territorypartitioner.h"
+#include <iostream>
+#include <vector>
+
+int main() {
+    std::vector<std::pair<int, int>> plants;
+    for (int x = 0; x < 20; ++x) {
+        for (int y = 0; y < 20; ++y) {
+            if ((x + 2 * y) % 3 != 0) {
+                plants.emplace_back(x, y);
+            }
+        }
+    }
+    std::vector<TerritoryPartitioner::VehicleProfile> vehicles = {{0, 0, 1.0}, {19, 0, 1.0}, {0, 19, 1.0}, {19, 19, 2.0}};
+
+    // Static split: consecutive slices of the plant list, visited in list order
+    int staticLength {0};
+    std::size_t slice {plants.size() / vehicles.size()};
+    for (std::size_t v = 0; v < vehicles.size(); ++v) {
+        auto first = plants.begin() + v * slice;
+        auto last = (v + 1 == vehicles.size()) ? plants.end() : first + slice;
+        staticLength += TerritoryPartitioner::routeLength(vehicles[v].x, vehicles[v].y, std::vector<std::pair<int, int>>(first, last));
+    }
+
+    TerritoryPartitioner partitioner;
+    partitioner.partition(plants, vehicles);
+    int partitionedLength {0};
+    std::size_t assigned {0};
+    for (int v = 0; v < partitioner.getVehicleCount(); ++v) {
+        std::vector<std::pair<int, int>> territory = partitioner.getTerritory(v);
+        assigned += territory.size();
+        partitionedLength += TerritoryPartitioner::routeLength(vehicles[v].x, vehicles[v].y, territory);
+        std::cout << "Vehicle " << v << " (speed " << vehicles[v].speed << "): " << territory.size() << " cells, route length "
+                  << TerritoryPartitioner::routeLength(vehicles[v].x, vehicles[v].y, territory) << std::endl;
+    }
+    std::cout << "Expected: " << plants.size() << " cells assigned, the fastest vehicle gets the largest territory" << std::endl;
+    std::cout << "Assigned cells: " << assigned << std::endl;
+    std::cout << "Expected: partitioned travel much shorter than static travel" << std::endl;
+    std::cout << "Static split travel: " << staticLength << " cells, partitioned travel: " << partitionedLength << " cells" << std::endl;
+
+    // Vehicle 0 reads its whole territory, then takes half of the remaining work of the most loaded vehicle
+    std::pair<int, int> cell;
+    std::size_t own {partitioner.getRemaining(0)};
+    for (std::size_t i = 0; i < own; ++i) {
+        partitioner.nextCell(0, cell.first, cell.second, cell);
+    }
+    std::cout << "Expected: remaining cells of vehicle 0 = 0, rebalances = 0" << std::endl;
+    std::cout << "Remaining cells of vehicle 0 = " << partitioner.getRemaining(0) << ", rebalances = " << partitioner.getRebalances() << std::endl;
+    bool stolen {partitioner.nextCell(0, cell.first, cell.second, cell)};
+    std::cout << "Expected: work taken = yes, rebalances = 1" << std::endl;
+    std::cout << "Work taken = " << (stolen ? "yes" : "no") << ", rebalances = " << partitioner.getRebalances() << std::endl;
+
+    // Once every territory is empty no more cells are handed out
+    for (int v = 0; v < partitioner.getVehicleCount(); ++v) {
+        while (partitioner.nextCell(v, cell.first, cell.second, cell)) {}
+    }
+    std::cout << "Expected: no cells left = yes" << std::endl;
+    std::cout << "No cells left = " << (partitioner.nextCell(0, 0, 0, cell) ? "no" : "yes") << std::endl;
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Test for the lockstep tick engine.
+// Eight vehicles read every plant of a 30x30 field; the same mission is run with one thread and with four threads
+// and the results are printed next to each other: since collisions are resolved in index order, they must be identical.
+
+#include "tickengine.h"
+#include "controlcenter.h"
+#include "field.h"
+#include "soil.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+struct MissionResult {
+    std::size_t ticks;
+    std::size_t readings;
+    std::size_t collisionwaits;
+    std::size_t results;
+    bool parked;
+};
+
+MissionResult runMission(Field& field, int threads) {
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setBufferWatermark(4096);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+
+    TickEngine engine(field, controlCenter, 0.5, threads);
+    const int vehicles {8};
+    std::vector<std::vector<std::pair<int, int>>> routes(vehicles);
+    int plant {0};
+    field.viewPlants(0, field.getLength() - 1, 0, field.getWidth() - 1).forEach([&routes, &plant](int x, int y, bool plants) {
+        if (plants) {
+            routes[plant++ % vehicles].emplace_back(x, y);
+        }
+    });
+    for (int i = 0; i < vehicles; ++i) {
+        int index {engine.addVehicle(20000 + i, i, 0, 1.0 + 0.1 * i, 100.0f)};
+        engine.assignRoute(index, routes[i]);
+    }
+    MissionResult result {};
+    result.ticks = engine.run(100000);
+    result.readings = engine.getReadingsSent();
+    result.collisionwaits = engine.getCollisionWaits();
+    result.parked = engine.isFinished();
+
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    analyzer.join();
+    result.results = controlCenter.getAnalysisResults().size();
+    return result;
+}
+
+void printResult(const char* label, const MissionResult& result) {
+    std::cout << label << ": ticks = " << result.ticks << ", readings = " << result.readings
+              << ", collision waits = " << result.collisionwaits << ", analysis results = " << result.results
+              << ", all parked = " << (result.parked ? "yes" : "no") << std::endl;
+}
+
+int main() {
+    Field field("Test", 30, 30);
+    // 60 plants in two blocks, so that the vehicles cross each other's paths
+    field.modifySoilProperty(5, 9, 5, 10, [](Soil& soil) { soil.setPlants(true); });
+    field.modifySoilProperty(20, 24, 20, 25, [](Soil& soil) { soil.setPlants(true); soil.setSoilMoisture(5); });
+
+    MissionResult single = runMission(field, 1);
+    MissionResult parallel = runMission(field, 4);
+    std::cout << "Expected: readings = 240, analysis results = 240, all parked = yes, same values on both lines" << std::endl;
+    printResult("1 thread", single);
+    printResult("4 threads", parallel);
+    bool same {single.ticks == parallel.ticks && single.readings == parallel.readings && single.collisionwaits == parallel.collisionwaits};
+    std::cout << "Deterministic: " << (same ? "yes" : "no") << std::endl;
+    return 0;
+}
@@ -1,6 +1,12 @@
 #include "field.h"
 #include "vehicle.h"
 #include "sensor.h"
+#include "motionmodel.h"
+#include "controlcenter.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
 
 void testVehicleMovement()
 {
@@ -12,16 +18,93 @@ void testVehicleMovement()
     drone.setPosition(2, 9);
     drone. moveToTarget(9, 2);
     robot.readDataFromCurrentCell();
+    // Closed-form travel estimate: from (9, 7) to (0, 9) the Chebyshev distance is 9 cells, at 1 cell/s the ETA is 9 s
+    auto eta = robot.estimateArrival(0, 9);
+    std::cout << "Estimated travel time to (0, 9): " << std::chrono::duration<double>(eta - std::chrono::steady_clock::now()).count() << " s" << std::endl;
+    // Intermediate position of a traverse, computed without simulating the single steps
+    MotionModel traverse(0, 0, 9, 4, 2.0, 5.0f, std::chrono::steady_clock::now());
+    auto halfway = traverse.positionAfterSteps(traverse.getDistance() / 2);
+    std::cout << "Traverse (0, 0) -> (9, 4): " << traverse.getDistance() << " cells, " << traverse.getDuration().count() << " s, "
+              << traverse.getBatteryUse() << "% battery, halfway at (" << halfway.first << ", " << halfway.second << ")" << std::endl;
     //Some test for errors checking: remove comment to see the error message
     //Vehicle robot2("TestVehicle2", Vehicle::VehicleType::FieldVehicle, 0, 0, -1.0, 100.0, {}, field);
     //Vehicle robot3("TestVehicle3", Vehicle::VehicleType::FieldVehicle, -10, 0, 1.0, 100.0, {}, field);
     //Vehicle robot4("TestVehicle4", Vehicle::VehicleType::FieldVehicle, 10, 10, 1.0, 100.0, {}, field);
 }
 
+// Readings are sent in batches of cells; a batch that waits too long is sent on the next movement command
+void testBatching()
+{
+    Field field("TestBatchField", 10, 10);
+    ControlCenter controlCenter(field);
+    Vehicle robot("BatchVehicle", 10002, Vehicle::VehicleType::FieldVehicle, 0, 0, 10.0, 100.0, {Sensor::SensorType::MoistureSensor, Sensor::SensorType::HumiditySensor}, field);
+    robot.setFlushPolicy(3, std::chrono::hours(1));
+    robot.readAndSendData(controlCenter);
+    robot.setPosition(0, 1);
+    robot.readAndSendData(controlCenter);
+    std::cout << "Expected empty buffer after 2 of 3 cells: 1, actual: " << controlCenter.isBufferEmpty() << std::endl;
+    robot.setPosition(0, 2);
+    robot.readAndSendData(controlCenter);
+    std::cout << "Expected batch sent after 3 cells: 1, actual: " << !controlCenter.isBufferEmpty() << std::endl;
+
+    ControlCenter idleCenter(field);
+    robot.setFlushPolicy(8, std::chrono::milliseconds(600));
+    robot.readAndSendData(idleCenter);
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    std::cout << "Expected stale batch still on the vehicle: 1, actual: " << idleCenter.isBufferEmpty() << std::endl;
+    robot.moveToTarget(1, 2);
+    std::cout << "Expected stale batch sent by the movement command: 1, actual: " << !idleCenter.isBufferEmpty() << std::endl;
+}
+
+// A cell that cannot be reached with a full battery from the base is reported and skipped instead of recharging forever
+void testUnreachableCell()
+{
+    Field field("TestRangeField", 30, 30);
+    ControlCenter controlCenter(field);
+    Vehicle robot("RangeVehicle", 10003, Vehicle::VehicleType::FieldVehicle, 25, 25, 10.0, 5.0, {Sensor::SensorType::MoistureSensor}, field);
+    auto start = std::chrono::steady_clock::now();
+    robot.readAndSendData(controlCenter);
+    robot.flushData(controlCenter);
+    double elapsed {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    std::cout << "Expected unreachable cell skipped without recharging: 1, actual: " << (elapsed < 1.0) << std::endl;
+    std::cout << "Expected no data from the unreachable cell: 1, actual: " << controlCenter.isBufferEmpty() << std::endl;
+    std::cout << "Expected vehicle still at (25, 25), actual: (" << robot.getX() << ", " << robot.getY() << ")" << std::endl;
+}
+
+// Over the buffer watermark a vehicle waits in appendData until the control center analyses some data
+void testBackpressure()
+{
+    Field field("TestPressureField", 10, 10);
+    ControlCenter controlCenter(field);
+    controlCenter.setActiveVehicles(1);
+    controlCenter.setAnalysisDelay(std::chrono::milliseconds(0));
+    controlCenter.setBufferWatermark(4);
+    std::vector<SoilData> first;
+    for (int y = 0; y < 6; ++y) {
+        first.push_back({0, y, Sensor::SensorType::MoistureSensor, 50.0});
+    }
+    controlCenter.appendData(std::move(first));
+    std::atomic<bool> released {false};
+    std::thread vehicle([&controlCenter, &released] {
+        controlCenter.appendData({{1, 0, Sensor::SensorType::MoistureSensor, 50.0}});
+        released = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    std::cout << "Expected blocked appendData over the watermark: 1, actual: " << !released << std::endl;
+    std::thread analyzer([&controlCenter] { controlCenter.analyzeData(); });
+    vehicle.join();
+    std::cout << "Expected appendData released after the analysis: 1, actual: " << released << std::endl;
+    controlCenter.setDataCollectionComplete(true);
+    controlCenter.waitForMissionComplete();
+    analyzer.join();
+}
 
 int main()
 {
     testVehicleMovement();
+    testBatching();
+    testBackpressure();
+    testUnreachableCell();
 
 
     return 0;
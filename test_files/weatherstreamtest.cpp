@@ -0,0 +1,106 @@
+// Test for the streaming weather series.
+// The rows with the same hour form one step, applied to the field as one batched write with a single new generation;
+// invalid rows are reported and skipped, and a season-long series is replayed one step at a time.
+
+#include "weatherstream.h"
+#include "field.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+float airTemperatureAt(const Field& field, int x, int y) {
+    Soil soil;
+    field.peekSoil(x, y, soil);
+    return soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor);
+}
+
+void testSmallSeries() {
+    {
+        std::ofstream series("weather_series_test.csv");
+        series << "hour,startlength,endlength,startwidth,endwidth,airtemperature,airhumidity\n"
+               << "0,0,4,0,9,25.5,40\n"
+               << "0,5,9,0,9,15,70\n"
+               << "\n"
+               << "1,0,9,0,4,30,35\n"
+               << "1,0,9,5,9,abc,35\n"     // Not a number
+               << "1,3,2,0,9,20,50\n"      // Empty rectangle
+               << "1,0,9,0,9,20,120\n"     // Humidity out of range
+               << "0.5,0,9,0,9,20,50\n"    // Earlier than the previous row
+               << "2,0,20,0,9,10,90\n"     // Outside the field: skipped when applied
+               << "2,8,9,8,9,5,95\r\n";
+    }
+    Field field("FattoriaVerde", 10, 10);
+    WeatherStream stream;
+    std::cout << "Expected open: 1, actual: " << stream.open("weather_series_test.csv") << std::endl;
+    std::uint64_t generation {field.getGeneration()};
+    std::vector<double> hours;
+    std::size_t steps {stream.replay(field, [&hours](const WeatherStream::WeatherStep& step) { hours.push_back(step.hour); })};
+    std::cout << "Expected 3 steps at hours 0 1 2, actual: " << steps << " steps at hours";
+    for (double hour : hours) {
+        std::cout << " " << hour;
+    }
+    std::cout << std::endl;
+    std::cout << "Expected regions: 5, invalid lines: 4, actual: " << stream.getRegions() << ", " << stream.getInvalidLines() << std::endl;
+    std::cout << "Expected new generations: 3, actual: " << field.getGeneration() - generation << std::endl;
+    std::cout << "Expected air temperatures 30 25.5 15 5, actual: " << airTemperatureAt(field, 0, 0) << " " << airTemperatureAt(field, 0, 7) << " "
+              << airTemperatureAt(field, 6, 7) << " " << airTemperatureAt(field, 9, 9) << std::endl;
+
+    // The soil temperature follows the new air conditions, as with the Soil setters
+    Soil soil;
+    field.peekSoil(6, 7, soil);
+    Soil expected;
+    expected.setAirTemperature(15.0f);
+    expected.setAirHumidity(70.0);
+    std::cout << "Expected soil temperature: " << expected.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)
+              << ", actual: " << soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor) << std::endl;
+
+    // The first step changed two rectangles with the same generation
+    std::vector<Field::ChangeRecord> changes;
+    field.getChangesSince(generation, changes);
+    int firstStep {0};
+    for (const Field::ChangeRecord& change : changes) {
+        firstStep += change.generation == generation + 1;
+    }
+    std::cout << "Expected rectangles of the first step: 2, actual: " << firstStep << std::endl;
+    std::remove("weather_series_test.csv");
+
+    WeatherStream missing;
+    std::cout << "Expected open of a missing series: 0, actual: " << missing.open("weather_series_missing.csv") << std::endl;
+}
+
+// A season of hourly weather (about 4400 steps of 16 regions) on a 200 x 200 field
+void testSeason() {
+    {
+        std::ofstream series("weather_season_test.csv");
+        series << "hour,startlength,endlength,startwidth,endwidth,airtemperature,airhumidity\n";
+        for (int hour = 0; hour < 183 * 24; ++hour) {
+            for (int region = 0; region < 16; ++region) {
+                int x {(region / 4) * 50};
+                int y {(region % 4) * 50};
+                series << hour << "," << x << "," << x + 49 << "," << y << "," << y + 49 << "," << 10 + (hour + region) % 20 << "," << 40 + (hour * 7 + region) % 50 << "\n";
+            }
+        }
+    }
+    Field field("FattoriaStagionale", 200, 200);
+    WeatherStream stream;
+    stream.open("weather_season_test.csv");
+    std::uint64_t generation {field.getGeneration()};
+    auto start = std::chrono::steady_clock::now();
+    std::size_t steps {stream.replay(field)};
+    double seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    std::cout << "Expected season: 4392 steps, 70272 regions, 4392 generations, actual: " << steps << " steps, " << stream.getRegions() << " regions, "
+              << field.getGeneration() - generation << " generations" << std::endl;
+    std::cout << "Expected last air temperature: " << 10 + (183 * 24 - 1 + 15) % 20 << ", actual: " << airTemperatureAt(field, 199, 199) << std::endl;
+    std::cout << "Season replay: " << seconds << " s, " << field.getLength() * field.getWidth() * steps / seconds / 1e6 << " million cells per second" << std::endl;
+    std::remove("weather_season_test.csv");
+}
+
+int main() {
+    testSmallSeries();
+    testSeason();
+    return 0;
+}
@@ -0,0 +1,361 @@
+#include "tickengine.h"
+#include "controlcenter.h"
+#include "soil.h"
+#include "sensor.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// Costruttore: tickseconds è la durata simulata di un tick, threads il numero di thread usati dalle fasi parallele (compreso il thread chiamante)
+TickEngine::TickEngine(const Field& field, ControlCenter& controlCenter, double tickseconds, int threads)
+    : field_{field},
+    controlcenter_{controlCenter},
+    tickseconds_{tickseconds},
+    length_{field.getLength()},
+    width_{field.getWidth()},
+    readticks_{0},
+    rechargeticks_{0},
+    tick_{0},
+    collisionwaits_{0},
+    readingssent_{0},
+    occupancy_(static_cast<std::size_t>(field.getLength()) * field.getWidth(), 0),
+    generation_{0},
+    pendingworkers_{0},
+    stopping_{false}
+    {
+        if (tickseconds <= 0) {
+            std::cerr << "Invalid tick duration: it must be greater than 0." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // Come nei veicoli: 100 ms per ognuno dei quattro sensori e 15 secondi di ricarica
+        readticks_ = std::max(1, static_cast<int>(std::ceil(0.1 * Sensor::SensorTypeCount / tickseconds)));
+        rechargeticks_ = std::max(1, static_cast<int>(std::ceil(15.0 / tickseconds)));
+        for (int worker = 1; worker < threads; ++worker) {
+            workers_.emplace_back(&TickEngine::workerLoop, this, worker);
+        }
+    }
+
+// Distruttore: i thread del gruppo vengono fermati e attesi
+TickEngine::~TickEngine() {
+    {
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        stopping_ = true;
+    }
+    cvwork_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Funzione per aggiungere un veicolo alla simulazione: restituisce il suo indice nelle colonne di stato
+int TickEngine::addVehicle(int id, int x, int y, double speed, float battery) {
+    if (x < 0 || x >= length_ || y < 0 || y >= width_) {
+        std::cerr << "Invalid coordinates: vehicle is out of field." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (speed <= 0) {
+        std::cerr << "Invalid speed: speed must be greater than 0." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (speed * tickseconds_ > 1.0) {
+        std::cerr << "Warning: vehicle " << id << " is faster than one cell per tick and will be limited to one cell per tick." << std::endl;
+    }
+    int index {getVehicleCount()};
+    ids_.push_back(id);
+    x_.push_back(x);
+    y_.push_back(y);
+    speed_.push_back(speed);
+    progress_.push_back(0.0);
+    battery_.push_back(battery);
+    state_.push_back(State::Moving);
+    timer_.push_back(0);
+    tripchecked_.push_back(0);
+    recharged_.push_back(0);
+    routebegin_.push_back(routecells_.size());
+    routeend_.push_back(routecells_.size());
+    routepos_.push_back(routecells_.size());
+    candidates_.insert(candidates_.end(), CandidateMoves, -1);
+    samples_.insert(samples_.end(), Sensor::SensorTypeCount, SoilData{x, y, Sensor::SensorType::MoistureSensor, 0.0});
+    sampled_.push_back(0);
+    int cell {cellIndex(x, y)};
+    if (cell != 0) { // La base (0, 0) può ospitare più veicoli
+        occupancy_[cell] = index + 1;
+    }
+    return index;
+}
+
+// Funzione per assegnare a un veicolo il percorso di celle da leggere: va chiamata prima di avviare la simulazione
+void TickEngine::assignRoute(int index, const std::vector<std::pair<int, int>>& cells) {
+    if (index < 0 || index >= getVehicleCount()) {
+        std::cerr << "Invalid vehicle index: " << index << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // Il percorso viene aggiunto in coda alle celle di tutti i percorsi e sostituisce quello precedente del veicolo
+    routebegin_[index] = routecells_.size();
+    routepos_[index] = routecells_.size();
+    for (const auto& cell : cells) {
+        if (cell.first < 0 || cell.first >= length_ || cell.second < 0 || cell.second >= width_) {
+            std::cerr << "Invalid route cell (" << cell.first << ", " << cell.second << "): it is out of field." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        routecells_.push_back(cellIndex(cell.first, cell.second));
+    }
+    routeend_[index] = routecells_.size();
+    state_[index] = State::Moving;
+    tripchecked_[index] = 0;
+}
+
+// Funzione che fa avanzare tutta la flotta di un tick
+void TickEngine::step() {
+    parallelFor([this](std::size_t begin, std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            planVehicle(index);
+        }
+    });
+    resolveMoves();
+    sendSamples();
+    ++tick_;
+}
+
+// Funzione che esegue la simulazione finché tutti i veicoli non sono parcheggiati alla base o non si raggiunge il numero massimo di tick.
+// Restituisce il numero di tick eseguiti.
+std::size_t TickEngine::run(std::size_t maxticks) {
+    std::size_t executed {0};
+    while (!isFinished() && executed < maxticks) {
+        step();
+        ++executed;
+    }
+    return executed;
+}
+
+// Funzione che indica se tutti i veicoli hanno terminato il proprio percorso e sono tornati alla base
+bool TickEngine::isFinished() const {
+    return std::all_of(state_.begin(), state_.end(), [](State state) { return state == State::Parked; });
+}
+
+// Fase parallela: aggiornamento dello stato di un veicolo e calcolo delle sue mosse candidate. Il veicolo modifica solo i propri dati.
+void TickEngine::planVehicle(std::size_t index) {
+    sampled_[index] = 0;
+    std::fill(candidates_.begin() + index * CandidateMoves, candidates_.begin() + (index + 1) * CandidateMoves, -1);
+    switch (state_[index]) {
+        case State::Parked:
+            return;
+        case State::Recharging:
+            if (--timer_[index] <= 0) {
+                battery_[index] = 100.0f;
+                state_[index] = State::Moving;
+                tripchecked_[index] = 0;
+                recharged_[index] = 1;
+            }
+            return;
+        case State::Reading:
+            if (--timer_[index] <= 0) {
+                sampleCell(index);
+                battery_[index] = std::max(0.0f, battery_[index] - BatteryPerReading);
+                ++routepos_[index];
+                state_[index] = State::Moving;
+                tripchecked_[index] = 0;
+                recharged_[index] = 0;
+            }
+            return;
+        default:
+            break;
+    }
+
+    bool routeDone {routepos_[index] >= routeend_[index]};
+    bool toBase {state_[index] == State::Returning || routeDone};
+    int goalx {0};
+    int goaly {0};
+    if (!toBase) {
+        goalx = routecells_[routepos_[index]] / width_;
+        goaly = routecells_[routepos_[index]] % width_;
+    }
+
+    if (x_[index] == goalx && y_[index] == goaly) {
+        progress_[index] = 0.0;
+        if (toBase) {
+            // Alla base il veicolo si ricarica, oppure si parcheggia se il percorso è finito
+            state_[index] = routeDone ? State::Parked : State::Recharging;
+            timer_[index] = rechargeticks_;
+        } else if (battery_[index] <= BatteryReserve && !recharged_[index]) {
+            // Batteria insufficiente per la lettura: si torna alla base, a meno che il veicolo non arrivi già da una ricarica
+            state_[index] = State::Returning;
+        } else {
+            state_[index] = State::Reading;
+            timer_[index] = readticks_;
+        }
+        return;
+    }
+
+    // Come nei veicoli, l'autonomia viene verificata all'inizio del tragitto: se non basta si passa prima dalla base.
+    // Un veicolo appena ricaricato parte comunque, anche se la cella è oltre l'autonomia di una batteria piena.
+    if (!toBase && !tripchecked_[index]) {
+        tripchecked_[index] = 1;
+        int distance {std::max(std::abs(goalx - x_[index]), std::abs(goaly - y_[index]))};
+        if (!recharged_[index] && !canTravel(index, distance)) {
+            state_[index] = State::Returning;
+            goalx = 0;
+            goaly = 0;
+        }
+    }
+    progress_[index] += speed_[index] * tickseconds_;
+    if (progress_[index] < 1.0) {
+        return;
+    }
+    computeCandidates(index, goalx, goaly);
+}
+
+// Funzione privata che verifica se la batteria basta a percorrere la distanza restando sopra la riserva, con la stessa regola dei veicoli
+bool TickEngine::canTravel(std::size_t index, int distance) const {
+    if (distance <= 0) {
+        return true;
+    }
+    return battery_[index] - (distance - 1) * BatteryPerCell > BatteryReserve;
+}
+
+// Funzione privata che campiona i quattro sensori nella cella corrente del veicolo
+void TickEngine::sampleCell(std::size_t index) {
+    Soil soil;
+    if (!field_.peekSoil(x_[index], y_[index], soil)) {
+        return;
+    }
+    SoilData* samples = &samples_[index * Sensor::SensorTypeCount];
+    int x {x_[index]};
+    int y {y_[index]};
+    samples[0] = {x, y, Sensor::SensorType::SoilTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::SoilTemperatureSensor)};
+    samples[1] = {x, y, Sensor::SensorType::AirTemperatureSensor, soil.PassTemperatureToSensor(Sensor::SensorType::AirTemperatureSensor)};
+    samples[2] = {x, y, Sensor::SensorType::MoistureSensor, soil.PassSoilMoistureToSensor(Sensor::SensorType::MoistureSensor)};
+    samples[3] = {x, y, Sensor::SensorType::HumiditySensor, soil.PassAirHumidityToSensor(Sensor::SensorType::HumiditySensor)};
+    sampled_[index] = 1;
+}
+
+// Funzione privata che calcola, in ordine di preferenza, le mosse che avvicinano il veicolo alla meta:
+// prima il passo diretto (anche diagonale), poi le alternative che permettono di aggirare un veicolo che blocca la strada.
+void TickEngine::computeCandidates(std::size_t index, int goalx, int goaly) {
+    int x {x_[index]};
+    int y {y_[index]};
+    int sx {(goalx > x) - (goalx < x)};
+    int sy {(goaly > y) - (goaly < y)};
+    int moves[CandidateMoves][2] = {{sx, sy}, {sx, 0}, {0, sy}};
+    if (sx == 0) {
+        moves[1][0] = 1;  moves[1][1] = sy;
+        moves[2][0] = -1; moves[2][1] = sy;
+    } else if (sy == 0) {
+        moves[1][0] = sx; moves[1][1] = 1;
+        moves[2][0] = sx; moves[2][1] = -1;
+    }
+    int* candidates = &candidates_[index * CandidateMoves];
+    for (int move = 0; move < CandidateMoves; ++move) {
+        int nx {x + moves[move][0]};
+        int ny {y + moves[move][1]};
+        if (nx >= 0 && nx < length_ && ny >= 0 && ny < width_ && (nx != x || ny != y)) {
+            candidates[move] = cellIndex(nx, ny);
+        }
+    }
+}
+
+// Fase sequenziale: le mosse vengono confermate in ordine di indice contro la griglia di occupazione, così che il risultato non dipenda dai thread.
+void TickEngine::resolveMoves() {
+    const int baseCell {0};
+    for (std::size_t index = 0; index < ids_.size(); ++index) {
+        const int* candidates = &candidates_[index * CandidateMoves];
+        bool wantsToMove {std::any_of(candidates, candidates + CandidateMoves, [](int cell) { return cell >= 0; })};
+        if (!wantsToMove) {
+            continue;
+        }
+        int current {cellIndex(x_[index], y_[index])};
+        int owner {static_cast<int>(index) + 1};
+        bool moved {false};
+        for (int move = 0; move < CandidateMoves && !moved; ++move) {
+            int cell {candidates[move]};
+            if (cell < 0 || (cell != baseCell && occupancy_[cell] != 0)) {
+                continue;
+            }
+            if (current != baseCell && occupancy_[current] == owner) {
+                occupancy_[current] = 0;
+            }
+            if (cell != baseCell) {
+                occupancy_[cell] = owner;
+            }
+            x_[index] = cell / width_;
+            y_[index] = cell % width_;
+            progress_[index] = std::min(progress_[index] - 1.0, 1.0);
+            if (state_[index] == State::Moving) {
+                battery_[index] = std::max(0.0f, battery_[index] - BatteryPerCell); // Il ritorno alla base non consuma batteria, come nei veicoli
+            }
+            moved = true;
+        }
+        if (!moved) {
+            ++collisionwaits_; // Tutte le celle candidate sono occupate: il veicolo attende il tick successivo
+            progress_[index] = 1.0;
+        }
+    }
+}
+
+// Funzione privata che raccoglie le letture di tutti i veicoli nel tick in un unico batch e lo invia al control center
+void TickEngine::sendSamples() {
+    std::size_t sampledVehicles {static_cast<std::size_t>(std::count(sampled_.begin(), sampled_.end(), 1))};
+    if (sampledVehicles == 0) {
+        return;
+    }
+    std::vector<SoilData> batch = controlcenter_.acquireBatch();
+    batch.reserve(sampledVehicles * Sensor::SensorTypeCount);
+    for (std::size_t index = 0; index < ids_.size(); ++index) {
+        if (sampled_[index]) {
+            auto samples = samples_.begin() + index * Sensor::SensorTypeCount;
+            batch.insert(batch.end(), samples, samples + Sensor::SensorTypeCount);
+        }
+    }
+    readingssent_ += batch.size();
+    controlcenter_.appendData(std::move(batch));
+}
+
+// Funzione privata che esegue un lavoro sui veicoli dividendoli in blocchi contigui, uno per thread; il thread chiamante esegue il primo blocco
+void TickEngine::parallelFor(const std::function<void(std::size_t, std::size_t)>& job) {
+    if (workers_.empty()) {
+        job(0, ids_.size());
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        job_ = job;
+        pendingworkers_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    cvwork_.notify_all();
+    std::pair<std::size_t, std::size_t> range = chunk(0);
+    job(range.first, range.second);
+    std::unique_lock<std::mutex> lock(poolmutex_);
+    cvdone_.wait(lock, [this] { return pendingworkers_ == 0; });
+    job_ = nullptr;
+}
+
+// Ciclo di un thread del gruppo: attende un nuovo lavoro, esegue il proprio blocco e segnala il termine
+void TickEngine::workerLoop(int worker) {
+    std::size_t seen {0};
+    while (true) {
+        std::function<void(std::size_t, std::size_t)> job;
+        {
+            std::unique_lock<std::mutex> lock(poolmutex_);
+            cvwork_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+        }
+        std::pair<std::size_t, std::size_t> range = chunk(worker);
+        job(range.first, range.second);
+        std::lock_guard<std::mutex> lock(poolmutex_);
+        if (--pendingworkers_ == 0) {
+            cvdone_.notify_one();
+        }
+    }
+}
+
+// Funzione privata che restituisce il blocco di veicoli assegnato a un thread
+std::pair<std::size_t, std::size_t> TickEngine::chunk(int worker) const {
+    std::size_t count {ids_.size()};
+    std::size_t threads {workers_.size() + 1};
+    return {count * worker / threads, count * (worker + 1) / threads};
+}
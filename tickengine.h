@@ -0,0 +1,103 @@
+// La classe "TickEngine" è un motore di simulazione alternativo ai thread dei singoli veicoli.
+// Invece di far avanzare ogni veicolo in modo indipendente sul proprio thread, sincronizzandosi con mutex e condition variable,
+// il motore fa avanzare tutta la flotta un "tick" di simulazione alla volta. Lo stato dei veicoli è memorizzato per colonne (un vettore per ogni proprietà),
+// così che ogni fase del tick sia un ciclo sui dati contigui eseguito in parallelo da un gruppo di thread fissi:
+// 1) fase parallela: ogni veicolo aggiorna il proprio stato, calcola le mosse candidate e, se ha finito una lettura, campiona i sensori;
+// 2) fase sequenziale: le mosse vengono confermate in ordine di indice controllando la griglia di occupazione del campo (a parità di conflitto vince l'indice minore);
+// 3) le letture del tick vengono raccolte in un unico batch inviato al control center.
+// Poiché le fasi parallele lavorano solo sui dati del proprio veicolo e i conflitti si risolvono sempre nello stesso ordine, la simulazione è deterministica
+// e il tempo di calcolo scala con il numero di core invece che con il numero di thread.
+// La descrizione delle funzioni è presente nel file "tickengine.cpp".
+
+#ifndef TICKENGINE_H
+#define TICKENGINE_H
+#include "field.h"
+#include "soildata.h"
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+class ControlCenter;
+
+class TickEngine {
+    public:
+        enum class State : std::uint8_t {Moving, Reading, Returning, Recharging, Parked};
+        TickEngine(const Field& field, ControlCenter& controlCenter, double tickseconds, int threads);
+        ~TickEngine();
+        TickEngine(const TickEngine&) = delete;
+        TickEngine& operator=(const TickEngine&) = delete;
+        int addVehicle(int id, int x, int y, double speed, float battery);
+        void assignRoute(int index, const std::vector<std::pair<int, int>>& cells);
+        void step();
+        std::size_t run(std::size_t maxticks);
+        bool isFinished() const;
+        std::size_t getTick() const { return tick_; }
+        double getSimulatedSeconds() const { return tick_ * tickseconds_; }
+        int getVehicleCount() const { return static_cast<int>(ids_.size()); }
+        std::pair<int, int> getPosition(int index) const { return {x_[index], y_[index]}; }
+        float getBattery(int index) const { return battery_[index]; }
+        State getState(int index) const { return state_[index]; }
+        std::size_t getCollisionWaits() const { return collisionwaits_; }
+        std::size_t getReadingsSent() const { return readingssent_; }
+
+    private:
+        static constexpr int CandidateMoves = 3; // Mosse candidate per veicolo, in ordine di preferenza
+        static constexpr float BatteryPerCell = 5.0f;
+        static constexpr float BatteryPerReading = 15.0f;
+        static constexpr float BatteryReserve = 10.0f;
+        const Field& field_;
+        ControlCenter& controlcenter_;
+        double tickseconds_;
+        int length_;
+        int width_;
+        int readticks_; // Tick necessari per leggere i quattro sensori
+        int rechargeticks_; // Tick necessari per ricaricare la batteria alla base
+        std::size_t tick_;
+        std::size_t collisionwaits_;
+        std::size_t readingssent_;
+        // Stato dei veicoli per colonne
+        std::vector<int> ids_;
+        std::vector<int> x_;
+        std::vector<int> y_;
+        std::vector<double> speed_;
+        std::vector<double> progress_; // Frazione di cella accumulata: il veicolo avanza di una cella quando raggiunge 1
+        std::vector<float> battery_;
+        std::vector<State> state_;
+        std::vector<int> timer_; // Tick rimanenti per la lettura o la ricarica in corso
+        std::vector<std::uint8_t> tripchecked_; // 1 se l'autonomia è già stata verificata per il tragitto in corso
+        std::vector<std::uint8_t> recharged_; // 1 se il veicolo si è ricaricato dopo l'ultima lettura
+        std::vector<std::size_t> routebegin_;
+        std::vector<std::size_t> routeend_;
+        std::vector<std::size_t> routepos_;
+        std::vector<int> routecells_; // Celle dei percorsi di tutti i veicoli, una dopo l'altra
+        std::vector<int> candidates_; // CandidateMoves celle per veicolo, -1 se la mossa non esiste
+        std::vector<SoilData> samples_; // Letture del tick: SensorTypeCount posizioni per veicolo
+        std::vector<std::uint8_t> sampled_; // 1 se il veicolo ha campionato nel tick corrente
+        std::vector<int> occupancy_; // Griglia di occupazione: indice del veicolo + 1, 0 se la cella è libera
+        // Gruppo di thread fissi per le fasi parallele
+        std::vector<std::thread> workers_;
+        std::mutex poolmutex_;
+        std::condition_variable cvwork_;
+        std::condition_variable cvdone_;
+        std::function<void(std::size_t, std::size_t)> job_;
+        std::size_t generation_;
+        int pendingworkers_;
+        bool stopping_;
+        int cellIndex(int x, int y) const { return x * width_ + y; }
+        bool canTravel(std::size_t index, int distance) const;
+        void planVehicle(std::size_t index);
+        void sampleCell(std::size_t index);
+        void computeCandidates(std::size_t index, int goalx, int goaly);
+        void resolveMoves();
+        void sendSamples();
+        void parallelFor(const std::function<void(std::size_t, std::size_t)>& job);
+        void workerLoop(int worker);
+        std::pair<std::size_t, std::size_t> chunk(int worker) const;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "tracerecorder.h"
+#include <iostream>
+#include <cstring>
+
+namespace {
+    template <typename T>
+    void appendValue(std::vector<char>& buffer, const T& value)
+    {
+        const char* bytes {reinterpret_cast<const char*>(&value)};
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+}
+
+// Costruttore: la registrazione inizia con la chiamata a open
+TraceRecorder::TraceRecorder()
+    : batches_{0},
+    readings_{0}
+    {}
+
+// Distruttore: i record ancora in memoria vengono scritti su file
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+// Funzione che crea il file della traccia e ne scrive l'intestazione: gli istanti dei record sono misurati da questo momento.
+// Restituisce false, con un messaggio di errore, se il file non può essere creato.
+bool TraceRecorder::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (file_.is_open()) {
+        writePending();
+        file_.close();
+    }
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "Unable to create sensor trace " << path << "." << std::endl;
+        return false;
+    }
+    pending_.clear();
+    pending_.reserve(FlushThreshold + RecordHeaderSize);
+    pending_.insert(pending_.end(), Magic, Magic + sizeof(Magic));
+    appendValue(pending_, Version);
+    appendValue(pending_, std::uint32_t{0});
+    start_ = std::chrono::steady_clock::now();
+    batches_ = 0;
+    readings_ = 0;
+    return writePending();
+}
+
+// Funzione che aggiunge un batch alla traccia. Viene chiamata dal control center per ogni batch ricevuto, da più thread contemporaneamente:
+// il batch viene solo copiato nel blocco in memoria, che viene scritto su file quando supera la soglia.
+void TraceRecorder::record(int vehicleid, const std::vector<SoilData>& batch) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!file_.is_open()) {
+        return;
+    }
+    std::uint64_t timestamp {static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count())};
+    appendValue(pending_, timestamp);
+    appendValue(pending_, static_cast<std::int32_t>(vehicleid));
+    appendValue(pending_, static_cast<std::uint32_t>(batch.size()));
+    for (const auto& reading : batch) {
+        appendValue(pending_, static_cast<std::int32_t>(reading.x));
+        appendValue(pending_, static_cast<std::int32_t>(reading.y));
+        appendValue(pending_, static_cast<std::uint8_t>(reading.type));
+        appendValue(pending_, reading.data);
+    }
+    ++batches_;
+    readings_ += batch.size();
+    if (pending_.size() >= FlushThreshold) {
+        writePending();
+    }
+}
+
+// Funzione privata, chiamata con il mutex acquisito, che scrive su file i record accumulati in memoria
+bool TraceRecorder::writePending() {
+    if (!pending_.empty()) {
+        file_.write(pending_.data(), static_cast<std::streamsize>(pending_.size()));
+        pending_.clear();
+    }
+    if (!file_) {
+        std::cerr << "Error while writing the sensor trace." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Funzione che scrive su file tutti i record registrati finora, così che la traccia possa essere letta mentre la registrazione continua
+bool TraceRecorder::flush() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!file_.is_open()) {
+        return false;
+    }
+    bool written {writePending()};
+    file_.flush();
+    return written && static_cast<bool>(file_);
+}
+
+// Funzione che termina la registrazione
+void TraceRecorder::close() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (file_.is_open()) {
+        writePending();
+        file_.close();
+    }
+}
+
+bool TraceRecorder::isOpen() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return file_.is_open();
+}
+
+std::size_t TraceRecorder::getRecordedBatches() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return batches_;
+}
+
+std::size_t TraceRecorder::getRecordedReadings() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return readings_;
+}
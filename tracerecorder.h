@@ -0,0 +1,52 @@
+// La classe "TraceRecorder" registra in un file binario, in sola aggiunta, tutti i batch di letture ricevuti dal control center,
+// ognuno con l'istante di arrivo e l'id del veicolo che lo ha inviato. La traccia può poi essere riprodotta con la classe "TraceReplayer"
+// per provare e misurare l'analisi dei dati senza simulare i veicoli.
+// Formato del file (versione 1, valori nell'ordine dei byte della macchina che registra):
+// - un'intestazione di 16 byte: "AGTRACE\0", versione e un campo riservato;
+// - un record per batch: istante in nanosecondi dall'inizio della registrazione, id del veicolo (-1 se sconosciuto), numero di letture,
+//   e le letture (x, y, tipo di sensore, valore) senza spazi di allineamento.
+// I record vengono accumulati in memoria e scritti a blocchi, così che la registrazione pesi il meno possibile su chi invia i dati.
+// La descrizione delle funzioni è presente nel file "tracerecorder.cpp".
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+#include "soildata.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+class TraceRecorder {
+    public:
+        static constexpr char Magic[8] = {'A', 'G', 'T', 'R', 'A', 'C', 'E', '\0'};
+        static constexpr std::uint32_t Version = 1;
+        static constexpr std::size_t HeaderSize = 16;
+        static constexpr std::size_t RecordHeaderSize = 16; // Istante, id del veicolo e numero di letture
+        static constexpr std::size_t ReadingSize = 17; // x, y, tipo di sensore e valore
+        TraceRecorder();
+        ~TraceRecorder();
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+        bool open(const std::string& path);
+        void record(int vehicleid, const std::vector<SoilData>& batch);
+        bool flush();
+        void close();
+        bool isOpen() const;
+        std::size_t getRecordedBatches() const;
+        std::size_t getRecordedReadings() const;
+
+    private:
+        static constexpr std::size_t FlushThreshold = 1 << 16; // Byte accumulati oltre i quali il blocco viene scritto su file
+        std::ofstream file_;
+        std::vector<char> pending_; // Record non ancora scritti su file
+        std::chrono::steady_clock::time_point start_;
+        std::size_t batches_;
+        std::size_t readings_;
+        mutable std::mutex mtx_;
+        bool writePending();
+};
+
+#endif
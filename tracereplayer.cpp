@@ -0,0 +1,111 @@
+#include "tracereplayer.h"
+#include "tracerecorder.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    template <typename T>
+    T readValue(const char* bytes)
+    {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+}
+
+// Costruttore: la traccia da riprodurre viene indicata con open
+TraceReplayer::TraceReplayer()
+    : size_{0},
+    truncated_{false}
+    {}
+
+// Funzione che apre una traccia e ne controlla l'intestazione. Restituisce false, con un messaggio di errore, se il file non è una traccia valida.
+bool TraceReplayer::open(const std::string& path) {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    truncated_ = false;
+    file_.open(path, std::ios::binary);
+    if (!file_) {
+        std::cerr << "Unable to open sensor trace " << path << "." << std::endl;
+        return false;
+    }
+    char header[TraceRecorder::HeaderSize];
+    if (!file_.read(header, sizeof(header)) || std::memcmp(header, TraceRecorder::Magic, sizeof(TraceRecorder::Magic)) != 0
+        || readValue<std::uint32_t>(header + 8) != TraceRecorder::Version) {
+        std::cerr << "Invalid sensor trace " << path << "." << std::endl;
+        file_.close();
+        return false;
+    }
+    file_.seekg(0, std::ios::end);
+    size_ = file_.tellg();
+    file_.seekg(static_cast<std::streamoff>(TraceRecorder::HeaderSize));
+    return true;
+}
+
+// Funzione che legge il batch successivo della traccia, con l'id del veicolo e l'istante (in nanosecondi dall'inizio della registrazione).
+// Restituisce false a fine traccia; un record troncato, ad esempio da una registrazione interrotta, viene scartato e segnalato da isTruncated.
+// Anche un numero di letture che supera i byte rimasti nel file indica una traccia troncata (o corrotta): il record viene scartato senza allocare memoria.
+bool TraceReplayer::nextBatch(std::vector<SoilData>& batch, int& vehicleid, std::uint64_t& timestamp) {
+    batch.clear();
+    if (!file_.is_open()) {
+        return false;
+    }
+    char header[TraceRecorder::RecordHeaderSize];
+    if (!file_.read(header, sizeof(header))) {
+        truncated_ = file_.gcount() > 0;
+        return false;
+    }
+    timestamp = readValue<std::uint64_t>(header);
+    vehicleid = readValue<std::int32_t>(header + 8);
+    std::uint32_t readings {readValue<std::uint32_t>(header + 12)};
+    std::streamoff remaining {size_ - static_cast<std::streamoff>(file_.tellg())};
+    if (static_cast<std::uint64_t>(readings) * TraceRecorder::ReadingSize > static_cast<std::uint64_t>(remaining)) {
+        truncated_ = true;
+        return false;
+    }
+    buffer_.resize(static_cast<std::size_t>(readings) * TraceRecorder::ReadingSize);
+    if (!file_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()))) {
+        truncated_ = true;
+        return false;
+    }
+    for (const char* reading = buffer_.data(); reading != buffer_.data() + buffer_.size(); reading += TraceRecorder::ReadingSize) {
+        std::uint8_t type {readValue<std::uint8_t>(reading + 8)};
+        if (type >= Sensor::SensorTypeCount) {
+            std::cerr << "Invalid sensor type in the sensor trace." << std::endl;
+            truncated_ = true;
+            return false;
+        }
+        batch.push_back({readValue<std::int32_t>(reading), readValue<std::int32_t>(reading + 4), static_cast<Sensor::SensorType>(type),
+                         readValue<double>(reading + 9)});
+    }
+    return true;
+}
+
+// Funzione che invia al control center tutti i batch della traccia, alla massima velocità o rispettando gli istanti registrati
+// divisi per speedup. Il control center deve avere un thread di analisi attivo; la fine della raccolta dati va segnalata dal chiamante.
+TraceReplayer::ReplayReport TraceReplayer::replay(ControlCenter& controlCenter, Pace pace, double speedup) {
+    ReplayReport report;
+    if (speedup <= 0.0) {
+        speedup = 1.0;
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SoilData> batch {controlCenter.acquireBatch()};
+    int vehicleid {-1};
+    std::uint64_t timestamp {0};
+    while (nextBatch(batch, vehicleid, timestamp)) {
+        if (pace == Pace::Recorded) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<std::int64_t>(timestamp / speedup)));
+        }
+        ++report.batches;
+        report.readings += batch.size();
+        report.recordedseconds = timestamp / 1e9;
+        controlCenter.appendData(std::move(batch), vehicleid);
+        batch = controlCenter.acquireBatch();
+    }
+    report.elapsedseconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.complete = !truncated_;
+    return report;
+}
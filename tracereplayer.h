@@ -0,0 +1,42 @@
+// La classe "TraceReplayer" riproduce una traccia registrata da "TraceRecorder", inviando i suoi batch al control center
+// come se arrivassero dai veicoli. La riproduzione può avvenire alla massima velocità, per misurare la capacità dell'analisi,
+// oppure rispettando gli istanti registrati (eventualmente accelerati di un fattore), per riprodurre il carico reale.
+// La traccia viene letta un record alla volta, quindi anche tracce molto grandi non vengono caricate interamente in memoria.
+// La descrizione delle funzioni è presente nel file "tracereplayer.cpp".
+
+#ifndef TRACEREPLAYER_H
+#define TRACEREPLAYER_H
+#include "controlcenter.h"
+#include "soildata.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+class TraceReplayer {
+    public:
+        enum class Pace {AsFastAsPossible, Recorded};
+        // Riepilogo di una riproduzione
+        struct ReplayReport {
+            std::size_t batches = 0;
+            std::size_t readings = 0;
+            double recordedseconds = 0.0; // Durata della registrazione
+            double elapsedseconds = 0.0; // Durata della riproduzione
+            bool complete = true; // Falso se la traccia termina con un record troncato
+            double readingsPerSecond() const { return elapsedseconds > 0.0 ? readings / elapsedseconds : 0.0; }
+        };
+        TraceReplayer();
+        bool open(const std::string& path);
+        bool nextBatch(std::vector<SoilData>& batch, int& vehicleid, std::uint64_t& timestamp);
+        ReplayReport replay(ControlCenter& controlCenter, Pace pace, double speedup = 1.0);
+        bool isTruncated() const { return truncated_; }
+
+    private:
+        std::ifstream file_;
+        std::streamoff size_; // Dimensione del file, usata per rifiutare i record che dichiarano più letture di quelle rimaste
+        bool truncated_;
+        std::vector<char> buffer_; // Byte del record corrente, riutilizzati da un record all'altro
+};
+
+#endif
@@ -3,9 +3,10 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
-// Inizializzazione del contatore statico per gli id dei veicoli.
-int Vehicle::nextId_ = 10000;
+// Inizializzazione del contatore statico per gli id dei veicoli: essendo atomico, i veicoli possono essere creati da thread diversi.
+std::atomic<int> Vehicle::nextId_{10000};
 // Costruttore di default
 Vehicle::Vehicle()
     :name_{"???"},
@@ -17,13 +18,18 @@ Vehicle::Vehicle()
     battery_{100.0},
     sensors_{},
     field_{Field()},
-    isBusy_{false} // All'inizio il veicolo non è impegnato
+    isBusy_{false}, // All'inizio il veicolo non è impegnato
+    motion_{0, 0},
+    pendingcells_{0},
+    flushcells_{8},
+    flushinterval_{5000},
+    pendingcenter_{nullptr}
     {}
 
 // Costruttore con parametri
 Vehicle::Vehicle(std::string name, int id, VehicleType type, int x, int y, double speed, float battery, std::vector<Sensor> sensors, const Field& field)
     : name_{name},
-      id_{nextId_++},
+      id_{id}, // L'id scelto dall'utente viene rispettato
       type_{type},
       x_{x},
       y_{y},
@@ -31,7 +37,12 @@ Vehicle::Vehicle(std::string name, int id, VehicleType type, int x, int y, doubl
       battery_{battery},
       sensors_{sensors},
       field_{field},
-      isBusy_{false}
+      isBusy_{false},
+      motion_{x, y},
+      pendingcells_{0}, // Di default si inviano le letture ogni 8 celle visitate o ogni 5 secondi
+      flushcells_{8},
+      flushinterval_{5000},
+      pendingcenter_{nullptr}
       
     
     
@@ -63,12 +74,76 @@ void Vehicle::setPosition(int x, int y) {
     }
     x_ = x;
     y_ = y;
-   
+    {
+        std::lock_guard<std::mutex> motionLock(motionmutex_);
+        motion_ = MotionModel(x, y); // Il veicolo è fermo nella nuova posizione
+    }
+    publishTelemetry(TelemetrySample::State::Idle, x_, y_);
 
     std::cout << "Vehicle " << name_ << " moved to position (" << x_ << ", " << y_ << ")" << std::endl;
 }
 
+// Funzioni per leggere la posizione del veicolo: durante uno spostamento la posizione viene ricavata dal modello di moto all'istante corrente.
+int Vehicle::getX() const {
+    std::lock_guard<std::mutex> motionLock(motionmutex_);
+    return motion_.positionAt(MotionModel::Clock::now()).first;
+}
+
+int Vehicle::getY() const {
+    std::lock_guard<std::mutex> motionLock(motionmutex_);
+    return motion_.positionAt(MotionModel::Clock::now()).second;
+}
+
+// Funzione privata che esegue uno spostamento in forma chiusa: il modello di moto viene pubblicato, il thread attende direttamente l'istante di arrivo
+// e solo allora la posizione viene aggiornata. Se drain è true viene consumata la batteria prevista per il tragitto.
+void Vehicle::travelTo(int targetx, int targety, bool drain) {
+    MotionModel motion(x_, y_, targetx, targety, speed_, drain ? BatteryPerCell : 0.0f, MotionModel::Clock::now());
+    {
+        std::lock_guard<std::mutex> motionLock(motionmutex_);
+        motion_ = motion;
+    }
+    publishTelemetry(drain ? TelemetrySample::State::Moving : TelemetrySample::State::Returning, x_, y_);
+    std::this_thread::sleep_until(motion.getArrivalTime()); // Simula il tempo di movimento con un'unica attesa
+    if (drain) {
+        drainBattery(motion.getBatteryUse());
+    }
+    x_ = targetx;
+    y_ = targety;
+    publishTelemetry(TelemetrySample::State::Idle, x_, y_);
+}
+
+// Funzione privata per pubblicare un campione di telemetria: non blocca mai il veicolo, anche se nessuno sta leggendo i campioni.
+void Vehicle::publishTelemetry(TelemetrySample::State state, int x, int y) {
+    telemetry_.publish({std::chrono::steady_clock::now(), id_, x, y, battery_, state});
+}
+
+// Funzione privata per il ritorno alla base (0, 0) e la ricarica: il lock del veicolo viene rilasciato durante la ricarica.
+void Vehicle::returnToBaseAndRecharge(std::unique_lock<std::mutex>& lock) {
+    std::cout << "Low battery. Returning to base for recharge from (" << x_ << ", " << y_ << ")..." << std::endl;
+    if (pendingcenter_ != nullptr) {
+        sendPendingData(*pendingcenter_, lock); // Durante ritorno e ricarica il veicolo non legge: le letture accumulate vengono inviate subito
+    }
+    travelTo(0, 0, false); // Il ritorno alla base non consuma la batteria, come nella simulazione originale
+    lock.unlock(); // Rilascia il lock durante la ricarica, in modo da consentire altre operazioni
+    rechargeBattery(); // Ricarica la batteria
+    lock.lock(); // Riacquisisce il lock dopo la ricarica
+}
+
+// Funzioni private che indicano se la batteria attuale, o un certo livello di batteria, basta per percorrere un certo numero di celle:
+// come nella simulazione passo-passo, un passo è consentito solo se prima di compierlo la batteria è sopra la riserva.
+bool Vehicle::canTravel(int distance) const {
+    return canTravel(distance, battery_);
+}
+
+bool Vehicle::canTravel(int distance, float battery) {
+    if (distance <= 0) {
+        return true;
+    }
+    return battery - (distance - 1) * BatteryPerCell > BatteryReserve;
+}
+
 // Funzione per spostare il veicolo in una posizione target: il tempo di spostamento è proporzionale alla distanza tra la posizione attuale e la posizione target e alla velocità del veicolo.
+// Tempo di arrivo, percorso e consumo di batteria sono calcolati in forma chiusa dal modello di moto, senza simulare ogni cella attraversata.
 void Vehicle::moveToTarget(int targetx, int targety) {
     std::unique_lock<std::mutex> lock(vehiclemutex_); // Lock per proteggere l'accesso alla variabile isBusy_: solo un thread alla volta può muovere il veicolo
     while (isBusy_) {
@@ -84,63 +159,49 @@ void Vehicle::moveToTarget(int targetx, int targety) {
         return;
     }
 
-    double steptime = 1.0 / speed_; // Simula il tempo di movimento in base alla velocità
+    sendExpiredData(lock); // Un batch rimasto in attesa troppo a lungo non deve aspettare la prossima lettura
 
     std::cout << "Debug: Vehicle starting movement to (" << targetx << ", " << targety << ") from (" << x_ << ", " << y_ << ")" << std::endl;
 
-    while (x_ != targetx || y_ != targety) {
-        // Controllo della batteria
-        if (battery_ <= 10.0) {
-            std::cout << "Low battery. Returning to base for recharge..." << std::endl;
-
-            // Ritorno alla base (0, 0)
-            while (x_ != 0 || y_ != 0) {
-                if (x_ > 0) {
-                    --x_;}
-                else if (x_ < 0) {
-                ++x_;}
-
-                if (y_ > 0) {
-                    --y_;}
-                else if (y_ < 0) {
-                    ++y_;
-                }
-
-                std::cout << "Returning to base, current position: (" << x_ << ", " << y_ << ")" << std::endl;
-                std::this_thread::sleep_for(std::chrono::duration<float>(steptime));
-            }
-
-            lock.unlock(); // Rilascia il lock durante la ricarica, in modo da consentire altre operazioni
-            rechargeBattery(); // Ricarica la batteria
-            lock.lock(); // Riacquisisce il lock dopo la ricarica
-
-            std::cout << "Resuming movement to target (" << targetx << ", " << targety << ")" << std::endl;
+    // Se la batteria non basta per raggiungere il target, il veicolo passa prima dalla base per ricaricarsi invece di fermarsi a metà strada
+    if (!canTravel(MotionModel::distance(x_, y_, targetx, targety))) {
+        returnToBaseAndRecharge(lock);
+        if (!canTravel(MotionModel::distance(x_, y_, targetx, targety))) {
+            std::cerr << "Warning: target (" << targetx << ", " << targety << ") is beyond the range of a full battery from the base." << std::endl;
         }
-
-        // Movimento verso il target
-        drainBattery(5); // Consuma 5% di batteria per ogni spostamento
-        if (x_ < targetx) {
-        ++x_;}
-        else if (x_ > targetx) {
-            --x_;}
-
-        if (y_ < targety) {
-            ++y_;}
-        else if (y_ > targety) {
-            --y_;}
-
-        std::cout << "Vehicle " << name_ << " moved to position (" << x_ << ", " << y_ << ")" << std::endl;
-        std::cout << "Battery level: " << battery_ << "%" << std::endl;
-
-        std::this_thread::sleep_for(std::chrono::duration<float>(steptime)); // Simula il tempo di movimento
+        std::cout << "Resuming movement to target (" << targetx << ", " << targety << ")" << std::endl;
     }
 
+    travelTo(targetx, targety, true); // Consuma 5% di batteria per ogni cella percorsa
+
     std::cout << "Vehicle " << name_ << " reached target at position (" << x_ << ", " << y_ << ")" << std::endl;
+    std::cout << "Battery level: " << battery_ << "%" << std::endl;
 
     isBusy_ = false;
     cvnotbusy_.notify_one(); // Notifica che il veicolo non è più impegnato e può essere utilizzato da altri thread
 }
 
+// Funzione che stima in forma chiusa l'istante di arrivo del veicolo in una cella, senza muoverlo:
+// si tiene conto dello spostamento in corso e dell'eventuale passaggio alla base per la ricarica.
+MotionModel::Clock::time_point Vehicle::estimateArrival(int targetx, int targety) const {
+    MotionModel current;
+    {
+        std::lock_guard<std::mutex> motionLock(motionmutex_);
+        current = motion_;
+    }
+    MotionModel::Clock::time_point start {std::max(MotionModel::Clock::now(), current.getArrivalTime())};
+    int fromx {current.getTargetX()};
+    int fromy {current.getTargetY()};
+    int distance {MotionModel::distance(fromx, fromy, targetx, targety)};
+    if (canTravel(distance)) {
+        return MotionModel(fromx, fromy, targetx, targety, speed_, BatteryPerCell, start).getArrivalTime();
+    }
+    // Ritorno alla base, ricarica e tragitto dalla base al target
+    MotionModel toBase(fromx, fromy, 0, 0, speed_, 0.0f, start);
+    MotionModel::Clock::time_point recharged {toBase.getArrivalTime() + std::chrono::duration_cast<MotionModel::Clock::duration>(RechargeTime)};
+    return MotionModel(0, 0, targetx, targety, speed_, BatteryPerCell, recharged).getArrivalTime();
+}
+
 // Funzione per leggere i dati dalla cella corrente: i dati sono passati ai sensori e stampati a video.
 void Vehicle::readDataFromCurrentCell() const {
     Soil soil;
@@ -170,50 +231,51 @@ void Vehicle::readDataFromCurrentCell() const {
 }
 
 // Funzione per la lettura reale dei dati sul campo e l'invio al control center per la futura analisi.
-void Vehicle::readAndSendData(ControlCenter& controlCenter) {
+// Restituisce true se le letture della cella sono state accodate, false se la cella non può essere letta.
+bool Vehicle::readAndSendData(ControlCenter& controlCenter) {
     std::unique_lock<std::mutex> lock(vehiclemutex_);
     while (isBusy_) {
         cvnotbusy_.wait(lock);
     }
     isBusy_ = true;
 
+    sendExpiredData(lock);
     int xToBeRead {x_};
     int yToBeRead {y_};
 
-    while (battery_ <= 10.0) {
-        std::cout << "Low battery. Returning to base for recharge..." << std::endl;
-
-        // Ritorno alla base (0, 0)
-        while (x_ != 0 || y_ != 0) {
-            if (x_ > 0) --x_;
-            else if (x_ < 0) ++x_;
-
-            if (y_ > 0) --y_;
-            else if (y_ < 0) ++y_;
-
-            std::cout << "Returning to base, current position: (" << x_ << ", " << y_ << ")" << std::endl;
-            std::this_thread::sleep_for(std::chrono::duration<float>(1.0 / speed_));
+    if (battery_ <= BatteryReserve) {
+        // Dopo la ricarica il veicolo torna nella cella da leggere e deve arrivarci ancora sopra la riserva, come se dovesse compiere un passo in più.
+        // Se nemmeno la batteria piena basta, la cella è fuori portata: viene segnalata e saltata invece di ripetere all'infinito ritorno e ricarica.
+        if (!canTravel(MotionModel::distance(0, 0, xToBeRead, yToBeRead) + 1, FullBattery)) {
+            std::cerr << "Warning: cell (" << xToBeRead << ", " << yToBeRead << ") is beyond the range of a full battery from the base and cannot be read." << std::endl;
+            isBusy_ = false;
+            cvnotbusy_.notify_one();
+            return false;
         }
-
-        lock.unlock(); // Rilascia il lock durante la ricarica 
-        rechargeBattery(); // Ricarica la batteria
-        lock.lock(); // Riacquisisce il lock dopo la ricarica
-
+        returnToBaseAndRecharge(lock);
         std::cout << "Resuming data collection at (" << xToBeRead << ", " << yToBeRead << ")" << std::endl;
+        travelTo(xToBeRead, yToBeRead, true); // Dopo la ricarica il veicolo torna nella cella da leggere
     }
     // Consuma il 15% della batteria per la lettura dei dati
     drainBattery(15.0);
+    publishTelemetry(TelemetrySample::State::Reading, xToBeRead, yToBeRead);
 
     Soil soil;
     if (!field_.getSoil(xToBeRead, yToBeRead, soil)) {
         std::cerr << "Error: Unable to read soil data at position (" << xToBeRead << ", " << yToBeRead << ")" << std::endl;
         isBusy_ = false;
         cvnotbusy_.notify_one();
-        return;
+        return false;
     }
 
-    // Lettura dei dati dai sensori
-    std::vector<SoilData> dataBatch;
+    // Lettura dei dati dai sensori: le letture vengono accodate a quelle delle celle già visitate e non ancora inviate
+    if (pendingcells_ == 0) {
+        pendingsince_ = std::chrono::steady_clock::now();
+        pendingcenter_ = &controlCenter;
+        if (pendingdata_.capacity() == 0) {
+            pendingdata_ = controlCenter.acquireBatch(); // Buffer riutilizzabile fornito dal control center
+        }
+    }
     for (const auto& sensor : sensors_) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Simula il tempo di lettura dei dati
         SoilData data;
@@ -233,17 +295,71 @@ void Vehicle::readAndSendData(ControlCenter& controlCenter) {
             default:
                 std::cerr << "Unknown sensor type" << std::endl;
         }
-        dataBatch.push_back(data);
+        pendingdata_.push_back(data);
         std::cout << "Debug: Data read at position (" << xToBeRead << ", " << yToBeRead << ") for sensor " 
                   << Sensor::sensorTypeToString(sensor.getType()) << ": " << data.data << std::endl;
     }
+    ++pendingcells_;
 
-    // Invio dei dati al centro di controllo
-    controlCenter.appendData(dataBatch);
-    std::cout << "Debug: Data sent for position (" << xToBeRead << ", " << yToBeRead << ")" << std::endl;
+    // Invio dei dati al centro di controllo solo quando il batch ha raggiunto la dimensione massima o è rimasto in attesa troppo a lungo
+    if (pendingcells_ >= flushcells_ || std::chrono::steady_clock::now() - pendingsince_ >= flushinterval_) {
+        sendPendingData(controlCenter, lock);
+    }
 
     isBusy_ = false;
     cvnotbusy_.notify_one();
+    return !sensors_.empty(); // Un veicolo senza sensori non produce letture
+}
+
+// Funzione per inviare subito al control center tutte le letture accumulate: va chiamata a fine percorso per non perdere dati.
+void Vehicle::flushData(ControlCenter& controlCenter) {
+    std::unique_lock<std::mutex> lock(vehiclemutex_);
+    while (isBusy_) {
+        cvnotbusy_.wait(lock);
+    }
+    isBusy_ = true;
+    sendPendingData(controlCenter, lock);
+    isBusy_ = false;
+    cvnotbusy_.notify_one();
+}
+
+// Funzione per impostare la politica di invio: numero massimo di celle per batch e tempo massimo di attesa di una lettura.
+void Vehicle::setFlushPolicy(int maxcells, std::chrono::milliseconds maxage) {
+    std::lock_guard<std::mutex> lock(vehiclemutex_);
+    if (maxcells <= 0) {
+        std::cerr << "Invalid flush policy: at least one cell per batch is required." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    flushcells_ = maxcells;
+    flushinterval_ = maxage;
+}
+
+// Funzione privata che invia il batch corrente al control center: va chiamata con il veicolo già impegnato dal thread chiamante.
+// Il batch viene preso in carico sotto il lock del veicolo, che viene poi rilasciato durante l'invio: appendData può attendere a lungo
+// che il control center liberi spazio nel buffer, e nel frattempo gli altri thread non devono restare bloccati sul mutex del veicolo.
+// Il veicolo resta impegnato (isBusy_) per tutto l'invio, come durante la ricarica.
+void Vehicle::sendPendingData(ControlCenter& controlCenter, std::unique_lock<std::mutex>& lock) {
+    if (pendingdata_.empty()) {
+        return;
+    }
+    std::vector<SoilData> batch {std::move(pendingdata_)};
+    int cells {pendingcells_};
+    pendingdata_ = std::vector<SoilData>();
+    pendingcells_ = 0;
+    pendingcenter_ = nullptr;
+    lock.unlock();
+    controlCenter.appendData(std::move(batch), id_); // Il buffer viene consegnato al control center, che lo restituirà alla riserva dopo l'analisi
+    std::cout << "Debug: Vehicle " << name_ << " sent data for " << cells << " cells" << std::endl;
+    lock.lock();
+}
+
+// Funzione privata che invia il batch corrente se è in attesa da più del tempo massimo: viene controllata anche sui comandi di movimento,
+// così che un veicolo che smette di leggere non trattenga le ultime letture fino a una chiamata esplicita a flushData.
+// Va chiamata con il veicolo già impegnato dal thread chiamante.
+void Vehicle::sendExpiredData(std::unique_lock<std::mutex>& lock) {
+    if (pendingcells_ > 0 && pendingcenter_ != nullptr && std::chrono::steady_clock::now() - pendingsince_ >= flushinterval_) {
+        sendPendingData(*pendingcenter_, lock);
+    }
 }
 // Funzione per la scarica della batteria del veicolo.
 void Vehicle::drainBattery(float amount) {
@@ -255,12 +371,20 @@ void Vehicle::drainBattery(float amount) {
     
 }
 
+// Funzione per impostare direttamente il livello di batteria, ad esempio al ripristino di un checkpoint della missione.
+void Vehicle::setBattery(float battery) {
+    battery_ = std::max(0.0f, std::min(battery, 100.0f));
+    publishTelemetry(TelemetrySample::State::Idle, x_, y_);
+}
+
 // Funzione per la ricarica della batteria del veicolo.
 void Vehicle::rechargeBattery() {
     std::cout << "Battery low. Recharging..." << std::endl;
-    std::this_thread::sleep_for(std::chrono::seconds(15)); // Simula il tempo di ricarica
-    battery_ = 100.0;
+    publishTelemetry(TelemetrySample::State::Recharging, x_, y_);
+    std::this_thread::sleep_for(RechargeTime); // Simula il tempo di ricarica
+    battery_ = FullBattery;
     std::cout << "Battery fully recharged." << std::endl;
+    publishTelemetry(TelemetrySample::State::Idle, x_, y_);
 }
 
 // Funzione per convertire il tipo di veicolo in una stringa
@@ -15,6 +15,9 @@ using std::string;
 using std::vector;
 #include "sensor.h"
 #include "field.h"
+#include "soildata.h"
+#include "motionmodel.h"
+#include "telemetry.h"
 #include <iostream>
 using std::ostream;
 #include <mutex>
@@ -23,6 +26,8 @@ using std::mutex;
 using std::condition_variable;
 #include <utility>
 using std::pair;
+#include <chrono>
+#include <atomic>
 
 
 class ControlCenter;
@@ -36,22 +41,32 @@ class Vehicle {
         void setPosition(int x, int y);
         void moveToTarget(int targetx, int targety);
         void readDataFromCurrentCell() const;
-        void readAndSendData(ControlCenter& controlCenter);
+        bool readAndSendData(ControlCenter& controlCenter);
+        void flushData(ControlCenter& controlCenter);
+        void setFlushPolicy(int maxcells, std::chrono::milliseconds maxage);
         std::string getName() const {return name_;}
         VehicleType getType() const {return type_;}
         int getId() const { return id_; }
-        int getX() const {return x_;}
-        int getY() const {return y_;}
+        int getX() const;
+        int getY() const;
+        MotionModel::Clock::time_point estimateArrival(int targetx, int targety) const;
         double getSpeed() const {return speed_;}
+        float getBattery() const {return battery_;}
+        TelemetryRing& getTelemetry() {return telemetry_;}
         std::string vehicleTypeToString(VehicleType type) const;
         void drainBattery(float amount);
         void rechargeBattery();
+        void setBattery(float battery);
 
 
     private:
         string name_;
         int id_;
-        static int nextId_; // Tale contatore statico serve per assegnare un id univoco ad ogni veicolo.
+        static std::atomic<int> nextId_; // Tale contatore statico e atomico serve per assegnare un id univoco ai veicoli creati senza id esplicito.
+        static constexpr float BatteryPerCell = 5.0f; // Consumo di batteria per ogni cella percorsa
+        static constexpr float BatteryReserve = 10.0f; // Sotto questa soglia il veicolo deve tornare alla base
+        static constexpr float FullBattery = 100.0f; // Livello della batteria dopo la ricarica
+        static constexpr std::chrono::seconds RechargeTime{15}; // Tempo di ricarica alla base
         VehicleType type_;
         int x_;
         int y_;
@@ -62,6 +77,23 @@ class Vehicle {
         bool isBusy_;
         std::mutex vehiclemutex_;
         std::condition_variable cvnotbusy_;
+        MotionModel motion_; // Spostamento corrente (o posizione di sosta), usato per ricavare la posizione durante il moto
+        mutable std::mutex motionmutex_;
+        void travelTo(int targetx, int targety, bool drain);
+        void returnToBaseAndRecharge(std::unique_lock<std::mutex>& lock);
+        bool canTravel(int distance) const;
+        static bool canTravel(int distance, float battery);
+        TelemetryRing telemetry_; // Campioni di telemetria pubblicati dal veicolo e letti dal monitoraggio senza lock
+        void publishTelemetry(TelemetrySample::State state, int x, int y);
+        // Letture accumulate e non ancora inviate al control center, con la relativa politica di invio
+        std::vector<SoilData> pendingdata_;
+        int pendingcells_;
+        std::chrono::steady_clock::time_point pendingsince_;
+        int flushcells_;
+        std::chrono::milliseconds flushinterval_;
+        ControlCenter* pendingcenter_; // Control center destinatario del batch in corso
+        void sendPendingData(ControlCenter& controlCenter, std::unique_lock<std::mutex>& lock);
+        void sendExpiredData(std::unique_lock<std::mutex>& lock);
 
         
         
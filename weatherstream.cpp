@@ -0,0 +1,168 @@
+#include "weatherstream.h"
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <limits>
+
+namespace {
+    // Legge un numero seguito da una virgola, o dalla fine della riga se è l'ultimo campo, e sposta il cursore dopo il separatore
+    template <typename T>
+    bool parseField(const char*& cursor, T& value, bool last)
+    {
+        char* end {nullptr};
+        errno = 0;
+        if constexpr (std::numeric_limits<T>::is_integer) {
+            long parsed {std::strtol(cursor, &end, 10)};
+            if (parsed < std::numeric_limits<T>::min() || parsed > std::numeric_limits<T>::max()) {
+                return false;
+            }
+            value = static_cast<T>(parsed);
+        } else {
+            value = static_cast<T>(std::strtod(cursor, &end));
+        }
+        if (end == cursor || errno != 0) {
+            return false;
+        }
+        while (*end == ' ' || *end == '\t' || *end == '\r') {
+            ++end;
+        }
+        if (last) {
+            return *end == '\0';
+        }
+        if (*end != ',') {
+            return false;
+        }
+        cursor = end + 1;
+        return true;
+    }
+}
+
+// Costruttore: la serie da leggere viene indicata con open
+WeatherStream::WeatherStream()
+    : readbuffer_(ReadBufferSize),
+    linenumber_{0},
+    haspending_{false},
+    pendinghour_{0.0},
+    pending_{},
+    lasthour_{0.0},
+    steps_{0},
+    regions_{0},
+    invalidlines_{0}
+    {}
+
+// Funzione che apre una serie meteo e ne salta l'intestazione. Restituisce false, con un messaggio di errore, se il file non può essere letto.
+bool WeatherStream::open(const std::string& path) {
+    close();
+    file_.rdbuf()->pubsetbuf(readbuffer_.data(), static_cast<std::streamsize>(readbuffer_.size()));
+    file_.open(path);
+    if (!file_) {
+        std::cerr << "Unable to open weather series " << path << "." << std::endl;
+        return false;
+    }
+    path_ = path;
+    if (!std::getline(file_, line_) || line_.compare(0, 5, "hour,") != 0) {
+        std::cerr << "Invalid weather series " << path << ": the first line must be the header." << std::endl;
+        close();
+        return false;
+    }
+    linenumber_ = 1;
+    haspending_ = readLine(pendinghour_, pending_);
+    return true;
+}
+
+// Funzione che chiude la serie e azzera i contatori
+void WeatherStream::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.clear();
+    linenumber_ = 0;
+    haspending_ = false;
+    lasthour_ = 0.0;
+    steps_ = 0;
+    regions_ = 0;
+    invalidlines_ = 0;
+}
+
+// Funzione che legge il passo successivo della serie: tutte le righe consecutive con lo stesso istante.
+// Il vettore delle aree del passo viene riusato, così che la lettura di una serie lunga non allochi memoria ad ogni passo. Restituisce false a fine serie.
+bool WeatherStream::nextStep(WeatherStep& step) {
+    step.updates.clear();
+    if (!haspending_) {
+        return false;
+    }
+    step.hour = pendinghour_;
+    step.updates.push_back(pending_);
+    double hour {0.0};
+    Field::RegionUpdate update {};
+    haspending_ = false;
+    while (readLine(hour, update)) {
+        if (hour != step.hour) {
+            pendinghour_ = hour;
+            pending_ = update;
+            haspending_ = true;
+            break;
+        }
+        step.updates.push_back(update);
+    }
+    ++steps_;
+    regions_ += step.updates.size();
+    return true;
+}
+
+// Funzione che applica al campo tutti i passi rimanenti della serie, uno alla volta, e restituisce il numero di passi applicati.
+// Le aree che escono dal campo vengono segnalate e scartate. Prima di ogni passo viene chiamata, se indicata, la funzione beforeStep:
+// ad esempio per far evolvere il campo dall'istante del passo precedente a quello del passo da applicare.
+std::size_t WeatherStream::replay(Field& field, const std::function<void(const WeatherStep&)>& beforeStep) {
+    WeatherStep step;
+    std::size_t applied {0};
+    while (nextStep(step)) {
+        std::size_t kept {0};
+        for (const Field::RegionUpdate& update : step.updates) {
+            if (update.endlength >= field.getLength() || update.endwidth >= field.getWidth()) {
+                std::cerr << "Weather region outside the field at hour " << step.hour << ", skipped." << std::endl;
+                continue;
+            }
+            step.updates[kept++] = update;
+        }
+        step.updates.resize(kept);
+        if (beforeStep) {
+            beforeStep(step);
+        }
+        field.applyRegionUpdates(step.updates);
+        ++applied;
+    }
+    return applied;
+}
+
+// Funzione privata che legge la prossima riga valida. Le righe vuote vengono saltate; quelle non valide, o con un istante
+// precedente all'ultimo letto, vengono segnalate e scartate. Restituisce false a fine file.
+bool WeatherStream::readLine(double& hour, Field::RegionUpdate& update) {
+    while (std::getline(file_, line_)) {
+        ++linenumber_;
+        if (line_.empty() || line_ == "\r") {
+            continue;
+        }
+        if (!parseLine(hour, update) || hour < lasthour_) {
+            std::cerr << "Invalid line " << linenumber_ << " in weather series " << path_ << ", skipped." << std::endl;
+            ++invalidlines_;
+            continue;
+        }
+        lasthour_ = hour;
+        return true;
+    }
+    return false;
+}
+
+// Funzione privata che interpreta la riga appena letta senza copie intermedie. Restituisce false se un campo manca o non è un numero,
+// se il rettangolo non è valido o se l'umidità dell'aria non è compresa tra 0 e 100.
+bool WeatherStream::parseLine(double& hour, Field::RegionUpdate& update) const {
+    const char* cursor {line_.c_str()};
+    if (!parseField(cursor, hour, false) || !parseField(cursor, update.startlength, false) || !parseField(cursor, update.endlength, false)
+        || !parseField(cursor, update.startwidth, false) || !parseField(cursor, update.endwidth, false)
+        || !parseField(cursor, update.airtemperature, false) || !parseField(cursor, update.airhumidity, true)) {
+        return false;
+    }
+    return hour >= 0 && update.startlength >= 0 && update.startwidth >= 0 && update.startlength <= update.endlength
+           && update.startwidth <= update.endwidth && update.airhumidity >= 0 && update.airhumidity <= 100;
+}
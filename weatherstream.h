@@ -0,0 +1,57 @@
+// La classe "WeatherStream" legge da un file una serie temporale meteo e la applica al campo un passo alla volta.
+// Il file è un CSV con una riga di intestazione e una riga per area e istante:
+//   hour,startlength,endlength,startwidth,endwidth,airtemperature,airhumidity
+// dove hour è l'istante in ore dall'inizio della serie (non decrescente) e le quattro coordinate delimitano un rettangolo di celle, estremi inclusi.
+// Le righe con lo stesso istante formano un passo, che viene applicato al campo con una sola scrittura a blocchi (Field::applyRegionUpdates):
+// un'unica generazione per passo e nessun lucchetto per cella.
+// Il file viene letto una riga alla volta con un buffer di dimensione fissa e in memoria c'è un solo passo, quindi anche una serie di un'intera
+// stagione occupa la stessa memoria di una serie di un giorno. Le righe non valide vengono segnalate con il numero di riga e scartate.
+// La descrizione delle funzioni è presente nel file "weatherstream.cpp".
+
+#ifndef WEATHERSTREAM_H
+#define WEATHERSTREAM_H
+#include "field.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <cstddef>
+
+class WeatherStream {
+    public:
+        // Un passo della serie: l'istante e le aree aggiornate in quell'istante
+        struct WeatherStep {
+            double hour;
+            std::vector<Field::RegionUpdate> updates;
+        };
+        WeatherStream();
+        WeatherStream(const WeatherStream&) = delete;
+        WeatherStream& operator=(const WeatherStream&) = delete;
+        bool open(const std::string& path);
+        bool nextStep(WeatherStep& step);
+        std::size_t replay(Field& field, const std::function<void(const WeatherStep&)>& beforeStep = nullptr);
+        void close();
+        std::size_t getSteps() const { return steps_; }
+        std::size_t getRegions() const { return regions_; }
+        std::size_t getInvalidLines() const { return invalidlines_; }
+
+    private:
+        static constexpr std::size_t ReadBufferSize = 64 * 1024; // Buffer di lettura del file, come i blocchi di scrittura della traccia dei sensori
+        std::vector<char> readbuffer_;
+        std::ifstream file_;
+        std::string path_;
+        std::string line_;
+        std::size_t linenumber_;
+        // Prima riga del passo successivo, già letta mentre si cercava la fine del passo in corso
+        bool haspending_;
+        double pendinghour_;
+        Field::RegionUpdate pending_;
+        double lasthour_;
+        std::size_t steps_;
+        std::size_t regions_;
+        std::size_t invalidlines_;
+        bool readLine(double& hour, Field::RegionUpdate& update);
+        bool parseLine(double& hour, Field::RegionUpdate& update) const;
+};
+
+#endif